@@ -23,6 +23,7 @@ class _BoltConnection(Structure):
         ("ssl", c_void_p),
         ("socket", c_int),
         ("protocol_version", c_int32),
+        ("protocol", c_void_p),
         ("protocol_state", c_void_p),
         ("tx_buffer", c_void_p),
         ("rx_buffer", c_void_p),
@@ -38,10 +39,10 @@ _seabolt.BoltConnection_open_b.restype = POINTER(_BoltConnection)
 class _BoltValue(Structure):
 
     _fields_ = [
-        ("type", c_int16),
-        ("code", c_int16),
+        ("type", c_int8),
+        ("storage", c_int8),
+        ("subtype", c_int16),
         ("size", c_int32),
-        ("data_size", c_size_t),
         ("data", c_void_p),
     ]
 
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2002-2017 "Neo Technology,"
+ * Network Engine for Objects in Lund AB [http://neotechnology.com]
+ *
+ * This file is part of Neo4j.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SEABOLT_TEST_STUB
+#define SEABOLT_TEST_STUB
+
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+/**
+ * A single step of a stub server script: either a message expected from
+ * the client (identified by its signature) or a message to send to it.
+ */
+struct BoltStubStep
+{
+    char direction;
+    int signature;
+    std::string message;
+};
+
+/**
+ * A scripted Bolt server, listening on an ephemeral loopback port.
+ */
+struct BoltStub;
+
+BoltStubStep stub_expect(int signature);
+
+BoltStubStep stub_send(const std::string & message);
+
+/**
+ * Start a stub server that accepts a single connection, negotiates the
+ * given protocol version and then follows the script in order.
+ */
+struct BoltStub * bolt_stub_start(int32_t version, const std::vector<BoltStubStep> & script);
+
+const char * bolt_stub_port(struct BoltStub * stub);
+
+/**
+ * Wait for the client to disconnect and stop the stub server.
+ *
+ * @return the number of script steps that were not matched
+ */
+int bolt_stub_finish(struct BoltStub * stub);
+
+/**
+ * Obtain a client message received by the stub (without chunk headers).
+ */
+const std::string & bolt_stub_received(struct BoltStub * stub, size_t index);
+
+void bolt_stub_destroy(struct BoltStub * stub);
+
+// PackStream encoding helpers for building scripted messages
+std::string pack_null();
+std::string pack_bool(bool x);
+std::string pack_int(int64_t x);
+std::string pack_float(double x);
+std::string pack_string(const std::string & x);
+std::string pack_list(const std::vector<std::string> & items);
+std::string pack_map(const std::vector<std::pair<std::string, std::string>> & entries);
+std::string pack_message(int signature, const std::vector<std::string> & fields);
+
+
+#endif // SEABOLT_TEST_STUB
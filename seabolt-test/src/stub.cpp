@@ -0,0 +1,301 @@
+/*
+ * Copyright (c) 2002-2017 "Neo Technology,"
+ * Network Engine for Objects in Lund AB [http://neotechnology.com]
+ *
+ * This file is part of Neo4j.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <cstring>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "stub.hpp"
+
+
+struct BoltStub
+{
+    int32_t version;
+    std::vector<BoltStubStep> script;
+    int listener;
+    char port[8];
+    std::thread thread;
+    std::vector<std::string> received;
+    int errors;
+};
+
+BoltStubStep stub_expect(int signature)
+{
+    return BoltStubStep{'C', signature, std::string()};
+}
+
+BoltStubStep stub_send(const std::string & message)
+{
+    return BoltStubStep{'S', 0, message};
+}
+
+static bool read_exactly(int socket, char * buffer, size_t size)
+{
+    size_t total = 0;
+    while (total < size)
+    {
+        ssize_t n = recv(socket, buffer + total, size - total, 0);
+        if (n <= 0)
+        {
+            return false;
+        }
+        total += (size_t)(n);
+    }
+    return true;
+}
+
+static bool read_message(int socket, std::string & message)
+{
+    message.clear();
+    while (true)
+    {
+        unsigned char header[2];
+        if (!read_exactly(socket, (char *)(header), 2))
+        {
+            return false;
+        }
+        size_t size = ((size_t)(header[0]) << 8) | header[1];
+        if (size == 0)
+        {
+            return true;
+        }
+        size_t offset = message.size();
+        message.resize(offset + size);
+        if (!read_exactly(socket, &message[offset], size))
+        {
+            return false;
+        }
+    }
+}
+
+static void write_message(int socket, const std::string & message)
+{
+    std::string framed;
+    for (size_t offset = 0; offset < message.size(); offset += 0xFFFF)
+    {
+        size_t size = std::min(message.size() - offset, (size_t)(0xFFFF));
+        framed.push_back((char)(size >> 8));
+        framed.push_back((char)(size));
+        framed.append(message, offset, size);
+    }
+    framed.append(2, '\0');
+    send(socket, framed.data(), framed.size(), 0);
+}
+
+static void run(struct BoltStub * stub)
+{
+    int socket = accept(stub->listener, nullptr, nullptr);
+    if (socket == -1)
+    {
+        stub->errors = (int)(stub->script.size()) + 1;
+        return;
+    }
+    struct timeval timeout = {5, 0};
+    setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    char handshake[20];
+    if (!read_exactly(socket, handshake, sizeof(handshake)) || memcmp(handshake, "\x60\x60\xB0\x17", 4) != 0)
+    {
+        stub->errors = (int)(stub->script.size()) + 1;
+        close(socket);
+        return;
+    }
+    uint32_t version = htonl((uint32_t)(stub->version));
+    send(socket, &version, 4, 0);
+    stub->errors = 0;
+    for (const BoltStubStep & step : stub->script)
+    {
+        if (step.direction == 'S')
+        {
+            write_message(socket, step.message);
+            continue;
+        }
+        std::string message;
+        if (!read_message(socket, message))
+        {
+            stub->errors += 1;
+            break;
+        }
+        stub->received.push_back(message);
+        if (message.size() < 2 || (unsigned char)(message[1]) != step.signature)
+        {
+            stub->errors += 1;
+        }
+    }
+    // collect anything further, such as GOODBYE, until the client disconnects
+    std::string message;
+    while (read_message(socket, message))
+    {
+        stub->received.push_back(message);
+    }
+    close(socket);
+}
+
+struct BoltStub * bolt_stub_start(int32_t version, const std::vector<BoltStubStep> & script)
+{
+    struct BoltStub * stub = new BoltStub();
+    stub->version = version;
+    stub->script = script;
+    stub->errors = 0;
+    stub->listener = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    socklen_t address_size = sizeof(address);
+    bind(stub->listener, (struct sockaddr *)(&address), address_size);
+    listen(stub->listener, 1);
+    getsockname(stub->listener, (struct sockaddr *)(&address), &address_size);
+    snprintf(stub->port, sizeof(stub->port), "%d", ntohs(address.sin_port));
+    stub->thread = std::thread(run, stub);
+    return stub;
+}
+
+const char * bolt_stub_port(struct BoltStub * stub)
+{
+    return stub->port;
+}
+
+int bolt_stub_finish(struct BoltStub * stub)
+{
+    if (stub->thread.joinable())
+    {
+        stub->thread.join();
+    }
+    return stub->errors;
+}
+
+const std::string & bolt_stub_received(struct BoltStub * stub, size_t index)
+{
+    return stub->received.at(index);
+}
+
+void bolt_stub_destroy(struct BoltStub * stub)
+{
+    bolt_stub_finish(stub);
+    close(stub->listener);
+    delete stub;
+}
+
+std::string pack_null()
+{
+    return std::string(1, '\xC0');
+}
+
+std::string pack_bool(bool x)
+{
+    return std::string(1, x ? '\xC3' : '\xC2');
+}
+
+static std::string pack_be(uint8_t marker, uint64_t x, int size)
+{
+    std::string packed(1, (char)(marker));
+    for (int i = size - 1; i >= 0; i--)
+    {
+        packed.push_back((char)(x >> (8 * i)));
+    }
+    return packed;
+}
+
+std::string pack_int(int64_t x)
+{
+    if (x >= -16 && x < 128)
+    {
+        return std::string(1, (char)(x));
+    }
+    if (x >= INT8_MIN && x <= INT8_MAX)
+    {
+        return pack_be(0xC8, (uint64_t)(x), 1);
+    }
+    if (x >= INT16_MIN && x <= INT16_MAX)
+    {
+        return pack_be(0xC9, (uint64_t)(x), 2);
+    }
+    if (x >= INT32_MIN && x <= INT32_MAX)
+    {
+        return pack_be(0xCA, (uint64_t)(x), 4);
+    }
+    return pack_be(0xCB, (uint64_t)(x), 8);
+}
+
+std::string pack_float(double x)
+{
+    uint64_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    return pack_be(0xC1, bits, 8);
+}
+
+static std::string pack_header(uint8_t tiny, uint8_t marker, size_t size)
+{
+    if (size < 0x10)
+    {
+        return std::string(1, (char)(tiny + size));
+    }
+    if (size <= 0xFF)
+    {
+        return pack_be(marker, size, 1);
+    }
+    if (size <= 0xFFFF)
+    {
+        return pack_be((uint8_t)(marker + 1), size, 2);
+    }
+    return pack_be((uint8_t)(marker + 2), size, 4);
+}
+
+std::string pack_string(const std::string & x)
+{
+    return pack_header(0x80, 0xD0, x.size()) + x;
+}
+
+std::string pack_list(const std::vector<std::string> & items)
+{
+    std::string packed = pack_header(0x90, 0xD4, items.size());
+    for (const std::string & item : items)
+    {
+        packed += item;
+    }
+    return packed;
+}
+
+std::string pack_map(const std::vector<std::pair<std::string, std::string>> & entries)
+{
+    std::string packed = pack_header(0xA0, 0xD8, entries.size());
+    for (const auto & entry : entries)
+    {
+        packed += pack_string(entry.first) + entry.second;
+    }
+    return packed;
+}
+
+std::string pack_message(int signature, const std::vector<std::string> & fields)
+{
+    std::string packed(1, (char)(0xB0 + fields.size()));
+    packed.push_back((char)(signature));
+    for (const std::string & field : fields)
+    {
+        packed += field;
+    }
+    return packed;
+}
@@ -354,6 +354,45 @@ SCENARIO("Test parameterised Cypher statements", "[integration][ipv6][secure]")
     }
 }
 
+SCENARIO("Test streamed parameter list larger than a single chunk", "[integration][ipv6][secure]")
+{
+    GIVEN("an open and initialised connection")
+    {
+        struct BoltConnection * connection = bolt_open_and_init_b(BOLT_SECURE_SOCKET, BOLT_IPV6_HOST, BOLT_PORT,
+                                                                  BOLT_USER, BOLT_PASSWORD);
+        WHEN("successfully executed Cypher with a streamed list")
+        {
+            const int32_t size = 100000;
+            BoltConnection_set_cypher_template(connection, "UNWIND $rows AS row RETURN count(row), sum(row)", 47);
+            BoltConnection_set_n_cypher_parameters(connection, 0);
+            REQUIRE(BoltConnection_open_run_stream_b(connection, "rows", 4, size) == 0);
+            BoltValue * row = BoltValue_create();
+            for (int32_t i = 0; i < size; i++)
+            {
+                BoltValue_to_Int64(row, i);
+                REQUIRE(BoltConnection_load_stream_value_b(connection, row) == 0);
+            }
+            BoltValue_destroy(row);
+            REQUIRE(BoltConnection_close_run_stream_b(connection) == 0);
+            BoltConnection_load_pull_request(connection, -1);
+            bolt_request_t pull = BoltConnection_last_request(connection);
+            BoltConnection_send_b(connection);
+            struct BoltValue * last_received = BoltConnection_data(connection);
+            int records = 0;
+            while (BoltConnection_fetch_b(connection, pull))
+            {
+                REQUIRE(BoltValue_type(last_received) == BOLT_LIST);
+                REQUIRE(BoltInt64_get(BoltList_value(last_received, 0)) == size);
+                REQUIRE(BoltInt64_get(BoltList_value(last_received, 1)) == (int64_t)(size) * (size - 1) / 2);
+                records += 1;
+            }
+            REQUIRE(BoltMessage_code(last_received) == 0x70);
+            REQUIRE(records == 1);
+        }
+        BoltConnection_close_b(connection);
+    }
+}
+
 SCENARIO("Test execution of multiple Cypher statements transmitted together", "[integration][ipv6][secure]")
 {
     GIVEN("an open and initialised connection")
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2002-2017 "Neo Technology,"
+ * Network Engine for Objects in Lund AB [http://neotechnology.com]
+ *
+ * This file is part of Neo4j.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory.h>
+#include <stdint.h>
+
+#include "catch.hpp"
+
+extern "C" {
+    #include "bolt/graph.h"
+    #include "bolt/values.h"
+}
+
+
+static void to_node(struct BoltValue* value, int64_t id, const char* label, const char* name)
+{
+    BoltValue_to_Structure(value, 'N', 3);
+    BoltValue_to_Int64(BoltStructure_value(value, 0), id);
+    BoltValue_to_List(BoltStructure_value(value, 1), 1);
+    BoltValue_to_String(BoltList_value(BoltStructure_value(value, 1), 0), label, (int32_t)(strlen(label)));
+    BoltValue_to_Dictionary(BoltStructure_value(value, 2), 1);
+    BoltDictionary_set_key(BoltStructure_value(value, 2), 0, "name", 4);
+    BoltValue_to_String(BoltDictionary_value(BoltStructure_value(value, 2), 0), name, (int32_t)(strlen(name)));
+}
+
+static void to_relationship(struct BoltValue* value, int64_t id, int64_t start, int64_t end, const char* type)
+{
+    BoltValue_to_Structure(value, 'R', 5);
+    BoltValue_to_Int64(BoltStructure_value(value, 0), id);
+    BoltValue_to_Int64(BoltStructure_value(value, 1), start);
+    BoltValue_to_Int64(BoltStructure_value(value, 2), end);
+    BoltValue_to_String(BoltStructure_value(value, 3), type, (int32_t)(strlen(type)));
+    BoltValue_to_Dictionary(BoltStructure_value(value, 4), 1);
+    BoltDictionary_set_key(BoltStructure_value(value, 4), 0, "weight", 6);
+    BoltValue_to_Int64(BoltDictionary_value(BoltStructure_value(value, 4), 0), id * 10);
+}
+
+static void to_unbound_relationship(struct BoltValue* value, int64_t id, const char* type)
+{
+    BoltValue_to_Structure(value, 'r', 3);
+    BoltValue_to_Int64(BoltStructure_value(value, 0), id);
+    BoltValue_to_String(BoltStructure_value(value, 1), type, (int32_t)(strlen(type)));
+    BoltValue_to_Dictionary(BoltStructure_value(value, 2), 0);
+}
+
+
+SCENARIO("Test graph assembly from nodes and relationships")
+{
+    GIVEN("a graph and a record holding two nodes joined by a relationship")
+    {
+        struct BoltGraph* graph = BoltGraph_create();
+        struct BoltValue* record = BoltValue_create();
+        BoltValue_to_List(record, 3);
+        to_node(BoltList_value(record, 0), 100, "Person", "Alice");
+        to_relationship(BoltList_value(record, 1), 7, 100, 200, "KNOWS");
+        to_node(BoltList_value(record, 2), 200, "Person", "Bob");
+        WHEN("the record is added twice and the graph is built")
+        {
+            REQUIRE(BoltGraph_add(graph, record) == 0);
+            REQUIRE(BoltGraph_add(graph, record) == 0);
+            BoltValue_destroy(record);
+            BoltGraph_build(graph);
+            THEN("each entity should be held only once")
+            {
+                REQUIRE(graph->n_nodes == 2);
+                REQUIRE(graph->n_relationships == 1);
+            }
+            THEN("the relationship should appear in the adjacency of both nodes")
+            {
+                int32_t alice = BoltGraph_node_index(graph, 100);
+                int32_t bob = BoltGraph_node_index(graph, 200);
+                REQUIRE(alice >= 0);
+                REQUIRE(bob >= 0);
+                REQUIRE(BoltGraph_node_index(graph, 300) == -1);
+                int32_t size;
+                const int32_t* targets = BoltGraph_outgoing(graph, alice, &size);
+                REQUIRE(size == 1);
+                REQUIRE(targets[0] == bob);
+                REQUIRE(graph->out_relationships[graph->out_offsets[alice]] == BoltGraph_relationship_index(graph, 7));
+                BoltGraph_outgoing(graph, bob, &size);
+                REQUIRE(size == 0);
+                const int32_t* sources = BoltGraph_incoming(graph, bob, &size);
+                REQUIRE(size == 1);
+                REQUIRE(sources[0] == alice);
+            }
+            THEN("labels, types and properties should be available by index")
+            {
+                int32_t bob = BoltGraph_node_index(graph, 200);
+                int32_t size;
+                const int32_t* labels = BoltGraph_node_labels(graph, bob, &size);
+                REQUIRE(size == 1);
+                struct BoltValue* label = BoltList_value(graph->label_names, labels[0]);
+                REQUIRE(strncmp(BoltString_get(label), "Person", 6) == 0);
+                struct BoltValue* name = BoltGraph_node_property(graph, bob, "name", 4);
+                REQUIRE(BoltValue_type(name) == BOLT_STRING);
+                REQUIRE(strncmp(BoltString_get(name), "Bob", 3) == 0);
+                REQUIRE(BoltGraph_node_property(graph, bob, "age", 3) == NULL);
+                int32_t knows = BoltGraph_relationship_index(graph, 7);
+                struct BoltValue* type = BoltList_value(graph->type_names, graph->relationship_types[knows]);
+                REQUIRE(strncmp(BoltString_get(type), "KNOWS", 5) == 0);
+                REQUIRE(BoltInt64_get(BoltGraph_relationship_property(graph, knows, "weight", 6)) == 70);
+            }
+        }
+        BoltGraph_destroy(graph);
+    }
+}
+
+SCENARIO("Test graph assembly from paths")
+{
+    GIVEN("a path (a)-[:X]->(b)<-[:Y]-(c)")
+    {
+        struct BoltGraph* graph = BoltGraph_create();
+        struct BoltValue* path = BoltValue_create();
+        BoltValue_to_Structure(path, 'P', 3);
+        struct BoltValue* nodes = BoltStructure_value(path, 0);
+        BoltValue_to_List(nodes, 3);
+        to_node(BoltList_value(nodes, 0), 1, "A", "a");
+        to_node(BoltList_value(nodes, 1), 2, "B", "b");
+        to_node(BoltList_value(nodes, 2), 3, "C", "c");
+        struct BoltValue* relationships = BoltStructure_value(path, 1);
+        BoltValue_to_List(relationships, 2);
+        to_unbound_relationship(BoltList_value(relationships, 0), 10, "X");
+        to_unbound_relationship(BoltList_value(relationships, 1), 11, "Y");
+        struct BoltValue* sequence = BoltStructure_value(path, 2);
+        int32_t indexes[] = {1, 1, -2, 2};
+        BoltValue_to_Int32Array(sequence, indexes, 4);
+        WHEN("the path is added and the graph is built")
+        {
+            REQUIRE(BoltGraph_add(graph, path) == 0);
+            BoltGraph_build(graph);
+            THEN("relationship directions should follow the sequence")
+            {
+                int32_t a = BoltGraph_node_index(graph, 1);
+                int32_t b = BoltGraph_node_index(graph, 2);
+                int32_t c = BoltGraph_node_index(graph, 3);
+                int32_t x = BoltGraph_relationship_index(graph, 10);
+                int32_t y = BoltGraph_relationship_index(graph, 11);
+                REQUIRE(graph->relationship_starts[x] == a);
+                REQUIRE(graph->relationship_ends[x] == b);
+                REQUIRE(graph->relationship_starts[y] == c);
+                REQUIRE(graph->relationship_ends[y] == b);
+                int32_t size;
+                BoltGraph_incoming(graph, b, &size);
+                REQUIRE(size == 2);
+            }
+        }
+        WHEN("the path sequence refers to a missing relationship")
+        {
+            BoltInt32Array_get_all(sequence)[2] = 3;
+            THEN("the path should be rejected")
+            {
+                REQUIRE(BoltGraph_add(graph, path) == -1);
+            }
+        }
+        BoltValue_destroy(path);
+        BoltGraph_destroy(graph);
+    }
+}
@@ -0,0 +1,1052 @@
+/*
+ * Copyright (c) 2002-2017 "Neo Technology,"
+ * Network Engine for Objects in Lund AB [http://neotechnology.com]
+ *
+ * This file is part of Neo4j.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <cstring>
+
+#include "catch.hpp"
+#include "integration.hpp"
+#include "stub.hpp"
+
+
+#define HELLO       0x01
+#define GOODBYE     0x02
+#define RUN         0x10
+#define BEGIN       0x11
+#define COMMIT      0x12
+#define DISCARD     0x2F
+#define PULL        0x3F
+#define SUCCESS     0x70
+#define RECORD      0x71
+
+static std::string success(const std::vector<std::pair<std::string, std::string>> & metadata)
+{
+    return pack_message(SUCCESS, {pack_map(metadata)});
+}
+
+static std::string record(int64_t x)
+{
+    return pack_message(RECORD, {pack_list({pack_int(x)})});
+}
+
+static struct BoltConnection * open_stub_b(struct BoltStub * stub)
+{
+    struct BoltAddress * address = bolt_get_address("127.0.0.1", bolt_stub_port(stub));
+    struct BoltConnection * connection = BoltConnection_open_b(BOLT_INSECURE_SOCKET, address);
+    BoltAddress_destroy(address);
+    REQUIRE(connection->status == BOLT_CONNECTED);
+    BoltConnection_init_b(connection, "seabolt/1.0.0a", "neo4j", "password");
+    REQUIRE(connection->status == BOLT_READY);
+    return connection;
+}
+
+SCENARIO("Test Bolt v4 result pulled in windows", "[stub]")
+{
+    GIVEN("a stub server that streams five records in windows of two")
+    {
+        struct BoltStub * stub = bolt_stub_start(4, {
+                stub_expect(HELLO),
+                stub_send(success({{"server", pack_string("Neo4j/4.0.0")}})),
+                stub_expect(RUN),
+                stub_expect(PULL),
+                stub_send(success({{"fields", pack_list({pack_string("x")})}})),
+                stub_send(record(1)),
+                stub_send(record(2)),
+                stub_send(success({{"has_more", pack_bool(true)}})),
+                stub_expect(PULL),
+                stub_send(record(3)),
+                stub_send(record(4)),
+                stub_send(success({{"has_more", pack_bool(true)}})),
+                stub_expect(PULL),
+                stub_send(record(5)),
+                stub_send(success({{"bookmark", pack_string("bookmark:1")}})),
+        });
+        struct BoltConnection * connection = open_stub_b(stub);
+        REQUIRE(connection->protocol_version == 4);
+        WHEN("a fetch size is set")
+        {
+            REQUIRE(BoltConnection_set_fetch_size(connection, 2) == 0);
+            BoltConnection_set_cypher_template(connection, "UNWIND range(1, 5) AS x RETURN x", 32);
+            BoltConnection_set_n_cypher_parameters(connection, 0);
+            BoltConnection_load_run_request(connection);
+            BoltConnection_load_pull_request(connection, -1);
+            bolt_request_t pull = BoltConnection_last_request(connection);
+            BoltConnection_send_b(connection);
+            struct BoltValue * data = BoltConnection_data(connection);
+            int records = 0;
+            while (BoltConnection_fetch_b(connection, pull) == 1)
+            {
+                records += 1;
+                REQUIRE(BoltValue_type(data) == BOLT_LIST);
+                REQUIRE(BoltInt64_get(BoltList_value(data, 0)) == records);
+            }
+            THEN("all records are received and further windows are pulled automatically")
+            {
+                REQUIRE(records == 5);
+                REQUIRE(BoltMessage_code(data) == SUCCESS);
+                REQUIRE(BoltConnection_last_request(connection) == pull);
+                BoltConnection_close_b(connection);
+                REQUIRE(bolt_stub_finish(stub) == 0);
+                std::string expected_pull = pack_message(PULL, {pack_map({{"n", pack_int(2)}})});
+                REQUIRE(bolt_stub_received(stub, 2) == expected_pull);
+                REQUIRE(bolt_stub_received(stub, 3) == expected_pull);
+                REQUIRE(bolt_stub_received(stub, 4) == expected_pull);
+                REQUIRE(bolt_stub_received(stub, 5) == pack_message(GOODBYE, {}));
+            }
+        }
+        bolt_stub_destroy(stub);
+    }
+}
+
+SCENARIO("Test Bolt v4 windowed result discarded", "[stub]")
+{
+    GIVEN("a stub server with more records than a single window")
+    {
+        struct BoltStub * stub = bolt_stub_start(4, {
+                stub_expect(HELLO),
+                stub_send(success({})),
+                stub_expect(RUN),
+                stub_expect(PULL),
+                stub_send(success({{"fields", pack_list({pack_string("x")})}})),
+                stub_send(record(1)),
+                stub_send(record(2)),
+                stub_send(success({{"has_more", pack_bool(true)}})),
+                stub_expect(DISCARD),
+                stub_send(success({})),
+        });
+        struct BoltConnection * connection = open_stub_b(stub);
+        WHEN("the result is consumed through its summary")
+        {
+            BoltConnection_set_fetch_size(connection, 2);
+            BoltConnection_set_cypher_template(connection, "UNWIND range(1, 5) AS x RETURN x", 32);
+            BoltConnection_set_n_cypher_parameters(connection, 0);
+            BoltConnection_load_run_request(connection);
+            BoltConnection_load_pull_request(connection, -1);
+            bolt_request_t pull = BoltConnection_last_request(connection);
+            BoltConnection_send_b(connection);
+            int records = BoltConnection_fetch_summary_b(connection, pull);
+            THEN("the remainder is discarded on the server")
+            {
+                REQUIRE(records == 2);
+                BoltConnection_close_b(connection);
+                REQUIRE(bolt_stub_finish(stub) == 0);
+                REQUIRE(bolt_stub_received(stub, 3) == pack_message(DISCARD, {pack_map({{"n", pack_int(-1)}})}));
+            }
+        }
+        bolt_stub_destroy(stub);
+    }
+}
+
+SCENARIO("Test Bolt v4 windowed result with a later request queued", "[stub]")
+{
+    GIVEN("a stub server that returns the first window of a result in a transaction")
+    {
+        struct BoltStub * stub = bolt_stub_start(4, {
+                stub_expect(HELLO),
+                stub_send(success({{"server", pack_string("Neo4j/4.0.0")}})),
+                stub_expect(RUN),
+                stub_expect(PULL),
+                stub_expect(COMMIT),
+                stub_send(success({{"fields", pack_list({pack_string("x")})}})),
+                stub_send(record(1)),
+                stub_send(record(2)),
+                stub_send(success({{"has_more", pack_bool(true)}})),
+                stub_send(success({})),
+        });
+        struct BoltConnection * connection = open_stub_b(stub);
+        REQUIRE(connection->protocol_version == 4);
+        REQUIRE(BoltConnection_set_fetch_size(connection, 2) == 0);
+        BoltConnection_set_cypher_template(connection, "UNWIND range(1, 5) AS x RETURN x", 32);
+        BoltConnection_set_n_cypher_parameters(connection, 0);
+        BoltConnection_load_run_request(connection);
+        BoltConnection_load_pull_request(connection, -1);
+        bolt_request_t pull = BoltConnection_last_request(connection);
+        BoltConnection_load_commit_request(connection);
+        bolt_request_t commit = BoltConnection_last_request(connection);
+        BoltConnection_send_b(connection);
+        WHEN("the result is fetched before the commit")
+        {
+            int records = 0;
+            int fetched;
+            while ((fetched = BoltConnection_fetch_b(connection, pull)) == 1)
+            {
+                records += 1;
+            }
+            THEN("the fetch fails rather than report the first window as the whole result")
+            {
+                REQUIRE(records == 2);
+                REQUIRE(fetched == -1);
+                REQUIRE(connection->error == BOLT_RESULT_TRUNCATED);
+                REQUIRE(BoltConnection_fetch_summary_b(connection, commit) == 0);
+                REQUIRE(BoltMessage_code(BoltConnection_data(connection)) == SUCCESS);
+                BoltConnection_close_b(connection);
+                REQUIRE(bolt_stub_finish(stub) == 0);
+                REQUIRE(bolt_stub_received(stub, 2) == pack_message(PULL, {pack_map({{"n", pack_int(2)}})}));
+            }
+        }
+        WHEN("the result is held back while the commit is fetched first")
+        {
+            REQUIRE(BoltConnection_set_response_buffer(connection, 1024, BOLT_OVERFLOW_BLOCK) == 0);
+            REQUIRE(BoltConnection_fetch_summary_b(connection, commit) == 0);
+            int records = 0;
+            int fetched;
+            while ((fetched = BoltConnection_fetch_b(connection, pull)) == 1)
+            {
+                records += 1;
+            }
+            THEN("the fetch of the held result fails in the same way")
+            {
+                REQUIRE(records == 2);
+                REQUIRE(fetched == -1);
+                REQUIRE(connection->error == BOLT_RESULT_TRUNCATED);
+                BoltConnection_close_b(connection);
+                REQUIRE(bolt_stub_finish(stub) == 0);
+            }
+        }
+        bolt_stub_destroy(stub);
+    }
+}
+
+SCENARIO("Test Bolt v3 transaction messages", "[stub]")
+{
+    GIVEN("a stub server that negotiates Bolt v3")
+    {
+        struct BoltStub * stub = bolt_stub_start(3, {
+                stub_expect(HELLO),
+                stub_send(success({})),
+                stub_expect(BEGIN),
+                stub_expect(RUN),
+                stub_expect(PULL),
+                stub_expect(COMMIT),
+                stub_send(success({})),
+                stub_send(success({{"fields", pack_list({pack_string("x")})}})),
+                stub_send(record(1)),
+                stub_send(success({})),
+                stub_send(success({{"bookmark", pack_string("bookmark:2")}})),
+        });
+        struct BoltConnection * connection = open_stub_b(stub);
+        REQUIRE(connection->protocol_version == 3);
+        WHEN("a transaction is run")
+        {
+            REQUIRE(BoltConnection_set_fetch_size(connection, 2) == -1);
+            REQUIRE(BoltConnection_load_pull_request(connection, 2) == -1);
+            BoltConnection_load_bookmark(connection, "bookmark:1");
+            BoltConnection_load_begin_request(connection);
+            BoltConnection_set_cypher_template(connection, "RETURN 1", 8);
+            BoltConnection_set_n_cypher_parameters(connection, 0);
+            BoltConnection_load_run_request(connection);
+            BoltConnection_load_pull_request(connection, -1);
+            bolt_request_t pull = BoltConnection_last_request(connection);
+            BoltConnection_load_commit_request(connection);
+            bolt_request_t commit = BoltConnection_last_request(connection);
+            BoltConnection_send_b(connection);
+            int records = BoltConnection_fetch_summary_b(connection, pull);
+            BoltConnection_fetch_summary_b(connection, commit);
+            THEN("each transaction control message is sent once")
+            {
+                REQUIRE(records == 1);
+                REQUIRE(commit == 4);
+                BoltConnection_close_b(connection);
+                REQUIRE(bolt_stub_finish(stub) == 0);
+                REQUIRE(bolt_stub_received(stub, 1) ==
+                        pack_message(BEGIN, {pack_map({{"bookmarks", pack_list({pack_string("bookmark:1")})}})}));
+                REQUIRE(bolt_stub_received(stub, 2) ==
+                        pack_message(RUN, {pack_string("RETURN 1"), pack_map({}), pack_map({})}));
+                REQUIRE(bolt_stub_received(stub, 3) == pack_message(PULL, {}));
+                REQUIRE(bolt_stub_received(stub, 4) == pack_message(COMMIT, {}));
+            }
+        }
+        bolt_stub_destroy(stub);
+    }
+}
+
+SCENARIO("Test prepared RUN request", "[stub]")
+{
+    GIVEN("a stub server that expects the same statement twice")
+    {
+        struct BoltStub * stub = bolt_stub_start(3, {
+                stub_expect(HELLO),
+                stub_send(success({})),
+                stub_expect(RUN),
+                stub_expect(PULL),
+                stub_expect(RUN),
+                stub_expect(PULL),
+                stub_send(success({{"fields", pack_list({pack_string("x")})}})),
+                stub_send(record(1)),
+                stub_send(success({})),
+                stub_send(success({{"fields", pack_list({pack_string("x")})}})),
+                stub_send(record(2)),
+                stub_send(success({})),
+        });
+        struct BoltConnection * connection = open_stub_b(stub);
+        WHEN("a prepared request is run with different parameter values")
+        {
+            BoltConnection_set_cypher_template(connection, "RETURN $x", 9);
+            BoltConnection_set_n_cypher_parameters(connection, 2);
+            BoltConnection_set_cypher_parameter_key(connection, 0, "x", 1);
+            BoltConnection_set_cypher_parameter_key(connection, 1, "name", 4);
+            BoltValue_to_Int64(BoltConnection_cypher_parameter_value(connection, 0), 1);
+            BoltValue_to_String(BoltConnection_cypher_parameter_value(connection, 1), "Alice", 5);
+            struct BoltPreparedRequest * prepared = BoltConnection_prepare_run_request(connection);
+            REQUIRE(prepared != nullptr);
+            REQUIRE(BoltConnection_load_prepared_run_request(connection, prepared) == 0);
+            BoltConnection_load_pull_request(connection, -1);
+            bolt_request_t pull_1 = BoltConnection_last_request(connection);
+            BoltValue_to_Int64(BoltPreparedRequest_parameter_value(prepared, 0), 2);
+            BoltValue_to_Null(BoltPreparedRequest_parameter_value(prepared, 1));
+            REQUIRE(BoltConnection_load_prepared_run_request(connection, prepared) == 0);
+            BoltConnection_load_pull_request(connection, -1);
+            bolt_request_t pull_2 = BoltConnection_last_request(connection);
+            BoltConnection_send_b(connection);
+            struct BoltValue * data = BoltConnection_data(connection);
+            REQUIRE(BoltConnection_fetch_b(connection, pull_1) == 1);
+            REQUIRE(BoltInt64_get(BoltList_value(data, 0)) == 1);
+            BoltConnection_fetch_summary_b(connection, pull_1);
+            REQUIRE(BoltConnection_fetch_b(connection, pull_2) == 1);
+            REQUIRE(BoltInt64_get(BoltList_value(data, 0)) == 2);
+            BoltConnection_fetch_summary_b(connection, pull_2);
+            BoltPreparedRequest_destroy(prepared);
+            THEN("each request carries the statement with its own parameter values")
+            {
+                BoltConnection_close_b(connection);
+                REQUIRE(bolt_stub_finish(stub) == 0);
+                REQUIRE(bolt_stub_received(stub, 1) ==
+                        pack_message(RUN, {pack_string("RETURN $x"),
+                                           pack_map({{"x", pack_int(1)}, {"name", pack_string("Alice")}}),
+                                           pack_map({})}));
+                REQUIRE(bolt_stub_received(stub, 2) == pack_message(PULL, {}));
+                REQUIRE(bolt_stub_received(stub, 3) ==
+                        pack_message(RUN, {pack_string("RETURN $x"),
+                                           pack_map({{"x", pack_int(2)}, {"name", pack_null()}}),
+                                           pack_map({})}));
+            }
+        }
+        bolt_stub_destroy(stub);
+    }
+}
+
+SCENARIO("Test pipelined results fetched out of order", "[stub]")
+{
+    GIVEN("a stub server that answers three pipelined queries")
+    {
+        struct BoltStub * stub = bolt_stub_start(3, {
+                stub_expect(HELLO),
+                stub_send(success({})),
+                stub_expect(RUN),
+                stub_expect(PULL),
+                stub_expect(RUN),
+                stub_expect(PULL),
+                stub_expect(RUN),
+                stub_expect(PULL),
+                stub_send(success({{"fields", pack_list({pack_string("x")})}})),
+                stub_send(record(1)),
+                stub_send(record(2)),
+                stub_send(success({})),
+                stub_send(success({{"fields", pack_list({pack_string("x")})}})),
+                stub_send(record(3)),
+                stub_send(success({})),
+                stub_send(success({{"fields", pack_list({pack_string("x")})}})),
+                stub_send(record(4)),
+                stub_send(success({})),
+        });
+        struct BoltConnection * connection = open_stub_b(stub);
+        WHEN("the last result is fetched first")
+        {
+            REQUIRE(BoltConnection_set_response_buffer(connection, 1024, BOLT_OVERFLOW_BLOCK) == 0);
+            bolt_request_t runs[3];
+            bolt_request_t pulls[3];
+            for (int i = 0; i < 3; i++)
+            {
+                BoltConnection_set_cypher_template(connection, "RETURN 1", 8);
+                BoltConnection_set_n_cypher_parameters(connection, 0);
+                BoltConnection_load_run_request(connection);
+                runs[i] = BoltConnection_last_request(connection);
+                BoltConnection_load_pull_request(connection, -1);
+                pulls[i] = BoltConnection_last_request(connection);
+            }
+            BoltConnection_send_b(connection);
+            struct BoltValue * data = BoltConnection_data(connection);
+            REQUIRE(BoltConnection_fetch_summary_b(connection, runs[2]) == 0);
+            REQUIRE(BoltConnection_fetch_b(connection, pulls[2]) == 1);
+            REQUIRE(BoltInt64_get(BoltList_value(data, 0)) == 4);
+            REQUIRE(BoltConnection_fetch_b(connection, pulls[2]) == 0);
+            size_t held = BoltConnection_buffered_response_size(connection);
+            THEN("earlier results are held back until fetched")
+            {
+                REQUIRE(held > 0);
+                REQUIRE(BoltConnection_fetch_summary_b(connection, runs[0]) == 0);
+                REQUIRE(BoltConnection_fetch_b(connection, pulls[0]) == 1);
+                REQUIRE(BoltInt64_get(BoltList_value(data, 0)) == 1);
+                REQUIRE(BoltConnection_fetch_summary_b(connection, runs[1]) == 0);
+                REQUIRE(BoltConnection_fetch_summary_b(connection, pulls[1]) == 1);
+                REQUIRE(BoltConnection_fetch_b(connection, pulls[0]) == 1);
+                REQUIRE(BoltInt64_get(BoltList_value(data, 0)) == 2);
+                REQUIRE(BoltConnection_fetch_b(connection, pulls[0]) == 0);
+                REQUIRE(BoltConnection_buffered_response_size(connection) == 0);
+                REQUIRE(BoltConnection_peak_buffered_response_size(connection) == held);
+                BoltConnection_close_b(connection);
+                REQUIRE(bolt_stub_finish(stub) == 0);
+            }
+        }
+        bolt_stub_destroy(stub);
+    }
+}
+
+SCENARIO("Test malformed message rejected while results are held back", "[stub]")
+{
+    GIVEN("a stub server that returns a one byte message within an earlier result")
+    {
+        struct BoltStub * stub = bolt_stub_start(3, {
+                stub_expect(HELLO),
+                stub_send(success({})),
+                stub_expect(RUN),
+                stub_expect(PULL),
+                stub_expect(RUN),
+                stub_expect(PULL),
+                stub_send(success({{"fields", pack_list({pack_string("x")})}})),
+                stub_send(std::string(1, (char)(0xB1))),
+                stub_send(success({})),
+                stub_send(success({{"fields", pack_list({pack_string("x")})}})),
+                stub_send(record(3)),
+                stub_send(success({})),
+        });
+        struct BoltConnection * connection = open_stub_b(stub);
+        WHEN("the later result is fetched first")
+        {
+            REQUIRE(BoltConnection_set_response_buffer(connection, 1024, BOLT_OVERFLOW_BLOCK) == 0);
+            bolt_request_t pulls[2];
+            for (int i = 0; i < 2; i++)
+            {
+                BoltConnection_set_cypher_template(connection, "RETURN 1", 8);
+                BoltConnection_set_n_cypher_parameters(connection, 0);
+                BoltConnection_load_run_request(connection);
+                BoltConnection_load_pull_request(connection, -1);
+                pulls[i] = BoltConnection_last_request(connection);
+            }
+            BoltConnection_send_b(connection);
+            THEN("the malformed message fails the fetch without stalling the stream")
+            {
+                REQUIRE(BoltConnection_fetch_b(connection, pulls[1]) == -1);
+                REQUIRE(connection->error == BOLT_PROTOCOL_VIOLATION);
+                REQUIRE(BoltConnection_fetch_b(connection, pulls[1]) == 1);
+                REQUIRE(BoltInt64_get(BoltList_value(BoltConnection_data(connection), 0)) == 3);
+                REQUIRE(BoltConnection_fetch_b(connection, pulls[1]) == 0);
+                BoltConnection_close_b(connection);
+                REQUIRE(bolt_stub_finish(stub) == 0);
+            }
+        }
+        bolt_stub_destroy(stub);
+    }
+}
+
+SCENARIO("Test column batch loaded as a list of rows", "[stub]")
+{
+    GIVEN("a stub server that expects an UNWIND")
+    {
+        struct BoltStub * stub = bolt_stub_start(3, {
+                stub_expect(HELLO),
+                stub_send(success({})),
+                stub_expect(RUN),
+                stub_send(success({})),
+        });
+        struct BoltConnection * connection = open_stub_b(stub);
+        WHEN("a batch of three rows is loaded from column arrays")
+        {
+            int64_t ids[] = {1, 2000, -3};
+            double scores[] = {0.5, 0.0, 2.25};
+            uint8_t score_nulls[] = {0x02};
+            const char * names[] = {"Alice", "Bob", "Carol"};
+            struct BoltColumnBatch * batch = BoltColumnBatch_create(3);
+            BoltColumnBatch_set_int64_column(batch, 0, "id", 2, ids, nullptr);
+            BoltColumnBatch_set_float64_column(batch, 1, "score", 5, scores, score_nulls);
+            BoltColumnBatch_set_string_column(batch, 2, "name", 4, names, nullptr, nullptr);
+            BoltConnection_set_cypher_template(connection, "UNWIND $rows AS row CREATE (:Person {id: row.id})", 49);
+            BoltConnection_set_n_cypher_parameters(connection, 0);
+            REQUIRE(BoltConnection_load_run_batch_b(connection, "rows", 4, batch, 3) == 0);
+            bolt_request_t run = BoltConnection_last_request(connection);
+            BoltConnection_send_b(connection);
+            REQUIRE(BoltConnection_fetch_summary_b(connection, run) == 0);
+            BoltColumnBatch_destroy(batch);
+            THEN("the server receives one map per row")
+            {
+                BoltConnection_close_b(connection);
+                REQUIRE(bolt_stub_finish(stub) == 0);
+                std::string rows = pack_list({
+                        pack_map({{"id", pack_int(1)}, {"score", pack_float(0.5)}, {"name", pack_string("Alice")}}),
+                        pack_map({{"id", pack_int(2000)}, {"score", pack_null()}, {"name", pack_string("Bob")}}),
+                        pack_map({{"id", pack_int(-3)}, {"score", pack_float(2.25)}, {"name", pack_string("Carol")}}),
+                });
+                REQUIRE(bolt_stub_received(stub, 1) ==
+                        pack_message(RUN, {pack_string("UNWIND $rows AS row CREATE (:Person {id: row.id})"),
+                                           pack_map({{"rows", rows}}), pack_map({})}));
+            }
+        }
+        WHEN("a batch holding a NULL string is rejected before a valid batch is loaded")
+        {
+            int64_t ids[] = {1, 2};
+            const char * bad_names[] = {"Alice", nullptr};
+            const char * names[] = {"Alice", "Bob"};
+            struct BoltColumnBatch * batch = BoltColumnBatch_create(2);
+            BoltColumnBatch_set_int64_column(batch, 0, "id", 2, ids, nullptr);
+            BoltColumnBatch_set_string_column(batch, 1, "name", 4, bad_names, nullptr, nullptr);
+            BoltConnection_set_cypher_template(connection, "UNWIND $rows AS row CREATE (:Person {id: row.id})", 49);
+            BoltConnection_set_n_cypher_parameters(connection, 0);
+            REQUIRE(BoltConnection_load_run_batch_b(connection, "rows", 4, batch, 2) == -1);
+            BoltColumnBatch_set_string_column(batch, 1, "name", 4, names, nullptr, nullptr);
+            REQUIRE(BoltConnection_load_run_batch_b(connection, "rows", 4, batch, 2) == 0);
+            bolt_request_t run = BoltConnection_last_request(connection);
+            BoltConnection_send_b(connection);
+            REQUIRE(BoltConnection_fetch_summary_b(connection, run) == 0);
+            BoltColumnBatch_destroy(batch);
+            THEN("the server receives only the valid batch")
+            {
+                BoltConnection_close_b(connection);
+                REQUIRE(bolt_stub_finish(stub) == 0);
+                std::string rows = pack_list({
+                        pack_map({{"id", pack_int(1)}, {"name", pack_string("Alice")}}),
+                        pack_map({{"id", pack_int(2)}, {"name", pack_string("Bob")}}),
+                });
+                REQUIRE(bolt_stub_received(stub, 1) ==
+                        pack_message(RUN, {pack_string("UNWIND $rows AS row CREATE (:Person {id: row.id})"),
+                                           pack_map({{"rows", rows}}), pack_map({})}));
+            }
+        }
+        bolt_stub_destroy(stub);
+    }
+}
+
+SCENARIO("Test parameters written token by token", "[stub]")
+{
+    GIVEN("a stub server that expects a single query")
+    {
+        struct BoltStub * stub = bolt_stub_start(3, {
+                stub_expect(HELLO),
+                stub_send(success({})),
+                stub_expect(RUN),
+                stub_send(success({})),
+        });
+        struct BoltConnection * connection = open_stub_b(stub);
+        WHEN("nested parameters are written after a regular parameter")
+        {
+            BoltConnection_set_cypher_template(connection, "RETURN $props", 13);
+            BoltConnection_set_n_cypher_parameters(connection, 1);
+            BoltConnection_set_cypher_parameter_key(connection, 0, "id", 2);
+            BoltValue_to_Int64(BoltConnection_cypher_parameter_value(connection, 0), 7);
+            struct BoltPackWriter * writer = BoltConnection_open_run_writer(connection, 1);
+            REQUIRE(writer != nullptr);
+            REQUIRE(BoltPackWriter_key(writer, "props", 5) == 0);
+            REQUIRE(BoltPackWriter_begin_map(writer, 2) == 0);
+            REQUIRE(BoltPackWriter_key(writer, "name", 4) == 0);
+            REQUIRE(BoltPackWriter_string(writer, "Alice", 5) == 0);
+            REQUIRE(BoltPackWriter_key(writer, "scores", 6) == 0);
+            REQUIRE(BoltPackWriter_begin_list(writer, 2) == 0);
+            REQUIRE(BoltPackWriter_float(writer, 1.5) == 0);
+            REQUIRE(BoltPackWriter_null(writer) == 0);
+            REQUIRE(BoltConnection_close_run_writer(connection) == 0);
+            REQUIRE(BoltPackWriter_null(writer) == -1);
+            bolt_request_t run = BoltConnection_last_request(connection);
+            BoltConnection_send_b(connection);
+            REQUIRE(BoltConnection_fetch_summary_b(connection, run) == 0);
+            THEN("the server receives all parameters in one map")
+            {
+                BoltConnection_close_b(connection);
+                REQUIRE(bolt_stub_finish(stub) == 0);
+                std::string props = pack_map({{"name",   pack_string("Alice")},
+                                              {"scores", pack_list({pack_float(1.5), pack_null()})}});
+                REQUIRE(bolt_stub_received(stub, 1) ==
+                        pack_message(RUN, {pack_string("RETURN $props"),
+                                           pack_map({{"id", pack_int(7)}, {"props", props}}), pack_map({})}));
+            }
+        }
+        bolt_stub_destroy(stub);
+    }
+}
+
+SCENARIO("Test other requests refused while a RUN request is open", "[stub]")
+{
+    GIVEN("a stub server that expects two queries")
+    {
+        struct BoltStub * stub = bolt_stub_start(3, {
+                stub_expect(HELLO),
+                stub_send(success({})),
+                stub_expect(RUN),
+                stub_expect(PULL),
+                stub_send(success({})),
+                stub_send(success({})),
+                stub_expect(RUN),
+                stub_expect(PULL),
+                stub_send(success({})),
+                stub_send(success({})),
+        });
+        struct BoltConnection * connection = open_stub_b(stub);
+        WHEN("requests are loaded while a stream and then a writer are open")
+        {
+            BoltConnection_set_cypher_template(connection, "RETURN $x", 9);
+            BoltConnection_set_n_cypher_parameters(connection, 0);
+            struct BoltValue * value = BoltValue_create();
+            BoltValue_to_Int64(value, 1);
+            REQUIRE(BoltConnection_open_run_stream_b(connection, "x", 1, 1) == 0);
+            REQUIRE(BoltConnection_load_pull_request(connection, -1) == -1);
+            REQUIRE(BoltConnection_load_begin_request(connection) == -1);
+            REQUIRE(BoltConnection_load_run_request(connection) == -1);
+            REQUIRE(BoltConnection_open_run_writer(connection, 0) == nullptr);
+            int64_t ids[] = {1};
+            struct BoltColumnBatch * batch = BoltColumnBatch_create(1);
+            BoltColumnBatch_set_int64_column(batch, 0, "id", 2, ids, nullptr);
+            REQUIRE(BoltConnection_load_run_batch_b(connection, "rows", 4, batch, 1) == -1);
+            BoltColumnBatch_destroy(batch);
+            REQUIRE(BoltConnection_load_stream_value_b(connection, value) == 0);
+            REQUIRE(BoltConnection_close_run_stream_b(connection) == 0);
+            REQUIRE(BoltConnection_load_pull_request(connection, -1) == 0);
+            struct BoltPackWriter * writer = BoltConnection_open_run_writer(connection, 1);
+            REQUIRE(writer != nullptr);
+            REQUIRE(BoltConnection_load_discard_request(connection, -1) == -1);
+            REQUIRE(BoltConnection_load_commit_request(connection) == -1);
+            REQUIRE(BoltPackWriter_key(writer, "x", 1) == 0);
+            REQUIRE(BoltPackWriter_integer(writer, 2) == 0);
+            REQUIRE(BoltConnection_close_run_writer(connection) == 0);
+            REQUIRE(BoltConnection_load_pull_request(connection, -1) == 0);
+            bolt_request_t pull = BoltConnection_last_request(connection);
+            BoltConnection_send_b(connection);
+            REQUIRE(BoltConnection_fetch_summary_b(connection, pull) == 0);
+            BoltValue_destroy(value);
+            THEN("the server receives only the requests loaded once each RUN was complete")
+            {
+                BoltConnection_close_b(connection);
+                REQUIRE(bolt_stub_finish(stub) == 0);
+                std::string pull_all = pack_message(PULL, {});
+                REQUIRE(bolt_stub_received(stub, 1) ==
+                        pack_message(RUN, {pack_string("RETURN $x"), pack_map({{"x", pack_list({pack_int(1)})}}),
+                                           pack_map({})}));
+                REQUIRE(bolt_stub_received(stub, 2) == pull_all);
+                REQUIRE(bolt_stub_received(stub, 3) ==
+                        pack_message(RUN, {pack_string("RETURN $x"), pack_map({{"x", pack_int(2)}}), pack_map({})}));
+                REQUIRE(bolt_stub_received(stub, 4) == pull_all);
+            }
+        }
+        bolt_stub_destroy(stub);
+    }
+}
+
+SCENARIO("Test records read as a stream of events", "[stub]")
+{
+    GIVEN("a stub server that returns two records")
+    {
+        struct BoltStub * stub = bolt_stub_start(3, {
+                stub_expect(HELLO),
+                stub_send(success({})),
+                stub_expect(RUN),
+                stub_expect(PULL),
+                stub_send(success({{"fields", pack_list({pack_string("n"), pack_string("p")})}})),
+                stub_send(pack_message(RECORD, {pack_list({pack_int(1), pack_map({{"name", pack_string("Alice")}})})})),
+                stub_send(pack_message(RECORD, {pack_list({pack_int(2), pack_map({{"name", pack_null()}})})})),
+                stub_send(success({})),
+        });
+        struct BoltConnection * connection = open_stub_b(stub);
+        WHEN("the records are fetched through a reader")
+        {
+            BoltConnection_set_cypher_template(connection, "RETURN 1", 8);
+            BoltConnection_set_n_cypher_parameters(connection, 0);
+            BoltConnection_load_run_request(connection);
+            BoltConnection_load_pull_request(connection, -1);
+            bolt_request_t pull = BoltConnection_last_request(connection);
+            BoltConnection_send_b(connection);
+            struct BoltPackReader reader;
+            THEN("each record is read event by event")
+            {
+                REQUIRE(BoltConnection_fetch_reader_b(connection, pull, &reader) == 1);
+                REQUIRE(BoltPackReader_next(&reader) == BOLT_PACK_START_LIST);
+                REQUIRE(reader.size == 2);
+                REQUIRE(BoltPackReader_next(&reader) == BOLT_PACK_INTEGER);
+                REQUIRE(reader.integer == 1);
+                REQUIRE(BoltPackReader_next(&reader) == BOLT_PACK_START_MAP);
+                REQUIRE(BoltPackReader_next(&reader) == BOLT_PACK_KEY);
+                REQUIRE(std::string(reader.data, reader.size) == "name");
+                REQUIRE(BoltPackReader_next(&reader) == BOLT_PACK_STRING);
+                REQUIRE(std::string(reader.data, reader.size) == "Alice");
+                REQUIRE(BoltPackReader_next(&reader) == BOLT_PACK_END);
+                REQUIRE(BoltPackReader_next(&reader) == BOLT_PACK_END);
+                REQUIRE(BoltPackReader_next(&reader) == BOLT_PACK_END_OF_RECORD);
+                REQUIRE(BoltConnection_fetch_reader_b(connection, pull, &reader) == 1);
+                REQUIRE(BoltPackReader_next(&reader) == BOLT_PACK_START_LIST);
+                REQUIRE(BoltPackReader_skip(&reader) == 0);
+                REQUIRE(BoltPackReader_next(&reader) == BOLT_PACK_START_MAP);
+                REQUIRE(BoltPackReader_next(&reader) == BOLT_PACK_KEY);
+                REQUIRE(BoltPackReader_next(&reader) == BOLT_PACK_NULL);
+                REQUIRE(BoltConnection_fetch_reader_b(connection, pull, &reader) == 0);
+                REQUIRE(BoltMessage_code(BoltConnection_data(connection)) == SUCCESS);
+                BoltConnection_close_b(connection);
+                REQUIRE(bolt_stub_finish(stub) == 0);
+            }
+        }
+        bolt_stub_destroy(stub);
+    }
+}
+
+SCENARIO("Test truncated record rejected", "[stub]")
+{
+    GIVEN("a stub server that returns a record cut short within a string")
+    {
+        std::string truncated = pack_message(RECORD, {pack_list({pack_int(1), pack_string("Alice")})});
+        truncated.resize(truncated.size() - 2);
+        struct BoltStub * stub = bolt_stub_start(3, {
+                stub_expect(HELLO),
+                stub_send(success({})),
+                stub_expect(RUN),
+                stub_expect(PULL),
+                stub_send(success({{"fields", pack_list({pack_string("n"), pack_string("name")})}})),
+                stub_send(truncated),
+                stub_send(record(2)),
+                stub_send(success({})),
+        });
+        struct BoltConnection * connection = open_stub_b(stub);
+        WHEN("the records are fetched")
+        {
+            BoltConnection_set_cypher_template(connection, "RETURN 1", 8);
+            BoltConnection_set_n_cypher_parameters(connection, 0);
+            BoltConnection_load_run_request(connection);
+            BoltConnection_load_pull_request(connection, -1);
+            bolt_request_t pull = BoltConnection_last_request(connection);
+            BoltConnection_send_b(connection);
+            THEN("the truncated record fails without disturbing the rest of the stream")
+            {
+                REQUIRE(BoltConnection_fetch_b(connection, pull) == -1);
+                REQUIRE(connection->error == BOLT_PROTOCOL_VIOLATION);
+                REQUIRE(BoltConnection_fetch_b(connection, pull) == 1);
+                REQUIRE(BoltInt64_get(BoltList_value(BoltConnection_data(connection), 0)) == 2);
+                REQUIRE(BoltConnection_fetch_b(connection, pull) == 0);
+                BoltConnection_close_b(connection);
+                REQUIRE(bolt_stub_finish(stub) == 0);
+            }
+        }
+        bolt_stub_destroy(stub);
+    }
+}
+
+SCENARIO("Test entity not cached when its fields cannot be decoded", "[stub]")
+{
+    GIVEN("a stub server that returns a node holding an invalid date, then the same node intact")
+    {
+        std::string invalid_date = pack_message('D', {pack_string("x")});
+        struct BoltStub * stub = bolt_stub_start(3, {
+                stub_expect(HELLO),
+                stub_send(success({})),
+                stub_expect(RUN),
+                stub_expect(PULL),
+                stub_send(success({{"fields", pack_list({pack_string("a")})}})),
+                stub_send(pack_message(RECORD, {pack_list({pack_message('N', {pack_int(7), pack_list({}),
+                                                                              pack_map({{"d", invalid_date}})})})})),
+                stub_send(pack_message(RECORD, {pack_list({pack_message('N', {pack_int(7), pack_list({}),
+                                                                              pack_map({{"name", pack_string("Alice")}})})})})),
+                stub_send(success({})),
+        });
+        struct BoltConnection * connection = open_stub_b(stub);
+        WHEN("the records are fetched through the entity cache")
+        {
+            BoltConnection_set_entity_cache(connection, 1);
+            BoltConnection_set_cypher_template(connection, "RETURN 1", 8);
+            BoltConnection_set_n_cypher_parameters(connection, 0);
+            BoltConnection_load_run_request(connection);
+            BoltConnection_load_pull_request(connection, -1);
+            bolt_request_t pull = BoltConnection_last_request(connection);
+            BoltConnection_send_b(connection);
+            THEN("the failed node is not shared with the next record")
+            {
+                REQUIRE(BoltConnection_fetch_b(connection, pull) == -1);
+                REQUIRE(BoltConnection_fetch_b(connection, pull) == 1);
+                struct BoltValue * properties = BoltStructure_value(BoltList_value(BoltConnection_data(connection), 0), 2);
+                REQUIRE(BoltValue_type(properties) == BOLT_DICTIONARY);
+                REQUIRE(properties->size == 1);
+                REQUIRE(strcmp(BoltDictionary_get_key(properties, 0), "name") == 0);
+                REQUIRE(BoltConnection_fetch_b(connection, pull) == 0);
+                BoltConnection_close_b(connection);
+                REQUIRE(bolt_stub_finish(stub) == 0);
+            }
+        }
+        bolt_stub_destroy(stub);
+    }
+}
+
+SCENARIO("Test records fetched in batches", "[stub]")
+{
+    GIVEN("a stub server that returns five records")
+    {
+        struct BoltStub * stub = bolt_stub_start(3, {
+                stub_expect(HELLO),
+                stub_send(success({})),
+                stub_expect(RUN),
+                stub_expect(PULL),
+                stub_send(success({{"fields", pack_list({pack_string("n")})}})),
+                stub_send(record(1)),
+                stub_send(record(2)),
+                stub_send(record(3)),
+                stub_send(record(4)),
+                stub_send(record(5)),
+                stub_send(success({})),
+        });
+        struct BoltConnection * connection = open_stub_b(stub);
+        WHEN("the records are fetched two at a time")
+        {
+            BoltConnection_set_cypher_template(connection, "RETURN 1", 8);
+            BoltConnection_set_n_cypher_parameters(connection, 0);
+            BoltConnection_load_run_request(connection);
+            BoltConnection_load_pull_request(connection, -1);
+            bolt_request_t pull = BoltConnection_last_request(connection);
+            BoltConnection_send_b(connection);
+            struct BoltValue * records = BoltValue_create();
+            THEN("every record arrives once and in order, followed by the summary")
+            {
+                int64_t expected = 1;
+                int fetched;
+                while ((fetched = BoltConnection_fetch_batch_b(connection, pull, 2, records)) > 0)
+                {
+                    REQUIRE(fetched <= 2);
+                    for (int i = 0; i < fetched; i++)
+                    {
+                        REQUIRE(BoltInt64_get(BoltList_value(BoltList_value(records, i), 0)) == expected++);
+                    }
+                }
+                REQUIRE(fetched == 0);
+                REQUIRE(expected == 6);
+                REQUIRE(BoltMessage_code(BoltConnection_data(connection)) == SUCCESS);
+                BoltConnection_close_b(connection);
+                REQUIRE(bolt_stub_finish(stub) == 0);
+            }
+            BoltValue_destroy(records);
+        }
+        bolt_stub_destroy(stub);
+    }
+}
+
+SCENARIO("Test summary metadata decoded into typed fields", "[stub]")
+{
+    GIVEN("a stub server that reports timings, statistics and a notification")
+    {
+        struct BoltStub * stub = bolt_stub_start(3, {
+                stub_expect(HELLO),
+                stub_send(success({{"server", pack_string("Neo4j/3.5.0")}})),
+                stub_expect(RUN),
+                stub_expect(PULL),
+                stub_send(success({{"fields", pack_list({pack_string("n")})}, {"t_first", pack_int(7)}})),
+                stub_send(record(1)),
+                stub_send(success({{"type", pack_string("rw")},
+                                   {"t_last", pack_int(12)},
+                                   {"stats", pack_map({{"nodes-created", pack_int(3)},
+                                                       {"properties-set", pack_int(300)},
+                                                       {"some-new-counter", pack_int(1)}})},
+                                   {"notifications", pack_list({pack_map({{"code", pack_string("Warning")}})})},
+                                   {"bookmark", pack_string("neo4j:bookmark:v1:tx42")}})),
+        });
+        struct BoltConnection * connection = open_stub_b(stub);
+        WHEN("a query is run and its result consumed")
+        {
+            BoltConnection_set_cypher_template(connection, "CREATE (n) RETURN 1", 19);
+            BoltConnection_set_n_cypher_parameters(connection, 0);
+            BoltConnection_load_run_request(connection);
+            bolt_request_t run = BoltConnection_last_request(connection);
+            BoltConnection_load_pull_request(connection, -1);
+            bolt_request_t pull = BoltConnection_last_request(connection);
+            BoltConnection_send_b(connection);
+            THEN("well-known entries are exposed as typed values and the rest are kept")
+            {
+                REQUIRE(BoltConnection_fetch_summary_b(connection, run) == 0);
+                const struct BoltSummary * summary = BoltConnection_summary(connection);
+                REQUIRE(summary->result_available_after == 7);
+                REQUIRE(summary->result_consumed_after == -1);
+                REQUIRE(BoltConnection_n_fields(connection) == 1);
+                REQUIRE(std::string(BoltConnection_field_name(connection, 0),
+                                    (size_t)(BoltConnection_field_name_size(connection, 0))) == "n");
+                REQUIRE(BoltConnection_fetch_summary_b(connection, pull) == 1);
+                REQUIRE(summary->result_available_after == -1);
+                REQUIRE(summary->result_consumed_after == 12);
+                REQUIRE(summary->type == BOLT_QUERY_READ_WRITE);
+                REQUIRE(summary->nodes_created == 3);
+                REQUIRE(summary->properties_set == 300);
+                REQUIRE(summary->relationships_created == 0);
+                REQUIRE(summary->notifications == 1);
+                struct BoltValue * metadata = BoltMessage_value(BoltConnection_data(connection), 0);
+                REQUIRE(BoltValue_type(metadata) == BOLT_DICTIONARY);
+                REQUIRE(metadata->size == 1);
+                REQUIRE(std::string(BoltDictionary_get_key(metadata, 0),
+                                    (size_t)(BoltDictionary_get_key_size(metadata, 0))) == "notifications");
+                BoltConnection_close_b(connection);
+                REQUIRE(bolt_stub_finish(stub) == 0);
+            }
+        }
+        bolt_stub_destroy(stub);
+    }
+}
+
+SCENARIO("Test records of changing shape", "[stub]")
+{
+    GIVEN("a stub server that returns records whose layout changes part way through")
+    {
+        struct BoltStub * stub = bolt_stub_start(3, {
+                stub_expect(HELLO),
+                stub_send(success({})),
+                stub_expect(RUN),
+                stub_expect(PULL),
+                stub_send(success({{"fields", pack_list({pack_string("x"), pack_string("y")})}})),
+                stub_send(pack_message(RECORD, {pack_list({pack_int(1), pack_map({{"a", pack_int(1)}, {"b", pack_int(2)}})})})),
+                stub_send(pack_message(RECORD, {pack_list({pack_int(2), pack_map({{"a", pack_int(3)}, {"c", pack_int(4)}})})})),
+                stub_send(pack_message(RECORD, {pack_list({pack_string("three"), pack_list({pack_int(5)})})})),
+                stub_send(success({})),
+        });
+        struct BoltConnection * connection = open_stub_b(stub);
+        WHEN("the records are fetched")
+        {
+            BoltConnection_set_cypher_template(connection, "RETURN 1", 8);
+            BoltConnection_set_n_cypher_parameters(connection, 0);
+            BoltConnection_load_run_request(connection);
+            BoltConnection_load_pull_request(connection, -1);
+            bolt_request_t pull = BoltConnection_last_request(connection);
+            BoltConnection_send_b(connection);
+            struct BoltValue * data = BoltConnection_data(connection);
+            THEN("each record is decoded as sent, whatever the layout of the one before")
+            {
+                REQUIRE(BoltConnection_fetch_b(connection, pull) == 1);
+                REQUIRE(BoltConnection_fetch_b(connection, pull) == 1);
+                struct BoltValue * map = BoltList_value(data, 1);
+                REQUIRE(BoltInt64_get(BoltList_value(data, 0)) == 2);
+                REQUIRE(std::string(BoltDictionary_get_key(map, 1), (size_t)(BoltDictionary_get_key_size(map, 1))) == "c");
+                REQUIRE(BoltInt64_get(BoltDictionary_value(map, 1)) == 4);
+                REQUIRE(BoltConnection_fetch_b(connection, pull) == 1);
+                REQUIRE(BoltValue_type(BoltList_value(data, 0)) == BOLT_STRING);
+                REQUIRE(BoltValue_type(BoltList_value(data, 1)) == BOLT_LIST);
+                REQUIRE(BoltInt64_get(BoltList_value(BoltList_value(data, 1), 0)) == 5);
+                REQUIRE(BoltConnection_fetch_b(connection, pull) == 0);
+                BoltConnection_close_b(connection);
+                REQUIRE(bolt_stub_finish(stub) == 0);
+            }
+        }
+        bolt_stub_destroy(stub);
+    }
+}
+
+SCENARIO("Test boolean lists decoded as packed bit arrays", "[stub]")
+{
+    GIVEN("a stub server that returns lists of booleans")
+    {
+        std::vector<std::string> bits;
+        for (int i = 0; i < 70; i++)
+        {
+            bits.push_back(pack_bool(i % 3 == 0));
+        }
+        struct BoltStub * stub = bolt_stub_start(3, {
+                stub_expect(HELLO),
+                stub_send(success({})),
+                stub_expect(RUN),
+                stub_expect(PULL),
+                stub_send(success({{"fields", pack_list({pack_string("x")})}})),
+                stub_send(pack_message(RECORD, {pack_list({pack_list(bits)})})),
+                stub_send(pack_message(RECORD, {pack_list({pack_list({pack_bool(true), pack_int(1)})})})),
+                stub_send(pack_message(RECORD, {pack_list({pack_list({})})})),
+                stub_send(success({})),
+        });
+        struct BoltConnection * connection = open_stub_b(stub);
+        WHEN("the records are fetched")
+        {
+            BoltConnection_set_cypher_template(connection, "RETURN 1", 8);
+            BoltConnection_set_n_cypher_parameters(connection, 0);
+            BoltConnection_load_run_request(connection);
+            BoltConnection_load_pull_request(connection, -1);
+            bolt_request_t pull = BoltConnection_last_request(connection);
+            BoltConnection_send_b(connection);
+            struct BoltValue * data = BoltConnection_data(connection);
+            THEN("only lists holding nothing but booleans are packed")
+            {
+                REQUIRE(BoltConnection_fetch_b(connection, pull) == 1);
+                struct BoltValue * x = BoltList_value(data, 0);
+                REQUIRE(BoltValue_type(x) == BOLT_BIT_ARRAY);
+                REQUIRE(x->size == 70);
+                REQUIRE(BoltBitArray_count(x) == 24);
+                for (int i = 0; i < 70; i++)
+                {
+                    REQUIRE(BoltBitArray_get(x, i) == (i % 3 == 0));
+                }
+                REQUIRE(BoltConnection_fetch_b(connection, pull) == 1);
+                REQUIRE(BoltValue_type(x) == BOLT_LIST);
+                REQUIRE(BoltBit_get(BoltList_value(x, 0)) == 1);
+                REQUIRE(BoltInt64_get(BoltList_value(x, 1)) == 1);
+                REQUIRE(BoltConnection_fetch_b(connection, pull) == 1);
+                REQUIRE(BoltValue_type(x) == BOLT_LIST);
+                REQUIRE(x->size == 0);
+                REQUIRE(BoltConnection_fetch_b(connection, pull) == 0);
+                BoltConnection_close_b(connection);
+                REQUIRE(bolt_stub_finish(stub) == 0);
+            }
+        }
+        bolt_stub_destroy(stub);
+    }
+}
+
+SCENARIO("Test strings decoded as views of the receive buffer", "[stub]")
+{
+    GIVEN("a stub server that returns records holding long strings")
+    {
+        std::string name = "a string too long to be held inline";
+        struct BoltStub * stub = bolt_stub_start(3, {
+                stub_expect(HELLO),
+                stub_send(success({})),
+                stub_expect(RUN),
+                stub_expect(PULL),
+                stub_send(success({{"fields", pack_list({pack_string("x"), pack_string("y")})}})),
+                stub_send(pack_message(RECORD, {pack_list({pack_string(name), pack_map({{name, pack_string("short")}})})})),
+                stub_send(pack_message(RECORD, {pack_list({pack_string(name + "!"), pack_map({{name, pack_int(1)}})})})),
+                stub_send(success({{"db", pack_string(name)}})),
+        });
+        struct BoltConnection * connection = open_stub_b(stub);
+        WHEN("the records are fetched with string views enabled")
+        {
+            REQUIRE(BoltConnection_set_string_views(connection, 1) == 0);
+            BoltConnection_set_cypher_template(connection, "RETURN 1", 8);
+            BoltConnection_set_n_cypher_parameters(connection, 0);
+            BoltConnection_load_run_request(connection);
+            BoltConnection_load_pull_request(connection, -1);
+            bolt_request_t pull = BoltConnection_last_request(connection);
+            BoltConnection_send_b(connection);
+            struct BoltValue * data = BoltConnection_data(connection);
+            struct BoltValue * kept = BoltValue_create();
+            THEN("string values are views until materialised, while keys are always copied")
+            {
+                REQUIRE(BoltConnection_fetch_b(connection, pull) == 1);
+                struct BoltValue * x = BoltList_value(data, 0);
+                struct BoltValue * y = BoltList_value(data, 1);
+                REQUIRE(x->storage == BOLT_STORAGE_VIEW);
+                REQUIRE(std::string(BoltString_get(x), (size_t)(x->size)) == name);
+                REQUIRE(BoltDictionary_key(y, 0)->storage == BOLT_STORAGE_EXTERNAL);
+                BoltValue_copy(kept, data);
+                REQUIRE(BoltList_value(kept, 0)->storage == BOLT_STORAGE_EXTERNAL);
+                REQUIRE(BoltConnection_fetch_b(connection, pull) == 1);
+                REQUIRE(x->storage == BOLT_STORAGE_VIEW);
+                REQUIRE(std::string(BoltString_get(x), (size_t)(x->size)) == name + "!");
+                BoltValue_materialize(data);
+                REQUIRE(x->storage == BOLT_STORAGE_EXTERNAL);
+                REQUIRE(BoltConnection_fetch_b(connection, pull) == 0);
+                REQUIRE(BoltDictionary_value(BoltMessage_value(data, 0), 0)->storage == BOLT_STORAGE_EXTERNAL);
+                struct BoltValue * kept_x = BoltList_value(kept, 0);
+                REQUIRE(std::string(BoltString_get(kept_x), (size_t)(kept_x->size)) == name);
+                BoltConnection_close_b(connection);
+                REQUIRE(bolt_stub_finish(stub) == 0);
+            }
+            BoltValue_destroy(kept);
+        }
+        bolt_stub_destroy(stub);
+    }
+}
@@ -26,6 +26,7 @@
 #define REQUIRE_BOLT_INT64(value, x) { REQUIRE(BoltValue_type(value) == BOLT_INT64); REQUIRE(BoltInt64_get(value) == (x)); }
 #define REQUIRE_BOLT_FLOAT64(value, x) { REQUIRE(BoltValue_type(value) == BOLT_FLOAT64); REQUIRE( BoltFloat64_get(value) == (x)); }
 #define REQUIRE_BOLT_STRING(value, x, size_) { REQUIRE(BoltValue_type(value) == BOLT_STRING); REQUIRE(strncmp(BoltString_get(value), x, size_) == 0); REQUIRE((value)->size == (size_)); }
+#define REQUIRE_BOLT_BIT_ARRAY(value, size_) { REQUIRE(BoltValue_type(value) == BOLT_BIT_ARRAY); REQUIRE((value)->size == (size_)); }
 #define REQUIRE_BOLT_BYTE_ARRAY(value, size_) { REQUIRE(BoltValue_type(value) == BOLT_BYTE_ARRAY); REQUIRE((value)->size == (size_)); }
 #define REQUIRE_BOLT_LIST(value, size_) { REQUIRE(BoltValue_type(value) == BOLT_LIST); REQUIRE((value)->size == (size_)); }
 #define REQUIRE_BOLT_DICTIONARY(value, size_) { REQUIRE(BoltValue_type(value) == BOLT_DICTIONARY); REQUIRE((value)->size == (size_)); }
@@ -89,7 +90,7 @@ SCENARIO("Test bit in, bit out", "[integration][ipv6][secure]")
     }
 }
 
-SCENARIO("Test bit array in, list of bits out", "[integration][ipv6][secure]")
+SCENARIO("Test bit array in, bit array out", "[integration][ipv6][secure]")
 {
     GIVEN("an open and initialised connection")
     {
@@ -105,9 +106,9 @@ SCENARIO("Test bit array in, list of bits out", "[integration][ipv6][secure]")
             {
                 REQUIRE_BOLT_LIST(data, 1);
                 BoltValue * value = BoltList_value(data, 0);
-                REQUIRE_BOLT_LIST(value, 2);
-                REQUIRE_BOLT_BIT(BoltList_value(value, 0), 0);
-                REQUIRE_BOLT_BIT(BoltList_value(value, 1), 1);
+                REQUIRE_BOLT_BIT_ARRAY(value, 2);
+                REQUIRE(BoltBitArray_get(value, 0) == 0);
+                REQUIRE(BoltBitArray_get(value, 1) == 1);
             }
             REQUIRE_BOLT_SUCCESS(data);
         }
@@ -677,3 +678,194 @@ SCENARIO("Test structure in result", "[integration][ipv6][secure]")
         BoltConnection_close_b(connection);
     }
 }
+
+SCENARIO("Test repeated structures in result with entity cache", "[integration][ipv6][secure]")
+{
+    GIVEN("an open and initialised connection")
+    {
+        struct BoltConnection * connection = NEW_BOLT_CONNECTION();
+        WHEN("successfully executed Cypher")
+        {
+            BoltConnection_set_entity_cache(connection, 1);
+            BoltConnection_load_begin_request(connection);
+            const char * statement = "CREATE (a:Person {name:'Alice'}) WITH a UNWIND range(1, 3) AS n RETURN a, n";
+            BoltConnection_set_cypher_template(connection, statement, strlen(statement));
+            BoltConnection_set_n_cypher_parameters(connection, 0);
+            BoltConnection_load_run_request(connection);
+            BoltConnection_load_pull_request(connection, -1);
+            bolt_request_t result = BoltConnection_last_request(connection);
+            BoltConnection_load_rollback_request(connection);
+            BoltConnection_send_b(connection);
+            bolt_request_t last = BoltConnection_last_request(connection);
+            struct BoltValue * data = BoltConnection_data(connection);
+            struct BoltValue * first_properties = nullptr;
+            int records = 0;
+            while (BoltConnection_fetch_b(connection, result))
+            {
+                REQUIRE_BOLT_LIST(data, 2);
+                struct BoltValue * node = BoltList_value(data, 0);
+                REQUIRE_BOLT_STRUCTURE(node, 'N', 3);
+                BoltValue * properties = BoltStructure_value(node, 2);
+                REQUIRE_BOLT_DICTIONARY(properties, 1);
+                REQUIRE_BOLT_STRING(BoltDictionary_value(properties, 0), "Alice", 5);
+                if (first_properties == nullptr)
+                {
+                    first_properties = properties;
+                }
+                REQUIRE(properties == first_properties);
+                REQUIRE_BOLT_INT64(BoltList_value(data, 1), records + 1);
+                records += 1;
+            }
+            REQUIRE(records == 3);
+            BoltConnection_fetch_summary_b(connection, last);
+            REQUIRE_BOLT_SUCCESS(data);
+        }
+        BoltConnection_close_b(connection);
+    }
+}
+
+SCENARIO("Test path out", "[integration][ipv6][secure]")
+{
+    GIVEN("an open and initialised connection")
+    {
+        struct BoltConnection * connection = NEW_BOLT_CONNECTION();
+        WHEN("successfully executed Cypher")
+        {
+            BoltConnection_load_begin_request(connection);
+            const char * statement = "CREATE p=(:A)-[:X]->(:B)<-[:Y]-(:C) RETURN p";
+            BoltConnection_set_cypher_template(connection, statement, strlen(statement));
+            BoltConnection_set_n_cypher_parameters(connection, 0);
+            BoltConnection_load_run_request(connection);
+            BoltConnection_load_pull_request(connection, -1);
+            bolt_request_t result = BoltConnection_last_request(connection);
+            BoltConnection_load_rollback_request(connection);
+            BoltConnection_send_b(connection);
+            bolt_request_t last = BoltConnection_last_request(connection);
+            struct BoltValue * data = BoltConnection_data(connection);
+            int records = 0;
+            while (BoltConnection_fetch_b(connection, result))
+            {
+                REQUIRE_BOLT_LIST(data, 1);
+                struct BoltValue * path = BoltList_value(data, 0);
+                REQUIRE_BOLT_STRUCTURE(path, 'P', 3);
+                REQUIRE(BoltValue_type(BoltStructure_value(path, 2)) == BOLT_INT32_ARRAY);
+                REQUIRE(BoltPath_size(path) == 2);
+                struct BoltValue * start;
+                struct BoltValue * relationship;
+                struct BoltValue * end;
+                REQUIRE(BoltPath_segment(path, 0, &start, &relationship, &end) == 1);
+                REQUIRE_BOLT_STRUCTURE(relationship, 'r', 3);
+                REQUIRE_BOLT_STRING(BoltStructure_value(relationship, 1), "X", 1);
+                REQUIRE_BOLT_STRING(BoltList_value(BoltStructure_value(start, 1), 0), "A", 1);
+                REQUIRE_BOLT_STRING(BoltList_value(BoltStructure_value(end, 1), 0), "B", 1);
+                REQUIRE(BoltPath_segment(path, 1, &start, &relationship, &end) == -1);
+                REQUIRE_BOLT_STRING(BoltStructure_value(relationship, 1), "Y", 1);
+                REQUIRE_BOLT_STRING(BoltList_value(BoltStructure_value(end, 1), 0), "C", 1);
+                records += 1;
+            }
+            REQUIRE(records == 1);
+            BoltConnection_fetch_summary_b(connection, last);
+            REQUIRE_BOLT_SUCCESS(data);
+        }
+        BoltConnection_close_b(connection);
+    }
+}
+
+SCENARIO("Test projection of fields and properties", "[integration][ipv6][secure]")
+{
+    GIVEN("an open and initialised connection")
+    {
+        struct BoltConnection * connection = NEW_BOLT_CONNECTION();
+        WHEN("successfully executed Cypher with a projection")
+        {
+            BoltConnection_load_begin_request(connection);
+            const char * statement = "CREATE (a:Person {name: 'Alice', bio: 'Unread', age: 33}) RETURN a, 'unread', 42";
+            BoltConnection_set_cypher_template(connection, statement, strlen(statement));
+            BoltConnection_set_n_cypher_parameters(connection, 0);
+            BoltConnection_load_run_request(connection);
+            BoltConnection_load_pull_request(connection, -1);
+            bolt_request_t result = BoltConnection_last_request(connection);
+            BoltConnection_load_rollback_request(connection);
+            BoltConnection_send_b(connection);
+            bolt_request_t last = BoltConnection_last_request(connection);
+            BoltConnection_project(connection, 0, "name", 4);
+            BoltConnection_project(connection, 2, NULL, 0);
+            struct BoltValue * data = BoltConnection_data(connection);
+            int records = 0;
+            while (BoltConnection_fetch_b(connection, result))
+            {
+                REQUIRE_BOLT_LIST(data, 3);
+                struct BoltValue * node = BoltList_value(data, 0);
+                REQUIRE_BOLT_STRUCTURE(node, 'N', 3);
+                struct BoltValue * properties = BoltStructure_value(node, 2);
+                REQUIRE_BOLT_DICTIONARY(properties, 1);
+                REQUIRE_BOLT_STRING(BoltDictionary_key(properties, 0), "name", 4);
+                REQUIRE_BOLT_STRING(BoltDictionary_value(properties, 0), "Alice", 5);
+                REQUIRE_BOLT_NULL(BoltList_value(data, 1));
+                REQUIRE_BOLT_INT64(BoltList_value(data, 2), 42);
+                records += 1;
+            }
+            REQUIRE(records == 1);
+            BoltConnection_clear_projection(connection);
+            BoltConnection_fetch_summary_b(connection, last);
+            REQUIRE_BOLT_SUCCESS(data);
+        }
+        BoltConnection_close_b(connection);
+    }
+}
+
+SCENARIO("Test point in, point out", "[integration][ipv6][secure]")
+{
+    GIVEN("an open and initialised connection")
+    {
+        struct BoltConnection * connection = NEW_BOLT_CONNECTION();
+        WHEN("successfully executed Cypher")
+        {
+            PREPARE_RETURN_X(connection, x);
+            double coordinates[3] = {1.5, -2.5, 100.0};
+            BoltValue_to_Point(x, 9157, &coordinates[0], 3);
+            RUN_PULL_SEND(connection, result);
+            struct BoltValue * data = BoltConnection_data(connection);
+            while (BoltConnection_fetch_b(connection, result))
+            {
+                REQUIRE_BOLT_LIST(data, 1);
+                BoltValue * value = BoltList_value(data, 0);
+                REQUIRE(BoltValue_type(value) == BOLT_POINT);
+                REQUIRE(value->size == 3);
+                REQUIRE(BoltPoint_srid(value) == 9157);
+                REQUIRE(BoltPoint_coordinates(value)[0] == 1.5);
+                REQUIRE(BoltPoint_coordinates(value)[1] == -2.5);
+                REQUIRE(BoltPoint_coordinates(value)[2] == 100.0);
+            }
+            REQUIRE_BOLT_SUCCESS(data);
+        }
+        BoltConnection_close_b(connection);
+    }
+}
+
+SCENARIO("Test date time in, date time out", "[integration][ipv6][secure]")
+{
+    GIVEN("an open and initialised connection")
+    {
+        struct BoltConnection * connection = NEW_BOLT_CONNECTION();
+        WHEN("successfully executed Cypher")
+        {
+            PREPARE_RETURN_X(connection, x);
+            BoltValue_to_DateTime(x, 1500000000, 123456789, 3600);
+            RUN_PULL_SEND(connection, result);
+            struct BoltValue * data = BoltConnection_data(connection);
+            while (BoltConnection_fetch_b(connection, result))
+            {
+                REQUIRE_BOLT_LIST(data, 1);
+                BoltValue * value = BoltList_value(data, 0);
+                REQUIRE(BoltValue_type(value) == BOLT_DATE_TIME);
+                struct BoltDateTime date_time = BoltDateTime_get(value);
+                REQUIRE(date_time.seconds == 1500000000);
+                REQUIRE(date_time.nanoseconds == 123456789);
+                REQUIRE(date_time.tz_offset_seconds == 3600);
+            }
+            REQUIRE_BOLT_SUCCESS(data);
+        }
+        BoltConnection_close_b(connection);
+    }
+}
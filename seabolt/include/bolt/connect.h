@@ -26,6 +26,7 @@
 
 #include "addressing.h"
 #include "config.h"
+#include "packstream.h"
 #include <stdint.h>
 #include <stdio.h>
 
@@ -77,6 +78,20 @@ enum BoltConnectionError
     BOLT_TLS_ERROR,             // general catch-all for OpenSSL errors :/
     BOLT_PROTOCOL_VIOLATION,
     BOLT_END_OF_TRANSMISSION,
+    BOLT_RESPONSE_BUFFER_FULL,
+    BOLT_RESULT_TRUNCATED,      // windowed result with more records, but later requests queued behind it
+};
+
+/**
+ * Policy for responses that arrive ahead of the request being fetched
+ * once the response buffer is full.
+ */
+enum BoltResponseOverflow
+{
+    /// Read no further ahead until held responses have been fetched
+    BOLT_OVERFLOW_BLOCK,
+    /// Hold further responses in a temporary file
+    BOLT_OVERFLOW_SPILL,
 };
 
 /**
@@ -97,6 +112,8 @@ struct BoltConnection
 
     /// The protocol version used for this connection
     int32_t protocol_version;
+    /// Operations of the protocol version, installed by the handshake
+    const struct BoltProtocol* protocol;
     /// State required by the protocol
     void* protocol_state;
 
@@ -115,6 +132,109 @@ struct BoltConnection
     enum BoltConnectionError error;
 };
 
+/**
+ * A RUN request prepared for repeated execution.
+ *
+ * The statement and parameter keys are encoded once, when the request
+ * is prepared. Each execution then only encodes the parameter values,
+ * splicing them into the pre-encoded bytes at the recorded slots.
+ */
+struct BoltPreparedRequest
+{
+    /// The protocol version for which the request was encoded
+    int32_t protocol_version;
+    /// The request as a message, holding the parameter values to send
+    struct BoltValue* request;
+    /// The encoded request, excluding parameter values
+    struct BoltBuffer* encoded;
+    /// Number of parameter value slots
+    int32_t n_slots;
+    /// Offset within `encoded` at which each parameter value belongs
+    int32_t* slots;
+};
+
+/**
+ * Element types of a column of a `BoltColumnBatch`.
+ */
+enum BoltColumnType
+{
+    BOLT_INT64_COLUMN,
+    BOLT_FLOAT64_COLUMN,
+    BOLT_STRING_COLUMN,
+};
+
+/**
+ * A column of a `BoltColumnBatch`, referring to application arrays.
+ */
+struct BoltColumn
+{
+    /// The key under which values of this column appear in each row (NULL if not yet set)
+    const char* name;
+    int32_t name_size;
+    enum BoltColumnType type;
+    /// Array of `int64_t`, `double` or `const char*`, according to the type
+    const void* values;
+    /// Array of string sizes (string columns only; NULL for null-terminated strings)
+    const int32_t* sizes;
+    /// Bitmap marking null values, one bit per row, least significant bit first (NULL if none are null)
+    const uint8_t* nulls;
+};
+
+/**
+ * A batch of rows held in columns, for loading as a list of maps such as
+ * the parameter of a bulk `UNWIND $rows AS row` statement.
+ */
+struct BoltColumnBatch
+{
+    int32_t n_columns;
+    struct BoltColumn* columns;
+};
+
+/**
+ * Kinds of query, as reported in summary metadata.
+ */
+enum BoltQueryType
+{
+    BOLT_QUERY_UNKNOWN,
+    /// Read only ("r")
+    BOLT_QUERY_READ_ONLY,
+    /// Read and write ("rw")
+    BOLT_QUERY_READ_WRITE,
+    /// Write only ("w")
+    BOLT_QUERY_WRITE_ONLY,
+    /// Schema write ("s")
+    BOLT_QUERY_SCHEMA_WRITE,
+};
+
+/**
+ * Summary metadata of the last SUCCESS received, decoded as it arrives.
+ * Timings not reported are -1; counts not reported are 0.
+ */
+struct BoltSummary
+{
+    /// Time in milliseconds until the first record was available ("result_available_after" or "t_first")
+    int64_t result_available_after;
+    /// Time in milliseconds until the last record was consumed ("result_consumed_after" or "t_last")
+    int64_t result_consumed_after;
+    enum BoltQueryType type;
+    /// Non-zero if the server has more records to pull (Bolt v4)
+    int has_more;
+    /// Number of notifications (the notifications themselves remain in the summary message)
+    int32_t notifications;
+    int64_t nodes_created;
+    int64_t nodes_deleted;
+    int64_t relationships_created;
+    int64_t relationships_deleted;
+    int64_t properties_set;
+    int64_t labels_added;
+    int64_t labels_removed;
+    int64_t indexes_added;
+    int64_t indexes_removed;
+    int64_t constraints_added;
+    int64_t constraints_removed;
+    int64_t system_updates;
+};
+
 
 /**
  * Open a connection to a Bolt server.
@@ -183,6 +303,17 @@ PUBLIC int BoltConnection_init_b(struct BoltConnection* connection, const char*
  */
 PUBLIC int BoltConnection_send_b(struct BoltConnection * connection);
 
+/**
+ * Ensure that at least a given amount of data is held in the receive
+ * buffer, deferring to the socket if not enough data is available.
+ * Nothing is taken from the buffer.
+ *
+ * @param connection
+ * @param size
+ * @return 0 on success, -1 on failure
+ */
+PUBLIC int BoltConnection_buffer_b(struct BoltConnection * connection, int size);
+
 /**
  * Take an exact amount of data from the receive buffer, deferring to
  * the socket if not enough data is available.
@@ -197,7 +328,8 @@ PUBLIC int BoltConnection_receive_b(struct BoltConnection * connection, char * b
 /**
  * Fetch the next value from the result stream for a given request.
  * This will discard the responses of earlier requests that have not
- * already been fully consumed. This function will always consume at
+ * already been fully consumed, unless a response buffer has been set
+ * with `BoltConnection_set_response_buffer`. This function will always consume at
  * least one record from the result stream and is not able to check
  * whether the given request has already been fully consumed; doing
  * so is the responsibility of the calling application.
@@ -217,11 +349,58 @@ PUBLIC int BoltConnection_receive_b(struct BoltConnection * connection, char * b
  */
 PUBLIC int BoltConnection_fetch_b(struct BoltConnection * connection, bolt_request_t request);
 
+/**
+ * Fetch the next value from the result stream for a given request, as
+ * `BoltConnection_fetch_b` does, except that record data is not decoded
+ * into `BoltConnection_data`. Instead, the record is left in the receive
+ * buffer and the reader is positioned at its start, so that it can be
+ * consumed event by event with `BoltPackReader_next`. The record is
+ * released by the next fetch on the connection. Summary metadata is
+ * received exactly as for `BoltConnection_fetch_b`.
+ *
+ * @param connection the connection to fetch from
+ * @param request the request for which to fetch a response
+ * @param reader the reader to position at the start of the record
+ * @return 1 if record data is ready to be read,
+ *         0 if summary metadata is received,
+ *         -1 if an error occurs
+ */
+PUBLIC int BoltConnection_fetch_reader_b(struct BoltConnection * connection, bolt_request_t request,
+                                         struct BoltPackReader * reader);
+
+/**
+ * Fetch a batch of records from the result stream for a given request.
+ * Records are decoded directly into the items of a `BOLT_LIST`, which is
+ * made to hold at least `max_records` items if it does not already; its
+ * size is otherwise left as it is, so that the same list can be passed to
+ * every call and its storage recycled. Items beyond the number of records
+ * fetched are left untouched.
+ *
+ * As for `BoltConnection_fetch_b`, at least one message is consumed, and
+ * the call blocks until it is available. Further records are decoded only
+ * while they have already been received in full (or are held in the
+ * response buffer), so the call returns early rather than block again.
+ * A summary always arrives on its own, in a call that returns 0, after
+ * which the value returned by `BoltConnection_data` holds the summary
+ * metadata (in a `BOLT_SUMMARY`).
+ *
+ * @param connection the connection to fetch from
+ * @param request the request for which to fetch a response
+ * @param max_records the maximum number of records to fetch
+ * @param records the list into which to decode the records
+ * @return the number of records fetched (>0),
+ *         0 if summary metadata is received,
+ *         -1 if an error occurs
+ */
+PUBLIC int BoltConnection_fetch_batch_b(struct BoltConnection * connection, bolt_request_t request,
+                                        int32_t max_records, struct BoltValue * records);
+
 /**
  * Fetch values from the result stream for a given request, up to and
  * including the next summary. This will discard any unconsumed result
  * data for this request as well as the responses of earlier requests
- * that have not already been fully consumed. This function will always
+ * that have not already been fully consumed (unless these are held in
+ * a response buffer). This function will always
  * consume at least one record from the result stream and is not able
  * to check whether the given request has already been fully consumed;
  * doing so is the responsibility of the calling application.
@@ -255,6 +434,21 @@ PUBLIC int BoltConnection_fetch_summary_b(struct BoltConnection * connection, bo
  */
 PUBLIC struct BoltValue * BoltConnection_data(struct BoltConnection * connection);
 
+/**
+ * Obtain the typed summary metadata of the last SUCCESS received.
+ *
+ * Well-known metadata entries are decoded straight into this struct, and
+ * field names into the list read by `BoltConnection_field_name`; only the
+ * remaining entries (such as notifications or a query plan) are kept in
+ * the summary message returned by `BoltConnection_data`. The struct is
+ * overwritten by each summary received, including those of responses
+ * skipped on the way to the one being fetched.
+ *
+ * @param connection
+ * @return pointer to the summary, or NULL if no protocol is in use
+ */
+PUBLIC const struct BoltSummary * BoltConnection_summary(struct BoltConnection * connection);
+
 /**
  * Set a Cypher statement for subsequent execution.
  *
@@ -278,6 +472,137 @@ PUBLIC int BoltConnection_set_cypher_parameter_key(struct BoltConnection * conne
 
 PUBLIC struct BoltValue* BoltConnection_cypher_parameter_value(struct BoltConnection * connection, int32_t index);
 
+/**
+ * Enable or disable the entity cache for subsequent results.
+ *
+ * While enabled, each node and relationship received within a result is
+ * decoded only once. Later occurrences of the same entity (identified by
+ * its ID) are skipped over on the wire and refer to the shared, previously
+ * decoded value instead. Such shared values must be treated as read-only.
+ * The cache is cleared whenever a summary is received.
+ *
+ * @param connection
+ * @param enabled non-zero to enable the cache, zero to disable it
+ * @return 0 on success, -1 if not supported by the protocol version
+ */
+PUBLIC int BoltConnection_set_entity_cache(struct BoltConnection * connection, int enabled);
+
+/**
+ * Enable or disable string views for subsequent records.
+ *
+ * While enabled, strings and byte arrays within records are not copied
+ * out of the receive buffer; values instead view the data where it was
+ * received. Such views are only valid until the next fetch, after which
+ * they must not be read. `BoltValue_materialize` turns the views within
+ * a value into copies that can be kept. Map keys, summaries and entities
+ * held by the entity cache are always copied.
+ *
+ * @param connection
+ * @param enabled non-zero to enable string views, zero to disable them
+ * @return 0 on success, -1 if not supported by the protocol version
+ */
+PUBLIC int BoltConnection_set_string_views(struct BoltConnection * connection, int enabled);
+
+/**
+ * Restrict the decoding of subsequent records to a projection of their
+ * fields and property keys.
+ *
+ * Each call adds one field to the projection, optionally narrowed to a
+ * dot-separated path of property keys (for example "address.city").
+ * Paths apply to maps and to the properties of nodes and relationships,
+ * including those held within lists. Only projected fields and keys are
+ * decoded; everything else is skipped over on the wire. Fields that are
+ * not projected are received as null, and keys that are not projected
+ * are omitted from their map. With an empty path, the whole field is
+ * decoded.
+ *
+ * @param connection
+ * @param field index of the record field to project
+ * @param path dot-separated property key path, or NULL for the whole field
+ * @param path_size size of the path in bytes (0 for the whole field)
+ * @return 0 on success, -1 if not supported by the protocol version
+ */
+PUBLIC int BoltConnection_project(struct BoltConnection * connection, int32_t field, const char * path, size_t path_size);
+
+/**
+ * Remove any projection, so that subsequent records are decoded in full.
+ *
+ * @param connection
+ * @return 0 on success, -1 if not supported by the protocol version
+ */
+PUBLIC int BoltConnection_clear_projection(struct BoltConnection * connection);
+
+/**
+ * Set the number of records to request at a time for subsequent
+ * results (Bolt v4 onwards).
+ *
+ * With a positive fetch size, each PULL request loaded with `n = -1`
+ * asks the server for only that many records. Once they have all been
+ * fetched, and if the server has more, a further PULL is sent
+ * automatically, so that records arrive in windows as they are consumed
+ * rather than as fast as the server can stream them. Refills are only
+ * made while no later request is queued behind the result; should the
+ * server have more records once a later request has been queued, the
+ * fetch that receives the summary fails with `BOLT_RESULT_TRUNCATED`.
+ * When a result is discarded through `BoltConnection_fetch_summary_b`,
+ * the remainder is discarded on the server instead.
+ *
+ * @param connection
+ * @param size number of records per window, or -1 to request all records at once
+ * @return 0 on success, -1 if not supported by the protocol version
+ */
+PUBLIC int BoltConnection_set_fetch_size(struct BoltConnection * connection, int32_t size);
+
+/**
+ * Hold back responses to earlier requests, rather than discarding them,
+ * so that the results of pipelined requests can be fetched in any order.
+ *
+ * By default, fetching a request discards any unfetched records and
+ * summaries of the requests before it. With a response buffer, these are
+ * instead held, still encoded, in a queue for each request, and
+ * `BoltConnection_fetch_b` and `BoltConnection_fetch_summary_b` take
+ * from that queue when called for such a request later on. Once
+ * `max_size` bytes are held, further responses are handled according to
+ * the overflow policy: with `BOLT_OVERFLOW_BLOCK`, a fetch that would
+ * need to read further ahead fails with `BOLT_RESPONSE_BUFFER_FULL`
+ * (leaving the connection usable once held responses are fetched); with
+ * `BOLT_OVERFLOW_SPILL`, further responses are held in a temporary file.
+ * A single message may take the amount held beyond `max_size`.
+ *
+ * @param connection
+ * @param max_size number of bytes that may be held in memory, or 0 to
+ *                 stop holding responses (dropping any already held)
+ * @param overflow
+ * @return 0 on success, -1 if not supported by the protocol version
+ */
+PUBLIC int BoltConnection_set_response_buffer(struct BoltConnection * connection, size_t max_size,
+                                              enum BoltResponseOverflow overflow);
+
+/**
+ * Obtain the number of response bytes currently held in memory.
+ *
+ * @param connection
+ * @return
+ */
+PUBLIC size_t BoltConnection_buffered_response_size(struct BoltConnection * connection);
+
+/**
+ * Obtain the highest number of response bytes held in memory at once
+ * since the response buffer was set.
+ *
+ * @param connection
+ * @return
+ */
+PUBLIC size_t BoltConnection_peak_buffered_response_size(struct BoltConnection * connection);
+
+/**
+ * Obtain the number of response bytes currently held in the spill file.
+ *
+ * @param connection
+ * @return
+ */
+PUBLIC size_t BoltConnection_spilled_response_size(struct BoltConnection * connection);
+
 PUBLIC int BoltConnection_load_bookmark(struct BoltConnection * connection, const char * bookmark);
 
 PUBLIC int BoltConnection_load_begin_request(struct BoltConnection * connection);
@@ -288,8 +613,206 @@ PUBLIC int BoltConnection_load_rollback_request(struct BoltConnection * connecti
 
 PUBLIC int BoltConnection_load_run_request(struct BoltConnection * connection);
 
+/**
+ * Begin a RUN request for the current Cypher template, whose parameters
+ * are completed by writing them token by token.
+ *
+ * The statement and any parameters already set are encoded immediately.
+ * The returned writer must then be used to write exactly `size` further
+ * parameters, each as a key (`BoltPackWriter_key`) followed by a value,
+ * before the request is completed by `BoltConnection_close_run_writer`.
+ * Complete chunks are moved to the connection transmit buffer as they
+ * are written, so `BoltConnection_send_b` may be called at any point to
+ * bound memory use for large parameters. No other request can be loaded
+ * until the writer has been closed, and the writer refuses any further
+ * tokens once it has been closed.
+ *
+ * @param connection
+ * @param size number of further parameters to be written
+ * @return the writer, owned by the connection, or NULL on failure or if
+ *         a stream or writer is already open
+ */
+PUBLIC struct BoltPackWriter * BoltConnection_open_run_writer(struct BoltConnection * connection, int32_t size);
+
+/**
+ * Complete a RUN request begun with `BoltConnection_open_run_writer`
+ * and queue the remainder for sending.
+ *
+ * @param connection
+ * @return 0 on success, -1 if no writer is open or (in debug builds) if
+ *         not all declared values have been written
+ */
+PUBLIC int BoltConnection_close_run_writer(struct BoltConnection * connection);
+
+/**
+ * Load a RUN request for the current Cypher template and parameters,
+ * plus one further parameter holding the rows of a column batch as a
+ * list of maps (one map per row, keyed by column name). Values are
+ * encoded directly from the column arrays, without building a value for
+ * each cell, and are sent to the server as chunks become complete, as
+ * for `BoltConnection_open_run_stream_b`.
+ *
+ * @param connection
+ * @param key parameter key for the list of rows
+ * @param key_size size of the key
+ * @param batch
+ * @param n_rows number of rows, which all columns must hold
+ * @return 0 on success, -1 on failure or if a column has not been set or
+ *         holds a NULL string that is not marked as null
+ */
+PUBLIC int BoltConnection_load_run_batch_b(struct BoltConnection * connection, const char * key, size_t key_size,
+                                           struct BoltColumnBatch * batch, int32_t n_rows);
+
+/**
+ * Create a column batch. The batch refers to, rather than copies, the
+ * names and arrays given for its columns, which must remain valid until
+ * the batch has been loaded.
+ *
+ * @param n_columns
+ * @return pointer to a new column batch
+ */
+PUBLIC struct BoltColumnBatch * BoltColumnBatch_create(int32_t n_columns);
+
+PUBLIC void BoltColumnBatch_destroy(struct BoltColumnBatch * batch);
+
+/**
+ * Set a column of 64-bit integers.
+ *
+ * @param batch
+ * @param index
+ * @param name
+ * @param name_size
+ * @param values
+ * @param nulls bitmap of null values, or NULL if none are null
+ * @return 0 on success, -1 if the index is out of range
+ */
+PUBLIC int BoltColumnBatch_set_int64_column(struct BoltColumnBatch * batch, int32_t index, const char * name,
+                                            size_t name_size, const int64_t * values, const uint8_t * nulls);
+
+PUBLIC int BoltColumnBatch_set_float64_column(struct BoltColumnBatch * batch, int32_t index, const char * name,
+                                              size_t name_size, const double * values, const uint8_t * nulls);
+
+/**
+ * Set a column of strings.
+ *
+ * @param batch
+ * @param index
+ * @param name
+ * @param name_size
+ * @param values
+ * @param sizes sizes of the strings, or NULL if they are null-terminated
+ * @param nulls bitmap of null values, or NULL if none are null
+ * @return 0 on success, -1 if the index is out of range
+ */
+PUBLIC int BoltColumnBatch_set_string_column(struct BoltColumnBatch * batch, int32_t index, const char * name,
+                                             size_t name_size, const char * const * values, const int32_t * sizes,
+                                             const uint8_t * nulls);
+
+/**
+ * Prepare the current Cypher template and parameter keys (as set by
+ * `BoltConnection_set_cypher_template` and friends) for repeated
+ * execution. The parameter values are copied as initial values, and may
+ * then be changed through `BoltPreparedRequest_parameter_value` between
+ * executions. The prepared request remains valid when the connection's
+ * own template is changed.
+ *
+ * @param connection
+ * @return a new prepared request, or NULL if it could not be encoded
+ */
+PUBLIC struct BoltPreparedRequest * BoltConnection_prepare_run_request(struct BoltConnection * connection);
+
+/**
+ * Queue a RUN request from a prepared request and its current
+ * parameter values.
+ *
+ * @param connection
+ * @param prepared
+ * @return 0 on success, -1 if the request was prepared for a different
+ *         protocol version or a parameter value cannot be encoded
+ */
+PUBLIC int BoltConnection_load_prepared_run_request(struct BoltConnection * connection,
+                                                    struct BoltPreparedRequest * prepared);
+
+/**
+ * Obtain a parameter value of a prepared request, for modification.
+ *
+ * @param prepared
+ * @param index parameter index, in the order the keys were set
+ * @return pointer to the value, or NULL if the index is out of range
+ */
+PUBLIC struct BoltValue * BoltPreparedRequest_parameter_value(struct BoltPreparedRequest * prepared, int32_t index);
+
+/**
+ * Destroy a prepared request.
+ *
+ * @param prepared
+ */
+PUBLIC void BoltPreparedRequest_destroy(struct BoltPreparedRequest * prepared);
+
+/**
+ * Begin a RUN request whose parameters include a list that is too large
+ * to build in memory, such as the rows of a bulk UNWIND.
+ *
+ * The statement and any parameters already set are encoded immediately,
+ * followed by a parameter with the given key, holding a list of exactly
+ * `size` values. Each value is then passed in turn to
+ * `BoltConnection_load_stream_value_b`, and the request is completed by
+ * `BoltConnection_close_run_stream_b`. As the request is built, complete
+ * chunks are sent to the server, so memory use is bounded regardless of
+ * the overall size of the request. Any requests queued beforehand are
+ * sent along with it. No other request can be loaded until the stream
+ * has been closed.
+ *
+ * If a value cannot be encoded, the request is abandoned. Should part of
+ * it already have been sent, the connection becomes `BOLT_DEFUNCT`.
+ *
+ * @param connection
+ * @param key parameter key for the streamed list
+ * @param key_size size of the key
+ * @param size number of values that will be streamed
+ * @return 0 on success, -1 on failure or if a stream or writer is already open
+ */
+PUBLIC int BoltConnection_open_run_stream_b(struct BoltConnection * connection, const char * key, size_t key_size,
+                                            int32_t size);
+
+/**
+ * Encode the next value of the list opened by
+ * `BoltConnection_open_run_stream_b`, sending data to the server when
+ * enough has accumulated. The value may be reused immediately.
+ *
+ * @param connection
+ * @param value
+ * @return 0 on success, -1 on failure or if all values have already been streamed
+ */
+PUBLIC int BoltConnection_load_stream_value_b(struct BoltConnection * connection, struct BoltValue * value);
+
+/**
+ * Complete a streamed RUN request and queue the remainder for sending.
+ *
+ * @param connection
+ * @return 0 on success, -1 if the number of values streamed does not
+ *         match the size given when the stream was opened
+ */
+PUBLIC int BoltConnection_close_run_stream_b(struct BoltConnection * connection);
+
+/**
+ * Queue a request to discard records from the current result.
+ *
+ * @param connection
+ * @param n number of records to discard, or -1 for all (a limited number
+ *          is only supported from Bolt v4)
+ * @return 0 on success, -1 if not supported by the protocol version
+ */
 PUBLIC int BoltConnection_load_discard_request(struct BoltConnection * connection, int32_t n);
 
+/**
+ * Queue a request to pull records from the current result.
+ *
+ * @param connection
+ * @param n number of records to pull, or -1 for all (a limited number is
+ *          only supported from Bolt v4); see also `BoltConnection_set_fetch_size`
+ * @return 0 on success, -1 if not supported by the protocol version
+ */
 PUBLIC int BoltConnection_load_pull_request(struct BoltConnection * connection, int32_t n);
 
 /**
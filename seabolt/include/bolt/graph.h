@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2002-2017 "Neo Technology,"
+ * Network Engine for Objects in Lund AB [http://neotechnology.com]
+ *
+ * This file is part of Neo4j.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ */
+
+#ifndef SEABOLT_GRAPH
+#define SEABOLT_GRAPH
+
+#include <stdint.h>
+
+#include "config.h"
+#include "values.h"
+
+
+struct _graph_id_map;
+
+/**
+ * An in-memory graph assembled from the nodes, relationships and paths
+ * received in one or more results.
+ *
+ * Nodes and relationships are identified by a dense index (0..n-1)
+ * rather than by their server-side ID. Once built, adjacency is held in
+ * compressed sparse row (CSR) form: the outgoing relationships of node
+ * `i` are found at positions `out_offsets[i]` to `out_offsets[i + 1] - 1`
+ * of `out_targets` and `out_relationships`, and similarly for incoming
+ * relationships. Properties are held in columns, one `BOLT_LIST` per
+ * property key, indexed by node or relationship index.
+ *
+ * The CSR arrays are only valid after a call to `BoltGraph_build` and
+ * until the next call to `BoltGraph_add`.
+ */
+struct BoltGraph
+{
+    /// Number of distinct nodes
+    int32_t n_nodes;
+    /// Number of distinct relationships
+    int32_t n_relationships;
+
+    /// Server-side ID of each node
+    int64_t* node_ids;
+    /// Server-side ID of each relationship
+    int64_t* relationship_ids;
+    /// Start node index of each relationship
+    int32_t* relationship_starts;
+    /// End node index of each relationship
+    int32_t* relationship_ends;
+    /// Type of each relationship, as an index into `type_names`
+    int32_t* relationship_types;
+
+    /// Offsets into the outgoing arrays for each node (n_nodes + 1 entries)
+    int32_t* out_offsets;
+    /// End node index of each outgoing relationship
+    int32_t* out_targets;
+    /// Relationship index of each outgoing relationship
+    int32_t* out_relationships;
+    /// Offsets into the incoming arrays for each node (n_nodes + 1 entries)
+    int32_t* in_offsets;
+    /// Start node index of each incoming relationship
+    int32_t* in_sources;
+    /// Relationship index of each incoming relationship
+    int32_t* in_relationships;
+    /// Offsets into `labels` for each node (n_nodes + 1 entries)
+    int32_t* label_offsets;
+    /// Labels of each node, as indexes into `label_names`
+    int32_t* labels;
+
+    /// Distinct label names (a `BOLT_LIST` of `BOLT_STRING` values)
+    struct BoltValue* label_names;
+    /// Distinct relationship type names (a `BOLT_LIST` of `BOLT_STRING` values)
+    struct BoltValue* type_names;
+    /// Node property columns (a `BOLT_DICTIONARY` of `BOLT_LIST` values)
+    struct BoltValue* node_properties;
+    /// Relationship property columns (a `BOLT_DICTIONARY` of `BOLT_LIST` values)
+    struct BoltValue* relationship_properties;
+
+    // Everything below is internal bookkeeping for assembly.
+
+    struct _graph_id_map* node_map;
+    struct _graph_id_map* relationship_map;
+    int32_t node_capacity;
+    int32_t relationship_capacity;
+    /// Non-zero for each node whose labels and properties have been received
+    char* node_complete;
+    int32_t n_label_entries;
+    int32_t label_entry_capacity;
+    int32_t* label_entry_nodes;
+    int32_t* label_entry_labels;
+    /// Sizes of the CSR arrays as last built (for deallocation)
+    int32_t built_nodes;
+    int32_t built_relationships;
+    int32_t built_labels;
+};
+
+
+/**
+ * Create a new, empty graph.
+ *
+ * @return pointer to a new BoltGraph
+ */
+PUBLIC struct BoltGraph* BoltGraph_create();
+
+/**
+ * Destroy a graph, releasing all of its storage.
+ *
+ * @param graph
+ */
+PUBLIC void BoltGraph_destroy(struct BoltGraph* graph);
+
+/**
+ * Add all nodes, relationships and paths found within a value to the
+ * graph. Lists, dictionaries and structures are searched recursively, so
+ * a whole record (as returned by `BoltConnection_data`) can be passed
+ * directly. Entities already present in the graph are not added again.
+ *
+ * Everything required is copied out of the value, so the value may be
+ * recycled or destroyed immediately afterwards.
+ *
+ * @param graph
+ * @param value
+ * @return 0 on success, -1 if a graph structure is malformed
+ */
+PUBLIC int BoltGraph_add(struct BoltGraph* graph, const struct BoltValue* value);
+
+/**
+ * Build (or rebuild) the adjacency and label arrays from everything
+ * added so far, and trim property columns to size.
+ *
+ * @param graph
+ */
+PUBLIC void BoltGraph_build(struct BoltGraph* graph);
+
+/**
+ * Look up the index of a node by its server-side ID.
+ *
+ * @param graph
+ * @param id
+ * @return the node index, or -1 if no such node exists
+ */
+PUBLIC int32_t BoltGraph_node_index(const struct BoltGraph* graph, int64_t id);
+
+/**
+ * Look up the index of a relationship by its server-side ID.
+ *
+ * @param graph
+ * @param id
+ * @return the relationship index, or -1 if no such relationship exists
+ */
+PUBLIC int32_t BoltGraph_relationship_index(const struct BoltGraph* graph, int64_t id);
+
+/**
+ * Obtain the end nodes of all outgoing relationships of a node. The
+ * corresponding relationship indexes are held at the same positions,
+ * starting at `out_relationships + out_offsets[node]`.
+ *
+ * @param graph a built graph
+ * @param node
+ * @param size pointer to receive the number of outgoing relationships
+ * @return pointer to the first end node index
+ */
+PUBLIC const int32_t* BoltGraph_outgoing(const struct BoltGraph* graph, int32_t node, int32_t* size);
+
+/**
+ * Obtain the start nodes of all incoming relationships of a node. The
+ * corresponding relationship indexes are held at the same positions,
+ * starting at `in_relationships + in_offsets[node]`.
+ *
+ * @param graph a built graph
+ * @param node
+ * @param size pointer to receive the number of incoming relationships
+ * @return pointer to the first start node index
+ */
+PUBLIC const int32_t* BoltGraph_incoming(const struct BoltGraph* graph, int32_t node, int32_t* size);
+
+/**
+ * Obtain the labels of a node, as indexes into `label_names`.
+ *
+ * @param graph a built graph
+ * @param node
+ * @param size pointer to receive the number of labels
+ * @return pointer to the first label index
+ */
+PUBLIC const int32_t* BoltGraph_node_labels(const struct BoltGraph* graph, int32_t node, int32_t* size);
+
+/**
+ * Obtain the value of a node property.
+ *
+ * @param graph
+ * @param node
+ * @param key
+ * @param key_size
+ * @return pointer to the value (`BOLT_NULL` if not set for this node),
+ *         or NULL if no node has this property
+ */
+PUBLIC struct BoltValue* BoltGraph_node_property(const struct BoltGraph* graph, int32_t node,
+                                                 const char* key, size_t key_size);
+
+/**
+ * Obtain the value of a relationship property.
+ *
+ * @param graph
+ * @param relationship
+ * @param key
+ * @param key_size
+ * @return pointer to the value (`BOLT_NULL` if not set for this
+ *         relationship), or NULL if no relationship has this property
+ */
+PUBLIC struct BoltValue* BoltGraph_relationship_property(const struct BoltGraph* graph, int32_t relationship,
+                                                         const char* key, size_t key_size);
+
+
+#endif // SEABOLT_GRAPH
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2002-2017 "Neo Technology,"
+ * Network Engine for Objects in Lund AB [http://neotechnology.com]
+ *
+ * This file is part of Neo4j.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ */
+
+#ifndef SEABOLT_PACKSTREAM
+#define SEABOLT_PACKSTREAM
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "config.h"
+
+
+#define BOLT_PACK_WRITER_MAX_DEPTH 32
+
+/**
+ * Writer for encoding PackStream values token by token, directly into
+ * an outgoing request, without building a `BoltValue` for them first.
+ *
+ * Container tokens (lists, maps and structures) are followed by exactly
+ * as many values as their size declares; map entries are written as a
+ * key followed by a value. In debug builds (without `NDEBUG`), the
+ * writer tracks nesting and fails any token that does not fit; in
+ * release builds, no checking takes place.
+ */
+struct BoltPackWriter
+{
+    /// The connection whose request is being written
+    struct BoltConnection* connection;
+    /// Non-zero while the writer is open
+    int open;
+    /// Current depth of nesting (tracked in debug builds only)
+    int32_t depth;
+    /// Number of tokens still expected at each depth
+    int32_t remaining[BOLT_PACK_WRITER_MAX_DEPTH];
+    /// Non-zero at each depth that is a map, whose entries begin with a key
+    char is_map[BOLT_PACK_WRITER_MAX_DEPTH];
+};
+
+PUBLIC int BoltPackWriter_null(struct BoltPackWriter* writer);
+
+PUBLIC int BoltPackWriter_boolean(struct BoltPackWriter* writer, int x);
+
+PUBLIC int BoltPackWriter_integer(struct BoltPackWriter* writer, int64_t x);
+
+PUBLIC int BoltPackWriter_float(struct BoltPackWriter* writer, double x);
+
+PUBLIC int BoltPackWriter_string(struct BoltPackWriter* writer, const char* string, int32_t size);
+
+PUBLIC int BoltPackWriter_bytes(struct BoltPackWriter* writer, const char* data, int32_t size);
+
+/**
+ * Write a map key. This is encoded exactly as a string, but in debug
+ * builds is checked to appear where a key is expected.
+ *
+ * @param writer
+ * @param key
+ * @param size
+ * @return 0 on success, -1 on failure
+ */
+PUBLIC int BoltPackWriter_key(struct BoltPackWriter* writer, const char* key, int32_t size);
+
+/**
+ * Begin a list, to be followed by `size` values.
+ *
+ * @param writer
+ * @param size
+ * @return 0 on success, -1 on failure
+ */
+PUBLIC int BoltPackWriter_begin_list(struct BoltPackWriter* writer, int32_t size);
+
+/**
+ * Begin a map, to be followed by `size` entries, each written as a key
+ * and a value.
+ *
+ * @param writer
+ * @param size
+ * @return 0 on success, -1 on failure
+ */
+PUBLIC int BoltPackWriter_begin_map(struct BoltPackWriter* writer, int32_t size);
+
+/**
+ * Begin a structure, to be followed by `size` fields.
+ *
+ * @param writer
+ * @param code
+ * @param size
+ * @return 0 on success, -1 on failure
+ */
+PUBLIC int BoltPackWriter_begin_structure(struct BoltPackWriter* writer, int16_t code, int8_t size);
+
+
+#define BOLT_PACK_READER_MAX_DEPTH 32
+
+/**
+ * Events returned by `BoltPackReader_next`.
+ */
+enum BoltPackEvent
+{
+    BOLT_PACK_NULL,
+    BOLT_PACK_BOOLEAN,
+    BOLT_PACK_INTEGER,
+    BOLT_PACK_FLOAT,
+    BOLT_PACK_STRING,
+    BOLT_PACK_BYTES,
+    BOLT_PACK_KEY,
+    BOLT_PACK_START_LIST,
+    BOLT_PACK_START_MAP,
+    BOLT_PACK_STRUCTURE,
+    /// The end of a list, map or structure
+    BOLT_PACK_END,
+    /// The end of the record; returned for every call thereafter
+    BOLT_PACK_END_OF_RECORD,
+};
+
+/**
+ * Reader for consuming a received record as a stream of PackStream
+ * events, directly from the buffer into which it was received, without
+ * building a `BoltValue` for it first. A reader is positioned at the
+ * start of a record by `BoltConnection_fetch_reader_b`.
+ *
+ * A record begins with a `BOLT_PACK_START_LIST` event for its fields.
+ * Every list, map and structure event is followed by the events for its
+ * contents and then a `BOLT_PACK_END` event; map entries are read as a
+ * `BOLT_PACK_KEY` event followed by the events for the value.
+ *
+ * String, bytes and key data is not copied: `data` points into the
+ * receive buffer and remains valid only until the next fetch on the
+ * connection.
+ */
+struct BoltPackReader
+{
+    /// The connection whose record is being read
+    struct BoltConnection* connection;
+    /// Value of the last BOOLEAN (0 or 1) or INTEGER event
+    int64_t integer;
+    /// Value of the last FLOAT event
+    double real;
+    /// Data of the last STRING, BYTES or KEY event
+    const char* data;
+    /// Size in bytes of the last STRING, BYTES or KEY event, or number of
+    /// items, entries or fields of the last START_LIST, START_MAP or STRUCTURE event
+    int32_t size;
+    /// Code of the last STRUCTURE event
+    int16_t code;
+    /// Non-zero once the first event of the record has been read
+    int started;
+    /// Current depth of nesting
+    int32_t depth;
+    /// Number of tokens still to be read at each depth
+    int32_t remaining[BOLT_PACK_READER_MAX_DEPTH];
+    /// Non-zero at each depth that is a map, whose entries begin with a key
+    char is_map[BOLT_PACK_READER_MAX_DEPTH];
+};
+
+/**
+ * Read the next event from the current record.
+ *
+ * @param reader
+ * @return a `BoltPackEvent`, or -1 if the record is malformed
+ */
+PUBLIC int BoltPackReader_next(struct BoltPackReader* reader);
+
+/**
+ * Skip over the next value in the current record, including everything
+ * nested within it, without returning any events for it.
+ *
+ * @param reader
+ * @return 0 on success, -1 if there is no value to skip or the record is malformed
+ */
+PUBLIC int BoltPackReader_skip(struct BoltPackReader* reader);
+
+
+#endif // SEABOLT_PACKSTREAM
@@ -64,6 +64,8 @@ struct array_t;
 
 struct BoltValue;
 
+struct BoltSharedValue;
+
 enum BoltType
 {
     /// Containers
@@ -97,6 +99,17 @@ enum BoltType
     BOLT_FLOAT64,                       /* ALSO IN BOLT v1 (as Float) */
     BOLT_FLOAT64_ARRAY,
 
+    /// Spatial
+    BOLT_POINT,                         /* IN BOLT v2 (as Point2D or Point3D) */
+
+    /// Temporal
+    BOLT_DATE,                          /* IN BOLT v2 (as Date) */
+    BOLT_TIME,                          /* IN BOLT v2 (as Time) */
+    BOLT_LOCAL_TIME,                    /* IN BOLT v2 (as LocalTime) */
+    BOLT_DATE_TIME,                     /* IN BOLT v2 (as DateTime) */
+    BOLT_LOCAL_DATE_TIME,               /* IN BOLT v2 (as LocalDateTime) */
+    BOLT_DURATION,                      /* IN BOLT v2 (as Duration) */
+
     /// Structures
     BOLT_STRUCTURE,                     /* ALSO IN BOLT v1 (as Structure) */
     BOLT_STRUCTURE_ARRAY,
@@ -114,6 +127,7 @@ union data_t
     int16_t* as_int16;
     int32_t* as_int32;
     int64_t* as_int64;
+    uint64_t* as_uint64;
     double* as_double;
     struct BoltValue* as_value;
     struct array_t* as_array;
@@ -125,37 +139,99 @@ struct array_t
     union data_t data;
 };
 
-// A BoltValue consists of a 128-bit header followed by a 128-byte data block. For
-// values that require more space than 128 bits, external memory is allocated and
-// a pointer to this is held in the inline data field.
+// A BoltValue consists of a 64-bit header followed by a 64-bit data block. For
+// values that require more space than 64 bits, external memory is allocated and
+// a pointer to this is held in the inline data field. External memory is
+// preceded by a BoltExtent, which records its physical size.
 //
-// +----+----+----+----+----+----+----+----+----+----+----+----+----+----+----+----+
-// |  type   | subtype |  (logical) size   |         (physical) data size          |
-// |[16 bits]|[16 bits]|     [32 bits]     |               [64 bits]               |
-// +----+----+----+----+----+----+----+----+----+----+----+----+----+----+----+----+
-// |                      inline data or pointer to external data                  |
-// |                                  [128 bits]                                   |
-// +----+----+----+----+----+----+----+----+----+----+----+----+----+----+----+----+
+// +----+----+----+----+----+----+----+----+
+// |type|stor| subtype |  (logical) size   |
+// | [8]| [8]|  [16]   |     [32 bits]     |
+// +----+----+----+----+----+----+----+----+
+// |  inline data or pointer to external   |
+// |               [64 bits]               |
+// +----+----+----+----+----+----+----+----+
 //
 struct BoltValue
 {
-    int16_t type;
+    int8_t type;
+    int8_t storage;             // enum BoltStorage
     int16_t subtype;
     int32_t size;               // logical size
-    uint64_t data_size;         // physical size
     union
     {
-        char as_char[16];
-        uint32_t as_uint32[4];
-        int8_t as_int8[16];
-        int16_t as_int16[8];
-        int32_t as_int32[4];
-        int64_t as_int64[2];
-        double as_double[2];
+        char as_char[8];
+        uint32_t as_uint32[2];
+        int8_t as_int8[8];
+        int16_t as_int16[4];
+        int32_t as_int32[2];
+        int64_t as_int64[1];
+        uint64_t as_uint64[1];
+        double as_double[1];
         union data_t extended;
     } data;
 };
 
+/// Where the data of a value is held
+enum BoltStorage
+{
+    BOLT_STORAGE_INLINE,                /* within the value itself */
+    BOLT_STORAGE_EXTERNAL,              /* in external memory owned by the value */
+    BOLT_STORAGE_BORROWED,              /* in external memory owned by a shared value */
+    BOLT_STORAGE_VIEW,                  /* in memory owned elsewhere, such as a receive buffer */
+};
+
+/// Header of the external memory held by a value
+struct BoltExtent
+{
+    uint64_t data_size;                 // physical size, excluding this header
+    struct BoltSharedValue* owner;      // shared value that lends this memory, if any
+};
+
+/// Time of day with a fixed offset from UTC (stored externally)
+struct BoltTime
+{
+    int64_t nanoseconds;                // since midnight
+    int32_t tz_offset_seconds;
+};
+
+/// Date and time of day, without a time zone (stored externally)
+struct BoltLocalDateTime
+{
+    int64_t seconds;                    // since the epoch
+    int32_t nanoseconds;
+};
+
+/// Date and time of day with a fixed offset from UTC (stored externally)
+struct BoltDateTime
+{
+    int64_t seconds;                    // since the epoch, in local time
+    int32_t nanoseconds;
+    int32_t tz_offset_seconds;
+};
+
+/// Temporal amount (stored externally)
+struct BoltDuration
+{
+    int64_t months;
+    int64_t days;
+    int64_t seconds;
+    int32_t nanoseconds;
+};
+
+/**
+ * A reference-counted value that can be borrowed by several other values
+ * at once, such as an entity held by a decoding cache. Borrowing values
+ * point directly at the nested storage of the shared value and hold no
+ * physical data of their own. The shared value is destroyed once its last
+ * reference has been released.
+ */
+struct BoltSharedValue
+{
+    int32_t references;
+    struct BoltValue value;
+};
+
 
 /**
  * Clean up a value for reuse.
@@ -168,8 +244,28 @@ void _recycle(struct BoltValue* value);
 
 void _set_type(struct BoltValue* value, enum BoltType type, int16_t subtype, int32_t size);
 
+/**
+ * Obtain the physical size of the external data held by a value, or
+ * zero if the data is held inline or borrowed.
+ *
+ * @param value
+ * @return
+ */
+size_t _data_size(const struct BoltValue* value);
+
+/**
+ * Allocate, resize or release the external data of a value. Existing
+ * data is kept, up to the new size.
+ *
+ * @param value
+ * @param data_size new physical size, or zero to hold data inline
+ */
+void _adjust(struct BoltValue* value, size_t data_size);
+
 void _format(struct BoltValue* value, enum BoltType type, int16_t subtype, int32_t size, const void* data, size_t data_size);
 
+void _to_structure(struct BoltValue* value, enum BoltType type, int16_t code, int32_t size);
+
 
 /**
  * Resize a value that contains multiple sub-values.
@@ -180,6 +276,10 @@ void _format(struct BoltValue* value, enum BoltType type, int16_t subtype, int32
  */
 void _resize(struct BoltValue* value, int32_t size, int multiplier);
 
+void _reserve(struct BoltValue* value, int32_t capacity, int multiplier);
+
+int32_t _append(struct BoltValue* value, int multiplier);
+
 
 /**
  * Create a new BoltValue instance.
@@ -209,14 +309,46 @@ PUBLIC void BoltValue_to_Byte(struct BoltValue * value, char data);
 
 PUBLIC void BoltValue_to_BitArray(struct BoltValue * value, char * data, int32_t length);
 
+/**
+ * Set a value to an array of bits, packed 64 to a word with the first
+ * bit in the least significant position of the first word.
+ *
+ * @param value
+ * @param words packed bits, or NULL for all zero
+ * @param length number of bits
+ */
+PUBLIC void BoltValue_to_PackedBitArray(struct BoltValue * value, const uint64_t * words, int32_t length);
+
 PUBLIC void BoltValue_to_ByteArray(struct BoltValue * value, char * data, int32_t length);
 
+/**
+ * Set a value to a view of an array of bytes held elsewhere. The data is
+ * not copied, so must outlive the value or be materialised first. Short
+ * arrays that fit inline are copied regardless.
+ *
+ * @param value
+ * @param data
+ * @param length
+ */
+PUBLIC void BoltValue_to_ByteArrayView(struct BoltValue * value, const char * data, int32_t length);
+
 PUBLIC void BoltValue_to_Char(struct BoltValue * value, uint32_t data);
 
 PUBLIC void BoltValue_to_CharArray(struct BoltValue * value, const uint32_t * data, int32_t length);
 
 PUBLIC void BoltValue_to_String(struct BoltValue * value, const char * data, int32_t length);
 
+/**
+ * Set a value to a view of a UTF-8 string held elsewhere. The data is
+ * not copied, so must outlive the value or be materialised first. Short
+ * strings that fit inline are copied regardless.
+ *
+ * @param value
+ * @param data
+ * @param length
+ */
+PUBLIC void BoltValue_to_StringView(struct BoltValue * value, const char * data, int32_t length);
+
 PUBLIC void BoltValue_to_StringArray(struct BoltValue * value, int32_t length);
 
 PUBLIC void BoltValue_to_Dictionary(struct BoltValue * value, int32_t length);
@@ -249,6 +381,48 @@ PUBLIC void BoltValue_to_Message(struct BoltValue * value, int16_t code, int32_t
 
 PUBLIC enum BoltType BoltValue_type(const struct BoltValue * value);
 
+/**
+ * Create a new shared value, holding a single reference.
+ *
+ * @return
+ */
+PUBLIC struct BoltSharedValue* BoltSharedValue_create();
+
+/**
+ * Release one reference to a shared value, destroying it if no
+ * references remain.
+ *
+ * @param shared
+ */
+PUBLIC void BoltSharedValue_release(struct BoltSharedValue* shared);
+
+/**
+ * Turn a BoltValue into a read-only view of a shared container value
+ * (a list, dictionary or structure), taking a reference to it.
+ *
+ * @param value
+ * @param shared
+ */
+PUBLIC void BoltValue_borrow(struct BoltValue* value, struct BoltSharedValue* shared);
+
+/**
+ * Copy a BoltValue, including any nested values, into another instance.
+ * The copy always owns its data, even if the source borrows from a shared
+ * value.
+ *
+ * @param dest
+ * @param src
+ */
+PUBLIC void BoltValue_copy(struct BoltValue* dest, const struct BoltValue* src);
+
+/**
+ * Replace any string and byte array views within a value, including
+ * those in nested values, with copies owned by the value itself.
+ *
+ * @param value
+ */
+PUBLIC void BoltValue_materialize(struct BoltValue* value);
+
 /**
  * Destroy a BoltValue instance.
  *
@@ -265,6 +439,25 @@ PUBLIC int BoltNull_write(const struct BoltValue * value, FILE * file);
 
 PUBLIC void BoltList_resize(struct BoltValue* value, int32_t size);
 
+/**
+ * Reserve space for at least `capacity` items in a list, so that it can
+ * later be grown to that size without reallocation. The size of the
+ * list is unchanged.
+ *
+ * @param value
+ * @param capacity
+ */
+PUBLIC void BoltList_reserve(struct BoltValue* value, int32_t capacity);
+
+/**
+ * Add a null item to the end of a list, growing its capacity
+ * geometrically where required.
+ *
+ * @param value
+ * @return the new item
+ */
+PUBLIC struct BoltValue* BoltList_append(struct BoltValue* value);
+
 PUBLIC struct BoltValue* BoltList_value(const struct BoltValue* value, int32_t index);
 
 PUBLIC int BoltList_write(const struct BoltValue * value, FILE * file, int32_t protocol_version);
@@ -276,6 +469,26 @@ PUBLIC char BoltByte_get(const struct BoltValue* value);
 
 PUBLIC char BoltBitArray_get(const struct BoltValue* value, int32_t index);
 
+PUBLIC void BoltBitArray_set(struct BoltValue* value, int32_t index, char data);
+
+/**
+ * Obtain the packed words of a bit array, as described for
+ * `BoltValue_to_PackedBitArray`. Bits beyond the size of the array are
+ * zero, and must be kept so if the words are modified.
+ *
+ * @param value
+ * @return pointer to the first of `(size + 63) / 64` words
+ */
+PUBLIC uint64_t* BoltBitArray_get_all(struct BoltValue* value);
+
+/**
+ * Count the bits set in a bit array.
+ *
+ * @param value
+ * @return
+ */
+PUBLIC int32_t BoltBitArray_count(const struct BoltValue* value);
+
 PUBLIC char BoltByteArray_get(const struct BoltValue* value, int32_t index);
 
 PUBLIC char* BoltByteArray_get_all(struct BoltValue* value);
@@ -323,6 +536,17 @@ PUBLIC int BoltDictionary_set_key(struct BoltValue * value, int32_t index, const
 
 PUBLIC struct BoltValue* BoltDictionary_value(struct BoltValue * value, int32_t index);
 
+/**
+ * Add an entry with the given key and a null value to the end of a
+ * dictionary, growing its capacity geometrically where required.
+ *
+ * @param value
+ * @param key
+ * @param key_size
+ * @return the value of the new entry, or NULL if the key is too long
+ */
+PUBLIC struct BoltValue* BoltDictionary_append(struct BoltValue * value, const char * key, size_t key_size);
+
 PUBLIC int BoltDictionary_write(struct BoltValue * value, FILE * file, int32_t protocol_version);
 
 
@@ -341,6 +565,8 @@ PUBLIC int16_t BoltInt16Array_get(const struct BoltValue* value, int32_t index);
 
 PUBLIC int32_t BoltInt32Array_get(const struct BoltValue* value, int32_t index);
 
+PUBLIC int32_t* BoltInt32Array_get_all(struct BoltValue* value);
+
 PUBLIC int64_t BoltInt64Array_get(const struct BoltValue* value, int32_t index);
 
 PUBLIC int BoltInt8_write(struct BoltValue * value, FILE * file);
@@ -368,6 +594,73 @@ PUBLIC int BoltFloat64_write(struct BoltValue * value, FILE * file);
 PUBLIC int BoltFloat64Array_write(struct BoltValue * value, FILE * file);
 
 
+/**
+ * Set a BoltValue to a point in a coordinate reference system. The
+ * coordinates are held externally and are contiguous.
+ *
+ * @param value
+ * @param srid coordinate reference system identifier
+ * @param coordinates
+ * @param dimensions number of coordinates (2 or 3)
+ */
+PUBLIC void BoltValue_to_Point(struct BoltValue * value, int16_t srid, const double * coordinates, int32_t dimensions);
+
+PUBLIC int16_t BoltPoint_srid(const struct BoltValue * value);
+
+PUBLIC const double * BoltPoint_coordinates(const struct BoltValue * value);
+
+PUBLIC int BoltPoint_write(const struct BoltValue * value, FILE * file);
+
+
+PUBLIC void BoltValue_to_Date(struct BoltValue * value, int64_t days);
+
+PUBLIC void BoltValue_to_Time(struct BoltValue * value, int64_t nanoseconds, int32_t tz_offset_seconds);
+
+PUBLIC void BoltValue_to_LocalTime(struct BoltValue * value, int64_t nanoseconds);
+
+PUBLIC void BoltValue_to_DateTime(struct BoltValue * value, int64_t seconds, int32_t nanoseconds, int32_t tz_offset_seconds);
+
+PUBLIC void BoltValue_to_LocalDateTime(struct BoltValue * value, int64_t seconds, int32_t nanoseconds);
+
+PUBLIC void BoltValue_to_Duration(struct BoltValue * value, int64_t months, int64_t days, int64_t seconds, int32_t nanoseconds);
+
+/**
+ * Obtain the number of days since the epoch.
+ *
+ * @param value
+ * @return
+ */
+PUBLIC int64_t BoltDate_get(const struct BoltValue * value);
+
+PUBLIC struct BoltTime BoltTime_get(const struct BoltValue * value);
+
+/**
+ * Obtain the number of nanoseconds since midnight.
+ *
+ * @param value
+ * @return
+ */
+PUBLIC int64_t BoltLocalTime_get(const struct BoltValue * value);
+
+PUBLIC struct BoltDateTime BoltDateTime_get(const struct BoltValue * value);
+
+PUBLIC struct BoltLocalDateTime BoltLocalDateTime_get(const struct BoltValue * value);
+
+PUBLIC struct BoltDuration BoltDuration_get(const struct BoltValue * value);
+
+PUBLIC int BoltDate_write(const struct BoltValue * value, FILE * file);
+
+PUBLIC int BoltTime_write(const struct BoltValue * value, FILE * file);
+
+PUBLIC int BoltLocalTime_write(const struct BoltValue * value, FILE * file);
+
+PUBLIC int BoltDateTime_write(const struct BoltValue * value, FILE * file);
+
+PUBLIC int BoltLocalDateTime_write(const struct BoltValue * value, FILE * file);
+
+PUBLIC int BoltDuration_write(const struct BoltValue * value, FILE * file);
+
+
 PUBLIC int16_t BoltStructure_code(const struct BoltValue* value);
 
 PUBLIC int16_t BoltMessage_code(const struct BoltValue * value);
@@ -382,6 +675,52 @@ PUBLIC void BoltStructureArray_set_size(struct BoltValue* value, int32_t index,
 
 PUBLIC struct BoltValue* BoltStructureArray_at(const struct BoltValue* value, int32_t array_index, int32_t structure_index);
 
+/**
+ * Obtain the length of a path, i.e. its number of relationships.
+ *
+ * Paths are received in a compact form: a `BOLT_STRUCTURE` with code 'P'
+ * holding a list of distinct nodes, a list of distinct unbound
+ * relationships and a `BOLT_INT32_ARRAY` sequence of indexes into these.
+ * The functions below resolve that sequence.
+ *
+ * @param value
+ * @return
+ */
+PUBLIC int32_t BoltPath_size(const struct BoltValue* value);
+
+/**
+ * Obtain a node along a path.
+ *
+ * @param value
+ * @param index position of the node along the path (0 to size inclusive)
+ * @return
+ */
+PUBLIC struct BoltValue* BoltPath_node(const struct BoltValue* value, int32_t index);
+
+/**
+ * Obtain an (unbound) relationship along a path.
+ *
+ * @param value
+ * @param index position of the relationship along the path (0 to size - 1)
+ * @return
+ */
+PUBLIC struct BoltValue* BoltPath_relationship(const struct BoltValue* value, int32_t index);
+
+/**
+ * Obtain one segment of a path: a relationship along with the nodes
+ * either side of it, in path order.
+ *
+ * @param value
+ * @param index position of the segment along the path (0 to size - 1)
+ * @param start pointer to receive the node before the relationship
+ * @param relationship pointer to receive the relationship
+ * @param end pointer to receive the node after the relationship
+ * @return 1 if the relationship points from start to end,
+ *         -1 if it points from end to start
+ */
+PUBLIC int BoltPath_segment(const struct BoltValue* value, int32_t index, struct BoltValue** start,
+                            struct BoltValue** relationship, struct BoltValue** end);
+
 PUBLIC int BoltStructure_write(struct BoltValue * value, FILE * file, int32_t protocol_version);
 
 PUBLIC int BoltStructureArray_write(struct BoltValue * value, FILE * file, int32_t protocol_version);
@@ -21,6 +21,7 @@
 #include <stdint.h>
 #include <bolt/connect.h>
 #include "protocol/v1.h"
+#include "protocol/responses.h"
 #include "bolt/buffering.h"
 #include <bolt/values.h>
 #include "bolt/logging.h"
@@ -112,6 +113,7 @@ struct BoltConnection* create(enum BoltTransport transport)
     connection->ssl = NULL;
 
     connection->protocol_version = 0;
+    connection->protocol = NULL;
     connection->protocol_state = NULL;
 
     connection->tx_buffer = BoltBuffer_create(INITIAL_TX_BUFFER_SIZE);
@@ -250,13 +252,9 @@ void close_b(struct BoltConnection * connection)
 
 void destroy(struct BoltConnection * connection)
 {
-    switch(connection->protocol_version)
+    if (connection->protocol != NULL)
     {
-        case 1:
-            BoltProtocolV1_destroy_state(connection->protocol_state);
-            break;
-        default:
-            break;
+        connection->protocol->destroy_state(connection->protocol_state);
     }
     BoltBuffer_destroy(connection->rx_buffer);
     BoltBuffer_destroy(connection->tx_buffer);
@@ -281,12 +279,12 @@ int send_b(struct BoltConnection * connection, const char * data, int size)
         {
             case BOLT_INSECURE_SOCKET:
             {
-                sent = TRANSMIT(connection->socket, data, size, 0);
+                sent = TRANSMIT(connection->socket, data + total_sent, remaining, 0);
                 break;
             }
             case BOLT_SECURE_SOCKET:
             {
-                sent = TRANSMIT_S(connection->ssl, data, size, 0);
+                sent = TRANSMIT_S(connection->ssl, data + total_sent, remaining, 0);
                 break;
             }
         }
@@ -401,7 +399,11 @@ int handshake_b(struct BoltConnection * connection, int32_t _1, int32_t _2, int3
     switch(connection->protocol_version)
     {
         case 1:
-            connection->protocol_state = BoltProtocolV1_create_state();
+        case 2:
+        case 3:
+        case 4:
+            connection->protocol = &BOLT_PROTOCOL_V1;
+            connection->protocol_state = connection->protocol->create_state(connection->protocol_version);
             return 0;
         default:close_b(connection);
             set_status(connection, BOLT_DEFUNCT, BOLT_UNSUPPORTED);
@@ -421,12 +423,12 @@ struct BoltConnection* BoltConnection_open_b(enum BoltTransport transport, struc
                 int secured = secure_b(connection);
                 if (secured == 0)
                 {
-                    handshake_b(connection, 1, 0, 0, 0);
+                    handshake_b(connection, 4, 3, 2, 1);
                 }
             }
             else
             {
-                handshake_b(connection, 1, 0, 0, 0);
+                handshake_b(connection, 4, 3, 2, 1);
             }
             set_status(connection, BOLT_CONNECTED, BOLT_NO_ERROR);
             break;
@@ -443,6 +445,10 @@ void BoltConnection_close_b(struct BoltConnection* connection)
 {
     if (connection->status != BOLT_DISCONNECTED)
     {
+        if (connection->status != BOLT_DEFUNCT && connection->protocol_version >= 3 && connection->protocol != NULL)
+        {
+            connection->protocol->goodbye_b(connection);
+        }
         close_b(connection);
     }
     destroy(connection);
@@ -456,9 +462,8 @@ int BoltConnection_send_b(struct BoltConnection * connection)
     return 0;
 }
 
-int BoltConnection_receive_b(struct BoltConnection * connection, char * buffer, int size)
+int BoltConnection_buffer_b(struct BoltConnection * connection, int size)
 {
-    if (size == 0) return 0;
     int available = BoltBuffer_unloadable(connection->rx_buffer);
     if (size > available)
     {
@@ -483,312 +488,422 @@ int BoltConnection_receive_b(struct BoltConnection * connection, char * buffer,
             delta -= received;
         }
     }
+    return 0;
+}
+
+int BoltConnection_receive_b(struct BoltConnection * connection, char * buffer, int size)
+{
+    if (size == 0) return 0;
+    try(BoltConnection_buffer_b(connection, size));
     BoltBuffer_unload(connection->rx_buffer, buffer, size);
     return size;
 }
 
-int BoltConnection_fetch_b(struct BoltConnection * connection, bolt_request_t request)
+/**
+ * Update the connection status from the summary held in the v1 state.
+ *
+ * @param connection
+ * @return 0 on success, -1 on protocol violation
+ */
+int handle_summary(struct BoltConnection * connection)
 {
-    switch (connection->protocol_version)
+    int16_t code = BoltMessage_code(connection->protocol->data(connection));
+    switch (code)
     {
-        case 1:
-        {
-            int fetched = BoltProtocolV1_fetch_b(connection, request);
-            if (fetched == 0)
-            {
-                // Summary received
-                struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
-                int16_t code = BoltMessage_code(state->data);
-                switch (code)
-                {
-                    case BOLT_V1_SUCCESS:
-                        set_status(connection, BOLT_READY, BOLT_NO_ERROR);
-                        return 0;
-                    case BOLT_V1_IGNORED:
-                        // Leave status as-is
-                        return 0;
-                    case BOLT_V1_FAILURE:
-                        set_status(connection, BOLT_FAILED, BOLT_UNKNOWN_ERROR);   // TODO more specific error
-                        return 0;
-                    default:
-                        BoltLog_error("bolt: Protocol violation (received summary code %d)", code);
-                        set_status(connection, BOLT_DEFUNCT, BOLT_PROTOCOL_VIOLATION);
-                        return -1;
-                }
-            }
-            return 1;
-        }
+        case BOLT_V1_SUCCESS:
+            set_status(connection, BOLT_READY, BOLT_NO_ERROR);
+            return 0;
+        case BOLT_V1_IGNORED:
+            // Leave status as-is
+            return 0;
+        case BOLT_V1_FAILURE:
+            set_status(connection, BOLT_FAILED, BOLT_UNKNOWN_ERROR);   // TODO more specific error
+            return 0;
         default:
-        {
-            // TODO
+            BoltLog_error("bolt: Protocol violation (received summary code %d)", code);
+            set_status(connection, BOLT_DEFUNCT, BOLT_PROTOCOL_VIOLATION);
             return -1;
-        }
     }
 }
 
+int BoltConnection_fetch_b(struct BoltConnection * connection, bolt_request_t request)
+{
+    if (connection->protocol == NULL)
+    {
+        return -1;
+    }
+    int fetched = connection->protocol->fetch_b(connection, request);
+    if (fetched == 0)
+    {
+        // Summary received
+        return handle_summary(connection);
+    }
+    return fetched;
+}
+
+int BoltConnection_fetch_reader_b(struct BoltConnection * connection, bolt_request_t request,
+                                  struct BoltPackReader * reader)
+{
+    if (connection->protocol == NULL)
+    {
+        return -1;
+    }
+    int fetched = connection->protocol->fetch_reader_b(connection, request, reader);
+    if (fetched == 0)
+    {
+        // Summary received
+        return handle_summary(connection);
+    }
+    return fetched;
+}
+
 int BoltConnection_fetch_summary_b(struct BoltConnection * connection, bolt_request_t request)
 {
-    int records = 0;
-    int data;
-    do
+    if (connection->protocol == NULL)
     {
-        data = BoltConnection_fetch_b(connection, request);
-        if (data < 0)
-        {
-            return data;
-        }
-        records += data;
+        return -1;
+    }
+    int records = connection->protocol->fetch_summary_b(connection, request);
+    if (records >= 0)
+    {
+        try(handle_summary(connection));
     }
-    while (data);
     return records;
 }
 
-struct BoltValue* BoltConnection_data(struct BoltConnection * connection)
+int BoltConnection_fetch_batch_b(struct BoltConnection * connection, bolt_request_t request, int32_t max_records,
+                                 struct BoltValue * records)
 {
-    switch (connection->protocol_version)
+    if (connection->protocol == NULL)
     {
-        case 1:
-        {
-            struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
-            return state->data;
-        }
-        default:
-            return NULL;
+        return -1;
     }
+    int fetched = connection->protocol->fetch_batch_b(connection, request, max_records, records);
+    if (fetched == 0)
+    {
+        // Summary received
+        return handle_summary(connection);
+    }
+    return fetched;
+}
+
+struct BoltValue* BoltConnection_data(struct BoltConnection * connection)
+{
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? NULL : protocol->data(connection);
+}
+
+const struct BoltSummary * BoltConnection_summary(struct BoltConnection * connection)
+{
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? NULL : protocol->summary(connection);
 }
 
 int BoltConnection_init_b(struct BoltConnection* connection, const char* user_agent,
                           const char* user, const char* password)
 {
     BoltLog_info("bolt: Initialising connection for user '%s'", user);
-    switch (connection->protocol_version)
+    if (connection->protocol == NULL)
     {
-        case 1:
-        {
-            int code = BoltProtocolV1_init_b(connection, user_agent, user, password);
-            switch (code)
-            {
-                case BOLT_V1_SUCCESS:
-                    set_status(connection, BOLT_READY, BOLT_NO_ERROR);
-                    return 0;
-                case BOLT_V1_FAILURE:
-                    set_status(connection, BOLT_DEFUNCT, BOLT_PERMISSION_DENIED);
-                    return -1;
-                default:
-                    BoltLog_error("bolt: Protocol violation (received summary code %d)", code);
-                    set_status(connection, BOLT_DEFUNCT, BOLT_PROTOCOL_VIOLATION);
-                    return -1;
-            }
-        }
+        set_status(connection, BOLT_DEFUNCT, BOLT_UNSUPPORTED);
+        return -1;
+    }
+    int code = connection->protocol->init_b(connection, user_agent, user, password);
+    switch (code)
+    {
+        case BOLT_V1_SUCCESS:
+            set_status(connection, BOLT_READY, BOLT_NO_ERROR);
+            return 0;
+        case BOLT_V1_FAILURE:
+            set_status(connection, BOLT_DEFUNCT, BOLT_PERMISSION_DENIED);
+            return -1;
         default:
-            set_status(connection, BOLT_DEFUNCT, BOLT_UNSUPPORTED);
+            BoltLog_error("bolt: Protocol violation (received summary code %d)", code);
+            set_status(connection, BOLT_DEFUNCT, BOLT_PROTOCOL_VIOLATION);
             return -1;
     }
 }
 
 int BoltConnection_set_cypher_template(struct BoltConnection * connection, const char * statement, size_t size)
 {
-    switch (connection->protocol_version)
-    {
-        case 1:
-            return BoltProtocolV1_set_cypher_template(connection, statement, size);
-        default:
-            return -1;
-    }
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? -1 : protocol->set_cypher_template(connection, statement, size);
 }
 
 int BoltConnection_set_n_cypher_parameters(struct BoltConnection * connection, int32_t size)
 {
-    switch (connection->protocol_version)
-    {
-        case 1:
-            return BoltProtocolV1_set_n_cypher_parameters(connection, size);
-        default:
-            return -1;
-    }
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? -1 : protocol->set_n_cypher_parameters(connection, size);
 }
 
 int BoltConnection_set_cypher_parameter_key(struct BoltConnection * connection, int32_t index, const char * key,
                                             size_t key_size)
 {
-    switch (connection->protocol_version)
-    {
-        case 1:
-            return BoltProtocolV1_set_cypher_parameter_key(connection, index, key, key_size);
-        default:
-            return -1;
-    }
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? -1 : protocol->set_cypher_parameter_key(connection, index, key, key_size);
 }
 
 struct BoltValue * BoltConnection_cypher_parameter_value(struct BoltConnection * connection, int32_t index)
 {
-    switch (connection->protocol_version)
-    {
-        case 1:
-            return BoltProtocolV1_cypher_parameter_value(connection, index);
-        default:
-            return NULL;
-    }
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? NULL : protocol->cypher_parameter_value(connection, index);
+}
+
+int BoltConnection_set_entity_cache(struct BoltConnection * connection, int enabled)
+{
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? -1 : protocol->set_entity_cache(connection, enabled);
+}
+
+int BoltConnection_set_string_views(struct BoltConnection * connection, int enabled)
+{
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? -1 : protocol->set_string_views(connection, enabled);
+}
+
+int BoltConnection_project(struct BoltConnection * connection, int32_t field, const char * path, size_t path_size)
+{
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? -1 : protocol->project(connection, field, path, path_size);
+}
+
+int BoltConnection_clear_projection(struct BoltConnection * connection)
+{
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? -1 : protocol->clear_projection(connection);
+}
+
+int BoltConnection_set_fetch_size(struct BoltConnection * connection, int32_t size)
+{
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? -1 : protocol->set_fetch_size(connection, size);
+}
+
+int BoltConnection_set_response_buffer(struct BoltConnection * connection, size_t max_size,
+                                       enum BoltResponseOverflow overflow)
+{
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? -1 : protocol->set_response_buffer(connection, max_size, overflow);
+}
+
+struct BoltResponseBuffer * response_buffer(struct BoltConnection * connection)
+{
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? NULL : protocol->response_buffer(connection);
+}
+
+size_t BoltConnection_buffered_response_size(struct BoltConnection * connection)
+{
+    struct BoltResponseBuffer * responses = response_buffer(connection);
+    return responses == NULL ? 0 : responses->buffered_size;
+}
+
+size_t BoltConnection_peak_buffered_response_size(struct BoltConnection * connection)
+{
+    struct BoltResponseBuffer * responses = response_buffer(connection);
+    return responses == NULL ? 0 : responses->peak_buffered_size;
+}
+
+size_t BoltConnection_spilled_response_size(struct BoltConnection * connection)
+{
+    struct BoltResponseBuffer * responses = response_buffer(connection);
+    return responses == NULL ? 0 : responses->spilled_size;
 }
 
 int BoltConnection_load_bookmark(struct BoltConnection * connection, const char * bookmark)
 {
-    switch (connection->protocol_version)
-    {
-        case 1:
-            return BoltProtocolV1_load_bookmark(connection, bookmark);
-        default:
-            return -1;
-    }
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? -1 : protocol->load_bookmark(connection, bookmark);
 }
 
 int BoltConnection_load_begin_request(struct BoltConnection * connection)
 {
-    switch (connection->protocol_version)
-    {
-        case 1:
-            return BoltProtocolV1_load_begin_request(connection);
-        default:
-            return -1;
-    }
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? -1 : protocol->load_begin_request(connection);
 }
 
 int BoltConnection_load_commit_request(struct BoltConnection * connection)
 {
-    switch (connection->protocol_version)
-    {
-        case 1:
-            return BoltProtocolV1_load_commit_request(connection);
-        default:
-            return -1;
-    }
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? -1 : protocol->load_commit_request(connection);
 }
 
 int BoltConnection_load_rollback_request(struct BoltConnection * connection)
 {
-    switch (connection->protocol_version)
-    {
-        case 1:
-            return BoltProtocolV1_load_rollback_request(connection);
-        default:
-            return -1;
-    }
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? -1 : protocol->load_rollback_request(connection);
 }
 
 int BoltConnection_load_run_request(struct BoltConnection * connection)
 {
-    switch (connection->protocol_version)
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? -1 : protocol->load_run_request(connection);
+}
+
+int BoltConnection_open_run_stream_b(struct BoltConnection * connection, const char * key, size_t key_size,
+                                     int32_t size)
+{
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? -1 : protocol->open_run_stream_b(connection, key, key_size, size);
+}
+
+int BoltConnection_load_stream_value_b(struct BoltConnection * connection, struct BoltValue * value)
+{
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? -1 : protocol->load_stream_value_b(connection, value);
+}
+
+int BoltConnection_close_run_stream_b(struct BoltConnection * connection)
+{
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? -1 : protocol->close_run_stream_b(connection);
+}
+
+struct BoltPackWriter * BoltConnection_open_run_writer(struct BoltConnection * connection, int32_t size)
+{
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? NULL : protocol->open_run_writer(connection, size);
+}
+
+int BoltConnection_close_run_writer(struct BoltConnection * connection)
+{
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? -1 : protocol->close_run_writer(connection);
+}
+
+int BoltConnection_load_run_batch_b(struct BoltConnection * connection, const char * key, size_t key_size,
+                                    struct BoltColumnBatch * batch, int32_t n_rows)
+{
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? -1 : protocol->load_run_batch_b(connection, key, key_size, batch, n_rows);
+}
+
+struct BoltColumnBatch * BoltColumnBatch_create(int32_t n_columns)
+{
+    struct BoltColumnBatch * batch = BoltMem_allocate(sizeof(struct BoltColumnBatch));
+    batch->n_columns = n_columns;
+    batch->columns = BoltMem_allocate(sizeof_n(struct BoltColumn, n_columns));
+    memset(batch->columns, 0, sizeof_n(struct BoltColumn, n_columns));
+    return batch;
+}
+
+void BoltColumnBatch_destroy(struct BoltColumnBatch * batch)
+{
+    BoltMem_deallocate(batch->columns, sizeof_n(struct BoltColumn, batch->n_columns));
+    BoltMem_deallocate(batch, sizeof(struct BoltColumnBatch));
+}
+
+int set_column(struct BoltColumnBatch * batch, int32_t index, const char * name, size_t name_size,
+               enum BoltColumnType type, const void * values, const int32_t * sizes, const uint8_t * nulls)
+{
+    if (index < 0 || index >= batch->n_columns || name_size > INT32_MAX)
     {
-        case 1:
-            return BoltProtocolV1_load_run_request(connection);
-        default:
-            return -1;
+        return -1;
     }
+    struct BoltColumn * column = &batch->columns[index];
+    column->name = name;
+    column->name_size = (int32_t)(name_size);
+    column->type = type;
+    column->values = values;
+    column->sizes = sizes;
+    column->nulls = nulls;
+    return 0;
 }
 
-int BoltConnection_load_discard_request(struct BoltConnection * connection, int32_t n)
+int BoltColumnBatch_set_int64_column(struct BoltColumnBatch * batch, int32_t index, const char * name,
+                                     size_t name_size, const int64_t * values, const uint8_t * nulls)
+{
+    return set_column(batch, index, name, name_size, BOLT_INT64_COLUMN, values, NULL, nulls);
+}
+
+int BoltColumnBatch_set_float64_column(struct BoltColumnBatch * batch, int32_t index, const char * name,
+                                       size_t name_size, const double * values, const uint8_t * nulls)
+{
+    return set_column(batch, index, name, name_size, BOLT_FLOAT64_COLUMN, values, NULL, nulls);
+}
+
+int BoltColumnBatch_set_string_column(struct BoltColumnBatch * batch, int32_t index, const char * name,
+                                      size_t name_size, const char * const * values, const int32_t * sizes,
+                                      const uint8_t * nulls)
+{
+    return set_column(batch, index, name, name_size, BOLT_STRING_COLUMN, values, sizes, nulls);
+}
+
+struct BoltPreparedRequest * BoltConnection_prepare_run_request(struct BoltConnection * connection)
+{
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? NULL : protocol->prepare_run_request(connection);
+}
+
+int BoltConnection_load_prepared_run_request(struct BoltConnection * connection,
+                                             struct BoltPreparedRequest * prepared)
 {
-    switch (connection->protocol_version)
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? -1 : protocol->load_prepared_run_request(connection, prepared);
+}
+
+struct BoltValue * BoltPreparedRequest_parameter_value(struct BoltPreparedRequest * prepared, int32_t index)
+{
+    if (index < 0 || index >= prepared->n_slots)
     {
-        case 1:
-            if (n >= 0)
-            {
-                return -1;
-            }
-            else
-            {
-                struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
-                BoltProtocolV1_load_message(connection, state->discard_request);
-                return 0;
-            }
-        default:
-            return -1;
+        return NULL;
     }
+    return BoltDictionary_value(BoltMessage_value(prepared->request, 1), index);
+}
+
+void BoltPreparedRequest_destroy(struct BoltPreparedRequest * prepared)
+{
+    if (prepared == NULL) return;
+    BoltValue_destroy(prepared->request);
+    BoltBuffer_destroy(prepared->encoded);
+    BoltMem_deallocate(prepared->slots, (size_t)(prepared->n_slots) * sizeof(int32_t));
+    BoltMem_deallocate(prepared, sizeof(struct BoltPreparedRequest));
+}
+
+int BoltConnection_load_discard_request(struct BoltConnection * connection, int32_t n)
+{
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? -1 : protocol->load_discard_request(connection, n);
 }
 
 int BoltConnection_load_pull_request(struct BoltConnection * connection, int32_t n)
 {
-    switch (connection->protocol_version)
-    {
-        case 1:
-            return BoltProtocolV1_load_pull_request(connection, n);
-        default:
-            return -1;
-    }
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? -1 : protocol->load_pull_request(connection, n);
 }
 
 bolt_request_t BoltConnection_last_request(struct BoltConnection * connection)
 {
-    switch (connection->protocol_version)
-    {
-        case 1:
-        {
-            struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
-            if (state == NULL)
-            {
-                return 0;
-            }
-            return state->next_request_id - 1;
-        }
-        default:
-        {
-            // TODO
-            return 0;
-        }
-    }
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? 0 : protocol->last_request(connection);
 }
 
 int32_t BoltConnection_n_fields(struct BoltConnection * connection)
 {
-    switch (connection->protocol_version)
-    {
-        case 1:
-            return BoltProtocolV1_n_fields(connection);
-        default:
-            return -1;
-    }
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? -1 : protocol->n_fields(connection);
 }
 
 const char * BoltConnection_field_name(struct BoltConnection * connection, int32_t index)
 {
-    switch (connection->protocol_version)
-    {
-        case 1:
-            return BoltProtocolV1_field_name(connection, index);
-        default:
-            return NULL;
-    }
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? NULL : protocol->field_name(connection, index);
 }
 
 int32_t BoltConnection_field_name_size(struct BoltConnection * connection, int32_t index)
 {
-    switch (connection->protocol_version)
-    {
-        case 1:
-            return BoltProtocolV1_field_name_size(connection, index);
-        default:
-            return -1;
-    }
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? -1 : protocol->field_name_size(connection, index);
 }
 
 int BoltConnection_dump_field_names(struct BoltConnection * connection, struct BoltBuffer * buffer)
 {
-    switch (connection->protocol_version)
-    {
-        case 1:
-            return BoltProtocolV1_dump(BoltProtocolV1_state(connection)->fields, buffer);
-        default:
-            return -1;
-    }
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? -1 : protocol->dump(protocol->field_names(connection), buffer);
 }
 
 int BoltConnection_dump_data(struct BoltConnection * connection, struct BoltBuffer * buffer)
 {
-    switch (connection->protocol_version)
-    {
-        case 1:
-            return BoltProtocolV1_dump(BoltProtocolV1_state(connection)->data, buffer);
-        default:
-            return -1;
-    }
+    const struct BoltProtocol * protocol = connection->protocol;
+    return protocol == NULL ? -1 : protocol->dump(protocol->data(connection), buffer);
 }
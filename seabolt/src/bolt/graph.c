@@ -0,0 +1,639 @@
+/*
+ * Copyright (c) 2002-2017 "Neo Technology,"
+ * Network Engine for Objects in Lund AB [http://neotechnology.com]
+ *
+ * This file is part of Neo4j.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <assert.h>
+#include <memory.h>
+
+#include "bolt/connect.h"
+#include "bolt/graph.h"
+#include "bolt/mem.h"
+
+#define INITIAL_MAP_CAPACITY 64
+
+
+struct _graph_id_slot
+{
+    int64_t id;
+    int32_t index;
+};
+
+/**
+ * Open-addressing hash table mapping server-side IDs to dense indexes.
+ * Free slots hold an index of -1.
+ */
+struct _graph_id_map
+{
+    int32_t capacity;
+    int32_t size;
+    struct _graph_id_slot* slots;
+};
+
+
+struct _graph_id_map* _graph_id_map_create()
+{
+    struct _graph_id_map* map = BoltMem_allocate(sizeof(struct _graph_id_map));
+    map->capacity = INITIAL_MAP_CAPACITY;
+    map->size = 0;
+    map->slots = BoltMem_allocate(sizeof_n(struct _graph_id_slot, map->capacity));
+    memset(map->slots, 0xFF, sizeof_n(struct _graph_id_slot, map->capacity));
+    return map;
+}
+
+void _graph_id_map_destroy(struct _graph_id_map* map)
+{
+    BoltMem_deallocate(map->slots, sizeof_n(struct _graph_id_slot, map->capacity));
+    BoltMem_deallocate(map, sizeof(struct _graph_id_map));
+}
+
+struct _graph_id_slot* _graph_id_map_find(const struct _graph_id_map* map, int64_t id)
+{
+    size_t mask = (size_t)(map->capacity - 1);
+    uint64_t hash = (uint64_t)(id) * 0x9E3779B97F4A7C15ULL;
+    for (size_t i = (size_t)(hash >> 32) & mask; ; i = (i + 1) & mask)
+    {
+        struct _graph_id_slot* slot = &map->slots[i];
+        if (slot->index == -1 || slot->id == id)
+        {
+            return slot;
+        }
+    }
+}
+
+void _graph_id_map_put(struct _graph_id_map* map, int64_t id, int32_t index)
+{
+    if (2 * (map->size + 1) > map->capacity)
+    {
+        int32_t old_capacity = map->capacity;
+        struct _graph_id_slot* old_slots = map->slots;
+        map->capacity = 2 * old_capacity;
+        map->slots = BoltMem_allocate(sizeof_n(struct _graph_id_slot, map->capacity));
+        memset(map->slots, 0xFF, sizeof_n(struct _graph_id_slot, map->capacity));
+        for (int32_t i = 0; i < old_capacity; i++)
+        {
+            if (old_slots[i].index != -1)
+            {
+                *_graph_id_map_find(map, old_slots[i].id) = old_slots[i];
+            }
+        }
+        BoltMem_deallocate(old_slots, sizeof_n(struct _graph_id_slot, old_capacity));
+    }
+    struct _graph_id_slot* slot = _graph_id_map_find(map, id);
+    assert(slot->index == -1);
+    slot->id = id;
+    slot->index = index;
+    map->size += 1;
+}
+
+int32_t _graph_grow_capacity(int32_t capacity, int32_t size)
+{
+    int32_t new_capacity = capacity == 0 ? 16 : capacity;
+    while (new_capacity < size)
+    {
+        new_capacity *= 2;
+    }
+    return new_capacity;
+}
+
+int _graph_get_int64(const struct BoltValue* value, int64_t* x)
+{
+    switch (BoltValue_type(value))
+    {
+        case BOLT_INT8:
+            *x = BoltInt8_get(value);
+            return 0;
+        case BOLT_INT16:
+            *x = BoltInt16_get(value);
+            return 0;
+        case BOLT_INT32:
+            *x = BoltInt32_get(value);
+            return 0;
+        case BOLT_INT64:
+            *x = BoltInt64_get(value);
+            return 0;
+        default:
+            return -1;
+    }
+}
+
+/**
+ * Read an entry from a path sequence, held either in compact form (as
+ * received) or as a list of integers.
+ */
+int _graph_sequence_get(const struct BoltValue* sequence, int32_t index, int64_t* x)
+{
+    if (BoltValue_type(sequence) == BOLT_INT32_ARRAY)
+    {
+        *x = BoltInt32Array_get(sequence, index);
+        return 0;
+    }
+    return _graph_get_int64(BoltList_value(sequence, index), x);
+}
+
+/**
+ * Find the index of a string within a list of strings, adding it to the
+ * end of the list if not already present.
+ */
+int32_t _graph_name_index(struct BoltValue* names, const struct BoltValue* name)
+{
+    const char* data = BoltString_get((struct BoltValue*)(name));
+    int32_t size = name->size;
+    for (int32_t i = 0; i < names->size; i++)
+    {
+        struct BoltValue* existing = BoltList_value(names, i);
+        if (existing->size == size && memcmp(BoltString_get(existing), data, (size_t)(size)) == 0)
+        {
+            return i;
+        }
+    }
+    BoltValue_to_String(BoltList_append(names), data, size);
+    return names->size - 1;
+}
+
+/**
+ * Find the column for a property key, or NULL if no such column exists.
+ */
+struct BoltValue* _graph_column(const struct BoltValue* columns, const char* key, size_t key_size)
+{
+    for (int32_t i = 0; i < columns->size; i++)
+    {
+        struct BoltValue* column_key = BoltDictionary_key((struct BoltValue*)(columns), i);
+        if ((size_t)(column_key->size) == key_size && memcmp(BoltString_get(column_key), key, key_size) == 0)
+        {
+            return BoltDictionary_value((struct BoltValue*)(columns), i);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Copy each entry of a property dictionary into the corresponding
+ * column at a given index, creating columns as required.
+ */
+int _graph_set_properties(struct BoltValue* columns, int32_t index, const struct BoltValue* properties)
+{
+    if (BoltValue_type(properties) != BOLT_DICTIONARY)
+    {
+        return -1;
+    }
+    struct BoltValue* dictionary = (struct BoltValue*)(properties);
+    for (int32_t i = 0; i < dictionary->size; i++)
+    {
+        const char* key = BoltDictionary_get_key(dictionary, i);
+        int32_t key_size = BoltDictionary_get_key_size(dictionary, i);
+        struct BoltValue* column = _graph_column(columns, key, (size_t)(key_size));
+        if (column == NULL)
+        {
+            column = BoltDictionary_append(columns, key, (size_t)(key_size));
+            BoltValue_to_List(column, 0);
+        }
+        if (column->size <= index)
+        {
+            BoltList_resize(column, _graph_grow_capacity(column->size, index + 1));
+        }
+        BoltValue_copy(BoltList_value(column, index), BoltDictionary_value(dictionary, i));
+    }
+    return 0;
+}
+
+int32_t _graph_node(struct BoltGraph* graph, int64_t id)
+{
+    struct _graph_id_slot* slot = _graph_id_map_find(graph->node_map, id);
+    if (slot->index != -1)
+    {
+        return slot->index;
+    }
+    int32_t index = graph->n_nodes;
+    if (index == graph->node_capacity)
+    {
+        int32_t capacity = _graph_grow_capacity(graph->node_capacity, index + 1);
+        graph->node_ids = BoltMem_adjust(graph->node_ids, sizeof_n(int64_t, graph->node_capacity),
+                                         sizeof_n(int64_t, capacity));
+        graph->node_complete = BoltMem_adjust(graph->node_complete, sizeof_n(char, graph->node_capacity),
+                                              sizeof_n(char, capacity));
+        graph->node_capacity = capacity;
+    }
+    graph->node_ids[index] = id;
+    graph->node_complete[index] = 0;
+    graph->n_nodes += 1;
+    _graph_id_map_put(graph->node_map, id, index);
+    return index;
+}
+
+int _graph_add_label(struct BoltGraph* graph, int32_t node, const struct BoltValue* label)
+{
+    if (BoltValue_type(label) != BOLT_STRING)
+    {
+        return -1;
+    }
+    int32_t n = graph->n_label_entries;
+    if (n == graph->label_entry_capacity)
+    {
+        int32_t capacity = _graph_grow_capacity(graph->label_entry_capacity, n + 1);
+        graph->label_entry_nodes = BoltMem_adjust(graph->label_entry_nodes,
+                                                  sizeof_n(int32_t, graph->label_entry_capacity),
+                                                  sizeof_n(int32_t, capacity));
+        graph->label_entry_labels = BoltMem_adjust(graph->label_entry_labels,
+                                                   sizeof_n(int32_t, graph->label_entry_capacity),
+                                                   sizeof_n(int32_t, capacity));
+        graph->label_entry_capacity = capacity;
+    }
+    graph->label_entry_nodes[n] = node;
+    graph->label_entry_labels[n] = _graph_name_index(graph->label_names, label);
+    graph->n_label_entries += 1;
+    return 0;
+}
+
+/**
+ * Add a Node structure, returning its index (or -1 if malformed).
+ */
+int32_t _graph_add_node(struct BoltGraph* graph, const struct BoltValue* value)
+{
+    int64_t id;
+    if (value->size != 3 || _graph_get_int64(BoltStructure_value(value, 0), &id) == -1)
+    {
+        return -1;
+    }
+    int32_t index = _graph_node(graph, id);
+    if (!graph->node_complete[index])
+    {
+        struct BoltValue* labels = BoltStructure_value(value, 1);
+        if (BoltValue_type(labels) != BOLT_LIST)
+        {
+            return -1;
+        }
+        for (int32_t i = 0; i < labels->size; i++)
+        {
+            try(_graph_add_label(graph, index, BoltList_value(labels, i)));
+        }
+        try(_graph_set_properties(graph->node_properties, index, BoltStructure_value(value, 2)));
+        graph->node_complete[index] = 1;
+    }
+    return index;
+}
+
+/**
+ * Add a relationship given its ID, type and properties along with the
+ * indexes of its start and end nodes.
+ */
+int _graph_add_relationship(struct BoltGraph* graph, const struct BoltValue* id_value, int32_t start, int32_t end,
+                            const struct BoltValue* type, const struct BoltValue* properties)
+{
+    int64_t id;
+    if (_graph_get_int64(id_value, &id) == -1 || BoltValue_type(type) != BOLT_STRING)
+    {
+        return -1;
+    }
+    if (_graph_id_map_find(graph->relationship_map, id)->index != -1)
+    {
+        return 0;
+    }
+    int32_t index = graph->n_relationships;
+    if (index == graph->relationship_capacity)
+    {
+        int32_t old_capacity = graph->relationship_capacity;
+        int32_t capacity = _graph_grow_capacity(old_capacity, index + 1);
+        graph->relationship_ids = BoltMem_adjust(graph->relationship_ids, sizeof_n(int64_t, old_capacity),
+                                                 sizeof_n(int64_t, capacity));
+        graph->relationship_starts = BoltMem_adjust(graph->relationship_starts, sizeof_n(int32_t, old_capacity),
+                                                    sizeof_n(int32_t, capacity));
+        graph->relationship_ends = BoltMem_adjust(graph->relationship_ends, sizeof_n(int32_t, old_capacity),
+                                                  sizeof_n(int32_t, capacity));
+        graph->relationship_types = BoltMem_adjust(graph->relationship_types, sizeof_n(int32_t, old_capacity),
+                                                   sizeof_n(int32_t, capacity));
+        graph->relationship_capacity = capacity;
+    }
+    try(_graph_set_properties(graph->relationship_properties, index, properties));
+    graph->relationship_ids[index] = id;
+    graph->relationship_starts[index] = start;
+    graph->relationship_ends[index] = end;
+    graph->relationship_types[index] = _graph_name_index(graph->type_names, type);
+    graph->n_relationships += 1;
+    _graph_id_map_put(graph->relationship_map, id, index);
+    return 0;
+}
+
+int _graph_add_bound_relationship(struct BoltGraph* graph, const struct BoltValue* value)
+{
+    int64_t start_id;
+    int64_t end_id;
+    if (value->size != 5 ||
+        _graph_get_int64(BoltStructure_value(value, 1), &start_id) == -1 ||
+        _graph_get_int64(BoltStructure_value(value, 2), &end_id) == -1)
+    {
+        return -1;
+    }
+    int32_t start = _graph_node(graph, start_id);
+    int32_t end = _graph_node(graph, end_id);
+    return _graph_add_relationship(graph, BoltStructure_value(value, 0), start, end,
+                                   BoltStructure_value(value, 3), BoltStructure_value(value, 4));
+}
+
+/**
+ * Add a Path structure. The sequence alternates between relationship
+ * and node indexes: relationship indexes are 1-based and negative for
+ * relationships traversed against their direction; node indexes are
+ * 0-based into the list of path nodes, the first of which is the start
+ * of the path.
+ */
+int _graph_add_path(struct BoltGraph* graph, const struct BoltValue* value)
+{
+    if (value->size != 3)
+    {
+        return -1;
+    }
+    struct BoltValue* nodes = BoltStructure_value(value, 0);
+    struct BoltValue* relationships = BoltStructure_value(value, 1);
+    struct BoltValue* sequence = BoltStructure_value(value, 2);
+    if (BoltValue_type(nodes) != BOLT_LIST || BoltValue_type(relationships) != BOLT_LIST ||
+        (BoltValue_type(sequence) != BOLT_INT32_ARRAY && BoltValue_type(sequence) != BOLT_LIST) ||
+        nodes->size == 0 || sequence->size % 2 != 0)
+    {
+        return -1;
+    }
+    for (int32_t i = 0; i < nodes->size; i++)
+    {
+        struct BoltValue* node = BoltList_value(nodes, i);
+        if (BoltValue_type(node) != BOLT_STRUCTURE || BoltStructure_code(node) != 'N')
+        {
+            return -1;
+        }
+        try(_graph_add_node(graph, node));
+    }
+    int32_t last = _graph_add_node(graph, BoltList_value(nodes, 0));
+    for (int32_t i = 0; i < sequence->size; i += 2)
+    {
+        int64_t relationship_index;
+        int64_t node_index;
+        if (_graph_sequence_get(sequence, i, &relationship_index) == -1 ||
+            _graph_sequence_get(sequence, i + 1, &node_index) == -1 ||
+            relationship_index == 0 || relationship_index > relationships->size ||
+            -relationship_index > relationships->size || node_index < 0 || node_index >= nodes->size)
+        {
+            return -1;
+        }
+        struct BoltValue* relationship = BoltList_value(relationships, (int32_t)(
+                (relationship_index > 0 ? relationship_index : -relationship_index) - 1));
+        if (BoltValue_type(relationship) != BOLT_STRUCTURE || BoltStructure_code(relationship) != 'r' ||
+            relationship->size != 3)
+        {
+            return -1;
+        }
+        int32_t next = _graph_add_node(graph, BoltList_value(nodes, (int32_t)(node_index)));
+        try(_graph_add_relationship(graph, BoltStructure_value(relationship, 0),
+                                    relationship_index > 0 ? last : next, relationship_index > 0 ? next : last,
+                                    BoltStructure_value(relationship, 1), BoltStructure_value(relationship, 2)));
+        last = next;
+    }
+    return 0;
+}
+
+/**
+ * Fill an offsets array (of n + 1 entries) and a permutation for a
+ * counting sort of `size` items by key.
+ */
+void _graph_counting_sort(int32_t n, int32_t size, const int32_t* keys, int32_t* offsets, int32_t* order)
+{
+    memset(offsets, 0, sizeof_n(int32_t, n + 1));
+    for (int32_t i = 0; i < size; i++)
+    {
+        offsets[keys[i] + 1] += 1;
+    }
+    for (int32_t i = 0; i < n; i++)
+    {
+        offsets[i + 1] += offsets[i];
+    }
+    for (int32_t i = 0; i < size; i++)
+    {
+        order[offsets[keys[i]]] = i;
+        offsets[keys[i]] += 1;
+    }
+    // Each offset now points at the end of its run, so shift back by one slot.
+    memmove(&offsets[1], &offsets[0], sizeof_n(int32_t, n));
+    offsets[0] = 0;
+}
+
+void _graph_release_csr(struct BoltGraph* graph)
+{
+    size_t offsets_size = sizeof_n(int32_t, graph->built_nodes + 1);
+    size_t relationships_size = sizeof_n(int32_t, graph->built_relationships);
+    graph->out_offsets = BoltMem_deallocate(graph->out_offsets, offsets_size);
+    graph->out_targets = BoltMem_deallocate(graph->out_targets, relationships_size);
+    graph->out_relationships = BoltMem_deallocate(graph->out_relationships, relationships_size);
+    graph->in_offsets = BoltMem_deallocate(graph->in_offsets, offsets_size);
+    graph->in_sources = BoltMem_deallocate(graph->in_sources, relationships_size);
+    graph->in_relationships = BoltMem_deallocate(graph->in_relationships, relationships_size);
+    graph->label_offsets = BoltMem_deallocate(graph->label_offsets, offsets_size);
+    graph->labels = BoltMem_deallocate(graph->labels, sizeof_n(int32_t, graph->built_labels));
+    graph->built_nodes = -1;
+    graph->built_relationships = 0;
+    graph->built_labels = 0;
+}
+
+struct BoltGraph* BoltGraph_create()
+{
+    struct BoltGraph* graph = BoltMem_allocate(sizeof(struct BoltGraph));
+    memset(graph, 0, sizeof(struct BoltGraph));
+    graph->label_names = BoltValue_create();
+    BoltValue_to_List(graph->label_names, 0);
+    graph->type_names = BoltValue_create();
+    BoltValue_to_List(graph->type_names, 0);
+    graph->node_properties = BoltValue_create();
+    BoltValue_to_Dictionary(graph->node_properties, 0);
+    graph->relationship_properties = BoltValue_create();
+    BoltValue_to_Dictionary(graph->relationship_properties, 0);
+    graph->node_map = _graph_id_map_create();
+    graph->relationship_map = _graph_id_map_create();
+    graph->built_nodes = -1;
+    return graph;
+}
+
+void BoltGraph_destroy(struct BoltGraph* graph)
+{
+    _graph_release_csr(graph);
+    BoltMem_deallocate(graph->node_ids, sizeof_n(int64_t, graph->node_capacity));
+    BoltMem_deallocate(graph->node_complete, sizeof_n(char, graph->node_capacity));
+    BoltMem_deallocate(graph->relationship_ids, sizeof_n(int64_t, graph->relationship_capacity));
+    BoltMem_deallocate(graph->relationship_starts, sizeof_n(int32_t, graph->relationship_capacity));
+    BoltMem_deallocate(graph->relationship_ends, sizeof_n(int32_t, graph->relationship_capacity));
+    BoltMem_deallocate(graph->relationship_types, sizeof_n(int32_t, graph->relationship_capacity));
+    BoltMem_deallocate(graph->label_entry_nodes, sizeof_n(int32_t, graph->label_entry_capacity));
+    BoltMem_deallocate(graph->label_entry_labels, sizeof_n(int32_t, graph->label_entry_capacity));
+    BoltValue_destroy(graph->label_names);
+    BoltValue_destroy(graph->type_names);
+    BoltValue_destroy(graph->node_properties);
+    BoltValue_destroy(graph->relationship_properties);
+    _graph_id_map_destroy(graph->node_map);
+    _graph_id_map_destroy(graph->relationship_map);
+    BoltMem_deallocate(graph, sizeof(struct BoltGraph));
+}
+
+int BoltGraph_add(struct BoltGraph* graph, const struct BoltValue* value)
+{
+    switch (BoltValue_type(value))
+    {
+        case BOLT_LIST:
+        {
+            for (int32_t i = 0; i < value->size; i++)
+            {
+                try(BoltGraph_add(graph, BoltList_value(value, i)));
+            }
+            return 0;
+        }
+        case BOLT_DICTIONARY:
+        {
+            for (int32_t i = 0; i < value->size; i++)
+            {
+                try(BoltGraph_add(graph, BoltDictionary_value((struct BoltValue*)(value), i)));
+            }
+            return 0;
+        }
+        case BOLT_STRUCTURE:
+        {
+            switch (BoltStructure_code(value))
+            {
+                case 'N':
+                    return _graph_add_node(graph, value) == -1 ? -1 : 0;
+                case 'R':
+                    return _graph_add_bound_relationship(graph, value);
+                case 'P':
+                    return _graph_add_path(graph, value);
+                default:
+                    for (int32_t i = 0; i < value->size; i++)
+                    {
+                        try(BoltGraph_add(graph, BoltStructure_value(value, i)));
+                    }
+                    return 0;
+            }
+        }
+        default:
+            return 0;
+    }
+}
+
+void BoltGraph_build(struct BoltGraph* graph)
+{
+    _graph_release_csr(graph);
+    int32_t n = graph->n_nodes;
+    int32_t size = graph->n_relationships;
+    int32_t* order = BoltMem_allocate(sizeof_n(int32_t, size > graph->n_label_entries ? size : graph->n_label_entries));
+
+    graph->out_offsets = BoltMem_allocate(sizeof_n(int32_t, n + 1));
+    graph->out_targets = BoltMem_allocate(sizeof_n(int32_t, size));
+    graph->out_relationships = BoltMem_allocate(sizeof_n(int32_t, size));
+    _graph_counting_sort(n, size, graph->relationship_starts, graph->out_offsets, order);
+    for (int32_t i = 0; i < size; i++)
+    {
+        graph->out_relationships[i] = order[i];
+        graph->out_targets[i] = graph->relationship_ends[order[i]];
+    }
+
+    graph->in_offsets = BoltMem_allocate(sizeof_n(int32_t, n + 1));
+    graph->in_sources = BoltMem_allocate(sizeof_n(int32_t, size));
+    graph->in_relationships = BoltMem_allocate(sizeof_n(int32_t, size));
+    _graph_counting_sort(n, size, graph->relationship_ends, graph->in_offsets, order);
+    for (int32_t i = 0; i < size; i++)
+    {
+        graph->in_relationships[i] = order[i];
+        graph->in_sources[i] = graph->relationship_starts[order[i]];
+    }
+
+    int32_t n_labels = graph->n_label_entries;
+    graph->label_offsets = BoltMem_allocate(sizeof_n(int32_t, n + 1));
+    graph->labels = BoltMem_allocate(sizeof_n(int32_t, n_labels));
+    _graph_counting_sort(n, n_labels, graph->label_entry_nodes, graph->label_offsets, order);
+    for (int32_t i = 0; i < n_labels; i++)
+    {
+        graph->labels[i] = graph->label_entry_labels[order[i]];
+    }
+
+    BoltMem_deallocate(order, sizeof_n(int32_t, size > n_labels ? size : n_labels));
+    graph->built_nodes = n;
+    graph->built_relationships = size;
+    graph->built_labels = n_labels;
+
+    for (int32_t i = 0; i < graph->node_properties->size; i++)
+    {
+        BoltList_resize(BoltDictionary_value(graph->node_properties, i), n);
+    }
+    for (int32_t i = 0; i < graph->relationship_properties->size; i++)
+    {
+        BoltList_resize(BoltDictionary_value(graph->relationship_properties, i), size);
+    }
+}
+
+int32_t BoltGraph_node_index(const struct BoltGraph* graph, int64_t id)
+{
+    return _graph_id_map_find(graph->node_map, id)->index;
+}
+
+int32_t BoltGraph_relationship_index(const struct BoltGraph* graph, int64_t id)
+{
+    return _graph_id_map_find(graph->relationship_map, id)->index;
+}
+
+const int32_t* BoltGraph_outgoing(const struct BoltGraph* graph, int32_t node, int32_t* size)
+{
+    assert(node >= 0 && node < graph->built_nodes);
+    *size = graph->out_offsets[node + 1] - graph->out_offsets[node];
+    return &graph->out_targets[graph->out_offsets[node]];
+}
+
+const int32_t* BoltGraph_incoming(const struct BoltGraph* graph, int32_t node, int32_t* size)
+{
+    assert(node >= 0 && node < graph->built_nodes);
+    *size = graph->in_offsets[node + 1] - graph->in_offsets[node];
+    return &graph->in_sources[graph->in_offsets[node]];
+}
+
+const int32_t* BoltGraph_node_labels(const struct BoltGraph* graph, int32_t node, int32_t* size)
+{
+    assert(node >= 0 && node < graph->built_nodes);
+    *size = graph->label_offsets[node + 1] - graph->label_offsets[node];
+    return &graph->labels[graph->label_offsets[node]];
+}
+
+struct BoltValue* BoltGraph_node_property(const struct BoltGraph* graph, int32_t node,
+                                          const char* key, size_t key_size)
+{
+    struct BoltValue* column = _graph_column(graph->node_properties, key, key_size);
+    if (column == NULL)
+    {
+        return NULL;
+    }
+    if (column->size <= node)
+    {
+        BoltList_resize(column, graph->n_nodes);
+    }
+    return BoltList_value(column, node);
+}
+
+struct BoltValue* BoltGraph_relationship_property(const struct BoltGraph* graph, int32_t relationship,
+                                                  const char* key, size_t key_size)
+{
+    struct BoltValue* column = _graph_column(graph->relationship_properties, key, key_size);
+    if (column == NULL)
+    {
+        return NULL;
+    }
+    if (column->size <= relationship)
+    {
+        BoltList_resize(column, graph->n_relationships);
+    }
+    return BoltList_value(column, relationship);
+}
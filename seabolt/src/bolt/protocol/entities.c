@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2002-2017 "Neo Technology,"
+ * Network Engine for Objects in Lund AB [http://neotechnology.com]
+ *
+ * This file is part of Neo4j.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <memory.h>
+#include "bolt/mem.h"
+#include "entities.h"
+
+#define INITIAL_CAPACITY 64
+
+
+size_t _entity_cache_slot_index(struct BoltEntityCache* cache, int16_t code, int64_t id)
+{
+    uint64_t hash = ((uint64_t)(id) ^ ((uint64_t)(code) << 56)) * 0x9E3779B97F4A7C15ULL;
+    return (size_t)(hash >> 32) & (size_t)(cache->capacity - 1);
+}
+
+struct _entity_slot* _entity_cache_find_slot(struct BoltEntityCache* cache, int16_t code, int64_t id)
+{
+    size_t mask = (size_t)(cache->capacity - 1);
+    for (size_t i = _entity_cache_slot_index(cache, code, id); ; i = (i + 1) & mask)
+    {
+        struct _entity_slot* slot = &cache->slots[i];
+        if (slot->entity == NULL || (slot->id == id && slot->code == code))
+        {
+            return slot;
+        }
+    }
+}
+
+void _entity_cache_grow(struct BoltEntityCache* cache)
+{
+    int32_t old_capacity = cache->capacity;
+    struct _entity_slot* old_slots = cache->slots;
+    cache->capacity = 2 * old_capacity;
+    cache->slots = BoltMem_allocate(sizeof_n(struct _entity_slot, cache->capacity));
+    memset(cache->slots, 0, sizeof_n(struct _entity_slot, cache->capacity));
+    for (int32_t i = 0; i < old_capacity; i++)
+    {
+        if (old_slots[i].entity != NULL)
+        {
+            *_entity_cache_find_slot(cache, old_slots[i].code, old_slots[i].id) = old_slots[i];
+        }
+    }
+    BoltMem_deallocate(old_slots, sizeof_n(struct _entity_slot, old_capacity));
+}
+
+struct BoltEntityCache* BoltEntityCache_create()
+{
+    struct BoltEntityCache* cache = BoltMem_allocate(sizeof(struct BoltEntityCache));
+    cache->capacity = INITIAL_CAPACITY;
+    cache->size = 0;
+    cache->slots = BoltMem_allocate(sizeof_n(struct _entity_slot, cache->capacity));
+    memset(cache->slots, 0, sizeof_n(struct _entity_slot, cache->capacity));
+    cache->hits = 0;
+    return cache;
+}
+
+void BoltEntityCache_destroy(struct BoltEntityCache* cache)
+{
+    BoltEntityCache_clear(cache);
+    BoltMem_deallocate(cache->slots, sizeof_n(struct _entity_slot, cache->capacity));
+    BoltMem_deallocate(cache, sizeof(struct BoltEntityCache));
+}
+
+void BoltEntityCache_clear(struct BoltEntityCache* cache)
+{
+    if (cache->size > 0)
+    {
+        for (int32_t i = 0; i < cache->capacity; i++)
+        {
+            if (cache->slots[i].entity != NULL)
+            {
+                BoltSharedValue_release(cache->slots[i].entity);
+                cache->slots[i].entity = NULL;
+            }
+        }
+        cache->size = 0;
+    }
+    cache->hits = 0;
+}
+
+struct BoltSharedValue* BoltEntityCache_get(struct BoltEntityCache* cache, int16_t code, int64_t id)
+{
+    struct BoltSharedValue* entity = _entity_cache_find_slot(cache, code, id)->entity;
+    if (entity != NULL)
+    {
+        cache->hits += 1;
+    }
+    return entity;
+}
+
+void BoltEntityCache_put(struct BoltEntityCache* cache, int16_t code, int64_t id, struct BoltSharedValue* entity)
+{
+    if (2 * (cache->size + 1) > cache->capacity)
+    {
+        _entity_cache_grow(cache);
+    }
+    struct _entity_slot* slot = _entity_cache_find_slot(cache, code, id);
+    if (slot->entity != NULL)
+    {
+        BoltSharedValue_release(slot->entity);
+    }
+    else
+    {
+        cache->size += 1;
+    }
+    slot->id = id;
+    slot->code = code;
+    slot->entity = entity;
+}
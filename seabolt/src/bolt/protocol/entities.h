@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2002-2017 "Neo Technology,"
+ * Network Engine for Objects in Lund AB [http://neotechnology.com]
+ *
+ * This file is part of Neo4j.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ */
+
+#ifndef SEABOLT_PROTOCOL_ENTITIES
+#define SEABOLT_PROTOCOL_ENTITIES
+
+#include <stdint.h>
+#include <bolt/values.h>
+
+
+struct _entity_slot
+{
+    int64_t id;
+    int16_t code;
+    struct BoltSharedValue* entity;
+};
+
+/**
+ * Identity cache for graph entities (nodes and relationships) received
+ * within a single result. Each entity is decoded once and held as a
+ * shared value; later occurrences borrow it instead of being decoded
+ * again.
+ */
+struct BoltEntityCache
+{
+    /// Number of slots in the hash table (always a power of two)
+    int32_t capacity;
+    /// Number of entities held
+    int32_t size;
+    struct _entity_slot* slots;
+    /// Number of lookups satisfied by the cache since it was last cleared
+    unsigned long long hits;
+};
+
+struct BoltEntityCache* BoltEntityCache_create();
+
+void BoltEntityCache_destroy(struct BoltEntityCache* cache);
+
+/**
+ * Release all entities held by the cache. Values still borrowing these
+ * entities remain valid until they are themselves recycled.
+ *
+ * @param cache
+ */
+void BoltEntityCache_clear(struct BoltEntityCache* cache);
+
+/**
+ * Look up an entity by structure code and identity.
+ *
+ * @param cache
+ * @param code
+ * @param id
+ * @return the shared entity or NULL if not cached
+ */
+struct BoltSharedValue* BoltEntityCache_get(struct BoltEntityCache* cache, int16_t code, int64_t id);
+
+/**
+ * Add a fully decoded entity to the cache, which takes over the
+ * reference held by the caller. Any entity already cached under the same
+ * code and identity is released.
+ *
+ * @param cache
+ * @param code
+ * @param id
+ * @param entity
+ */
+void BoltEntityCache_put(struct BoltEntityCache* cache, int16_t code, int64_t id, struct BoltSharedValue* entity);
+
+
+#endif // SEABOLT_PROTOCOL_ENTITIES
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2002-2017 "Neo Technology,"
+ * Network Engine for Objects in Lund AB [http://neotechnology.com]
+ *
+ * This file is part of Neo4j.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ */
+
+#ifndef SEABOLT_PROTOCOL
+#define SEABOLT_PROTOCOL
+
+#include <stddef.h>
+#include <stdint.h>
+#include <bolt/buffering.h>
+#include <bolt/connect.h>
+#include <bolt/packstream.h>
+
+
+struct BoltResponseBuffer;
+
+/**
+ * Table of operations for a protocol version. A table is chosen once,
+ * by the handshake, and installed as `connection->protocol`; each
+ * `BoltConnection_*` function then forwards to it with a single call.
+ *
+ * Several protocol versions may share a table, if one implementation
+ * handles them all (Bolt v1 to v4 are all served by `BOLT_PROTOCOL_V1`).
+ */
+struct BoltProtocol
+{
+    void* (*create_state)(int32_t protocol_version);
+    void (*destroy_state)(void* state);
+
+    int (*init_b)(struct BoltConnection* connection, const char* user_agent, const char* user, const char* password);
+    int (*goodbye_b)(struct BoltConnection* connection);
+
+    int (*fetch_b)(struct BoltConnection* connection, bolt_request_t request);
+    int (*fetch_reader_b)(struct BoltConnection* connection, bolt_request_t request, struct BoltPackReader* reader);
+    int (*fetch_summary_b)(struct BoltConnection* connection, bolt_request_t request);
+    int (*fetch_batch_b)(struct BoltConnection* connection, bolt_request_t request, int32_t max_records,
+                         struct BoltValue* records);
+    struct BoltValue* (*data)(struct BoltConnection* connection);
+    const struct BoltSummary* (*summary)(struct BoltConnection* connection);
+    bolt_request_t (*last_request)(struct BoltConnection* connection);
+
+    int (*set_cypher_template)(struct BoltConnection* connection, const char* statement, size_t size);
+    int (*set_n_cypher_parameters)(struct BoltConnection* connection, int32_t size);
+    int (*set_cypher_parameter_key)(struct BoltConnection* connection, int32_t index, const char* key,
+                                    size_t key_size);
+    struct BoltValue* (*cypher_parameter_value)(struct BoltConnection* connection, int32_t index);
+
+    int (*set_entity_cache)(struct BoltConnection* connection, int enabled);
+    int (*set_string_views)(struct BoltConnection* connection, int enabled);
+    int (*project)(struct BoltConnection* connection, int32_t field, const char* path, size_t path_size);
+    int (*clear_projection)(struct BoltConnection* connection);
+    int (*set_fetch_size)(struct BoltConnection* connection, int32_t size);
+    int (*set_response_buffer)(struct BoltConnection* connection, size_t max_size,
+                               enum BoltResponseOverflow overflow);
+    struct BoltResponseBuffer* (*response_buffer)(struct BoltConnection* connection);
+
+    int (*load_bookmark)(struct BoltConnection* connection, const char* bookmark);
+    int (*load_begin_request)(struct BoltConnection* connection);
+    int (*load_commit_request)(struct BoltConnection* connection);
+    int (*load_rollback_request)(struct BoltConnection* connection);
+    int (*load_run_request)(struct BoltConnection* connection);
+    int (*load_discard_request)(struct BoltConnection* connection, int32_t n);
+    int (*load_pull_request)(struct BoltConnection* connection, int32_t n);
+
+    int (*open_run_stream_b)(struct BoltConnection* connection, const char* key, size_t key_size, int32_t size);
+    int (*load_stream_value_b)(struct BoltConnection* connection, struct BoltValue* value);
+    int (*close_run_stream_b)(struct BoltConnection* connection);
+    struct BoltPackWriter* (*open_run_writer)(struct BoltConnection* connection, int32_t size);
+    int (*close_run_writer)(struct BoltConnection* connection);
+    int (*load_run_batch_b)(struct BoltConnection* connection, const char* key, size_t key_size,
+                            struct BoltColumnBatch* batch, int32_t n_rows);
+    struct BoltPreparedRequest* (*prepare_run_request)(struct BoltConnection* connection);
+    int (*load_prepared_run_request)(struct BoltConnection* connection, struct BoltPreparedRequest* prepared);
+
+    int32_t (*n_fields)(struct BoltConnection* connection);
+    const char* (*field_name)(struct BoltConnection* connection, int32_t index);
+    int32_t (*field_name_size)(struct BoltConnection* connection, int32_t index);
+    struct BoltValue* (*field_names)(struct BoltConnection* connection);
+    int (*dump)(struct BoltValue* value, struct BoltBuffer* buffer);
+};
+
+
+#endif // SEABOLT_PROTOCOL
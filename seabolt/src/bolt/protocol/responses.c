@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2002-2017 "Neo Technology,"
+ * Network Engine for Objects in Lund AB [http://neotechnology.com]
+ *
+ * This file is part of Neo4j.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <memory.h>
+#include <bolt/values.h>
+#include "bolt/mem.h"
+#include "responses.h"
+
+#define INITIAL_QUEUE_CAPACITY 8
+
+
+struct _response_queue* _responses_find_queue(struct BoltResponseBuffer* buffer, bolt_request_t request)
+{
+    for (int32_t i = 0; i < buffer->n_queues; i++)
+    {
+        if (buffer->queues[i].request == request)
+        {
+            return &buffer->queues[i];
+        }
+    }
+    return NULL;
+}
+
+struct _response_queue* _responses_add_queue(struct BoltResponseBuffer* buffer, bolt_request_t request)
+{
+    if (buffer->n_queues == buffer->queue_capacity)
+    {
+        int32_t capacity = 2 * buffer->queue_capacity;
+        buffer->queues = BoltMem_reallocate(buffer->queues, sizeof_n(struct _response_queue, buffer->queue_capacity),
+                                            sizeof_n(struct _response_queue, capacity));
+        buffer->queue_capacity = capacity;
+    }
+    struct _response_queue* queue = &buffer->queues[buffer->n_queues];
+    buffer->n_queues += 1;
+    queue->request = request;
+    queue->first = NULL;
+    queue->last = NULL;
+    return queue;
+}
+
+void _responses_release_message(struct _held_message* message)
+{
+    if (message->data != NULL)
+    {
+        BoltMem_deallocate(message->data, (size_t)(message->size));
+    }
+    BoltMem_deallocate(message, sizeof(struct _held_message));
+}
+
+struct BoltResponseBuffer* BoltResponseBuffer_create(size_t max_size, enum BoltResponseOverflow overflow)
+{
+    struct BoltResponseBuffer* buffer = BoltMem_allocate(sizeof(struct BoltResponseBuffer));
+    buffer->max_size = max_size;
+    buffer->overflow = overflow;
+    buffer->n_queues = 0;
+    buffer->queue_capacity = INITIAL_QUEUE_CAPACITY;
+    buffer->queues = BoltMem_allocate(sizeof_n(struct _response_queue, buffer->queue_capacity));
+    buffer->spill_file = NULL;
+    buffer->spill_extent = 0;
+    buffer->buffered_size = 0;
+    buffer->peak_buffered_size = 0;
+    buffer->spilled_size = 0;
+    buffer->current = NULL;
+    return buffer;
+}
+
+void BoltResponseBuffer_destroy(struct BoltResponseBuffer* buffer)
+{
+    for (int32_t i = 0; i < buffer->n_queues; i++)
+    {
+        struct _held_message* message = buffer->queues[i].first;
+        while (message != NULL)
+        {
+            struct _held_message* next = message->next;
+            _responses_release_message(message);
+            message = next;
+        }
+    }
+    if (buffer->current != NULL)
+    {
+        _responses_release_message(buffer->current);
+    }
+    if (buffer->spill_file != NULL)
+    {
+        fclose(buffer->spill_file);
+    }
+    BoltMem_deallocate(buffer->queues, sizeof_n(struct _response_queue, buffer->queue_capacity));
+    BoltMem_deallocate(buffer, sizeof(struct BoltResponseBuffer));
+}
+
+int BoltResponseBuffer_full(struct BoltResponseBuffer* buffer)
+{
+    return buffer->overflow == BOLT_OVERFLOW_BLOCK && buffer->buffered_size >= buffer->max_size;
+}
+
+int BoltResponseBuffer_push(struct BoltResponseBuffer* buffer, bolt_request_t request, const char* data,
+                            int32_t size, int summary)
+{
+    struct _held_message* message = BoltMem_allocate(sizeof(struct _held_message));
+    message->next = NULL;
+    message->size = size;
+    message->summary = summary;
+    if (buffer->overflow == BOLT_OVERFLOW_SPILL && buffer->buffered_size + size > buffer->max_size)
+    {
+        if (buffer->spill_file == NULL)
+        {
+            buffer->spill_file = tmpfile();
+        }
+        if (buffer->spill_file == NULL || fseek(buffer->spill_file, buffer->spill_extent, SEEK_SET) != 0 ||
+            fwrite(data, 1, (size_t)(size), buffer->spill_file) != (size_t)(size))
+        {
+            BoltMem_deallocate(message, sizeof(struct _held_message));
+            return -1;
+        }
+        message->data = NULL;
+        message->offset = buffer->spill_extent;
+        buffer->spill_extent += size;
+        buffer->spilled_size += size;
+    }
+    else
+    {
+        message->data = BoltMem_allocate((size_t)(size));
+        memcpy(message->data, data, (size_t)(size));
+        message->offset = -1;
+        buffer->buffered_size += size;
+        if (buffer->buffered_size > buffer->peak_buffered_size)
+        {
+            buffer->peak_buffered_size = buffer->buffered_size;
+        }
+    }
+    struct _response_queue* queue = _responses_find_queue(buffer, request);
+    if (queue == NULL)
+    {
+        queue = _responses_add_queue(buffer, request);
+    }
+    if (queue->last == NULL)
+    {
+        queue->first = message;
+    }
+    else
+    {
+        queue->last->next = message;
+    }
+    queue->last = message;
+    return 0;
+}
+
+int BoltResponseBuffer_holds(struct BoltResponseBuffer* buffer, bolt_request_t request)
+{
+    return _responses_find_queue(buffer, request) != NULL;
+}
+
+int BoltResponseBuffer_holds_record(struct BoltResponseBuffer* buffer, bolt_request_t request)
+{
+    struct _response_queue* queue = _responses_find_queue(buffer, request);
+    return queue != NULL && !queue->first->summary;
+}
+
+char* BoltResponseBuffer_pop(struct BoltResponseBuffer* buffer, bolt_request_t request, int32_t* size,
+                             int* summary)
+{
+    struct _response_queue* queue = _responses_find_queue(buffer, request);
+    if (queue == NULL)
+    {
+        return NULL;
+    }
+    struct _held_message* message = queue->first;
+    if (message->data == NULL)
+    {
+        // Read spilled data back before anything changes, so that a failed
+        // read leaves the message held
+        char* data = BoltMem_allocate((size_t)(message->size));
+        if (fseek(buffer->spill_file, message->offset, SEEK_SET) != 0 ||
+            fread(data, 1, (size_t)(message->size), buffer->spill_file) != (size_t)(message->size))
+        {
+            BoltMem_deallocate(data, (size_t)(message->size));
+            return NULL;
+        }
+        message->data = data;
+        buffer->spilled_size -= message->size;
+        if (buffer->spilled_size == 0)
+        {
+            // Nothing left in the spill file, so it can be written again from the start
+            buffer->spill_extent = 0;
+        }
+    }
+    else
+    {
+        buffer->buffered_size -= message->size;
+    }
+    if (buffer->current != NULL)
+    {
+        _responses_release_message(buffer->current);
+    }
+    queue->first = message->next;
+    if (queue->first == NULL)
+    {
+        // Anything further for this request is still to be received, so
+        // an empty queue can go
+        *queue = buffer->queues[buffer->n_queues - 1];
+        buffer->n_queues -= 1;
+    }
+    buffer->current = message;
+    *size = message->size;
+    *summary = message->summary;
+    return message->data;
+}
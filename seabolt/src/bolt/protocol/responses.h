@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2002-2017 "Neo Technology,"
+ * Network Engine for Objects in Lund AB [http://neotechnology.com]
+ *
+ * This file is part of Neo4j.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ */
+
+#ifndef SEABOLT_PROTOCOL_RESPONSES
+#define SEABOLT_PROTOCOL_RESPONSES
+
+#include <stdint.h>
+#include <stdio.h>
+#include <bolt/connect.h>
+
+
+struct _held_message
+{
+    struct _held_message* next;
+    /// PackStream data of the message (NULL while spilled)
+    char* data;
+    int32_t size;
+    /// Non-zero for a summary, zero for a record
+    int summary;
+    /// Position of the message within the spill file (-1 if held in memory)
+    long offset;
+};
+
+struct _response_queue
+{
+    bolt_request_t request;
+    struct _held_message* first;
+    struct _held_message* last;
+};
+
+/**
+ * Holding area for responses that arrive ahead of the request being
+ * fetched. Each message is held back, as raw PackStream data, in a queue
+ * for the request to which it responds, until that request is fetched.
+ */
+struct BoltResponseBuffer
+{
+    /// Number of message bytes that may be held in memory
+    size_t max_size;
+    /// What to do once `max_size` bytes are held
+    enum BoltResponseOverflow overflow;
+    int32_t n_queues;
+    int32_t queue_capacity;
+    struct _response_queue* queues;
+    /// Temporary file holding spilled messages (opened on first use)
+    FILE* spill_file;
+    /// End of the data written to the spill file
+    long spill_extent;
+    /// Number of message bytes currently held in memory
+    size_t buffered_size;
+    /// Highest number of message bytes held in memory at once
+    size_t peak_buffered_size;
+    /// Number of message bytes currently held in the spill file
+    size_t spilled_size;
+    /// The message most recently taken from a queue, valid until the next is taken
+    struct _held_message* current;
+};
+
+struct BoltResponseBuffer* BoltResponseBuffer_create(size_t max_size, enum BoltResponseOverflow overflow);
+
+void BoltResponseBuffer_destroy(struct BoltResponseBuffer* buffer);
+
+/**
+ * Determine whether no more messages may be held, which is only ever the
+ * case for the `BOLT_OVERFLOW_BLOCK` policy.
+ *
+ * @param buffer
+ * @return non-zero if full
+ */
+int BoltResponseBuffer_full(struct BoltResponseBuffer* buffer);
+
+/**
+ * Hold a copy of a message for a request.
+ *
+ * @param buffer
+ * @param request
+ * @param data
+ * @param size
+ * @param summary non-zero for a summary, zero for a record (returned as given by `BoltResponseBuffer_pop`)
+ * @return 0 on success, -1 if the message could not be spilled
+ */
+int BoltResponseBuffer_push(struct BoltResponseBuffer* buffer, bolt_request_t request, const char* data,
+                            int32_t size, int summary);
+
+/**
+ * Determine whether any messages are held for a request.
+ *
+ * @param buffer
+ * @param request
+ * @return non-zero if messages are held
+ */
+int BoltResponseBuffer_holds(struct BoltResponseBuffer* buffer, bolt_request_t request);
+
+/**
+ * Determine whether the next message held for a request is a record.
+ *
+ * @param buffer
+ * @param request
+ * @return non-zero if a record is held next
+ */
+int BoltResponseBuffer_holds_record(struct BoltResponseBuffer* buffer, bolt_request_t request);
+
+/**
+ * Take the next message held for a request. The data remains valid until
+ * the next message is taken or the buffer is destroyed. If spilled data
+ * cannot be read back, the message remains held.
+ *
+ * @param buffer
+ * @param request
+ * @param size pointer to receive the size of the message
+ * @param summary pointer to receive the summary flag of the message
+ * @return pointer to the message data, or NULL if none is held or it cannot be read back
+ */
+char* BoltResponseBuffer_pop(struct BoltResponseBuffer* buffer, bolt_request_t request, int32_t* size,
+                             int* summary);
+
+
+#endif // SEABOLT_PROTOCOL_RESPONSES
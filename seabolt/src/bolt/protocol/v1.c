@@ -18,28 +18,39 @@
  */
 
 
+#include <stddef.h>
 #include <stdlib.h>
 #include <bolt/values.h>
 #include <memory.h>
 #include <assert.h>
 #include "bolt/buffering.h"
 #include "v1.h"
+#include "entities.h"
+#include "responses.h"
 #include "bolt/mem.h"
 #include "bolt/logging.h"
 
+#define HELLO 0x01
+#define GOODBYE 0x02
 #define RUN 0x10
+#define BEGIN 0x11
+#define COMMIT 0x12
+#define ROLLBACK 0x13
 #define DISCARD_ALL 0x2F
 #define PULL_ALL 0x3F
 
 #define INITIAL_TX_BUFFER_SIZE 8192
 #define INITIAL_RX_BUFFER_SIZE 8192
 
+#define MAX_CHUNK_SIZE 0xFFFF
+#define STREAM_SEND_SIZE 0x40000
+
 #define MAX_BOOKMARK_SIZE 40
 #define MAX_SERVER_SIZE 200
 
 #define MAX_LOGGED_RECORDS 3
 
-#define char_to_uint16be(array) ((uint8_t)(header[0]) << 8) | (uint8_t)(header[1]);
+#define char_to_uint16be(array) ((uint16_t)(((uint8_t)((array)[0]) << 8) | (uint8_t)((array)[1])))
 
 
 int BoltProtocolV1_compile_INIT(struct BoltValue* value, const char* user_agent, const char* user, const char* password)
@@ -64,46 +75,165 @@ int BoltProtocolV1_compile_INIT(struct BoltValue* value, const char* user_agent,
     return 0;
 }
 
-void compile_RUN(struct _run_request * run, int32_t n_parameters)
+int BoltProtocolV1_compile_HELLO(struct BoltValue* value, const char* user_agent, const char* user, const char* password)
+{
+    BoltValue_to_Message(value, HELLO, 1);
+    struct BoltValue* extra = BoltMessage_value(value, 0);
+    if (user == NULL || password == NULL)
+    {
+        BoltValue_to_Dictionary(extra, 1);
+    }
+    else
+    {
+        BoltValue_to_Dictionary(extra, 4);
+        BoltDictionary_set_key(extra, 1, "scheme", 6);
+        BoltDictionary_set_key(extra, 2, "principal", 9);
+        BoltDictionary_set_key(extra, 3, "credentials", 11);
+        BoltValue_to_String(BoltDictionary_value(extra, 1), "basic", 5);
+        BoltValue_to_String(BoltDictionary_value(extra, 2), user, strlen(user));
+        BoltValue_to_String(BoltDictionary_value(extra, 3), password, strlen(password));
+    }
+    BoltDictionary_set_key(extra, 0, "user_agent", 10);
+    BoltValue_to_String(BoltDictionary_value(extra, 0), user_agent, strlen(user_agent));
+    return 0;
+}
+
+void compile_RUN(struct _run_request * run, int32_t n_parameters, int32_t protocol_version)
 {
     run->request = BoltValue_create();
-    BoltValue_to_Message(run->request, RUN, 2);
+    run->encoded = NULL;
+    // From Bolt v3, RUN carries a third field for transaction metadata
+    BoltValue_to_Message(run->request, RUN, protocol_version >= 3 ? 3 : 2);
     run->statement = BoltMessage_value(run->request, 0);
     run->parameters = BoltMessage_value(run->request, 1);
     BoltValue_to_Dictionary(run->parameters, n_parameters);
+    if (protocol_version >= 3)
+    {
+        BoltValue_to_Dictionary(BoltMessage_value(run->request, 2), 0);
+    }
+}
+
+/**
+ * Compile a transaction control message, as used from Bolt v3 in place
+ * of running BEGIN, COMMIT and ROLLBACK as Cypher. Any metadata (such
+ * as bookmarks) is held in the `parameters` dictionary.
+ *
+ * @param request
+ * @param code
+ * @param with_metadata
+ */
+void compile_transaction_message(struct _run_request * request, int16_t code, int with_metadata)
+{
+    request->request = BoltValue_create();
+    request->encoded = NULL;
+    BoltValue_to_Message(request->request, code, with_metadata ? 1 : 0);
+    request->statement = NULL;
+    request->parameters = NULL;
+    if (with_metadata)
+    {
+        request->parameters = BoltMessage_value(request->request, 0);
+        BoltValue_to_Dictionary(request->parameters, 0);
+    }
+}
+
+/**
+ * Compile a PULL or DISCARD message. From Bolt v4 these carry the number
+ * of records `n` to stream, with -1 meaning all of them.
+ *
+ * @param code
+ * @param protocol_version
+ * @return
+ */
+struct BoltValue* compile_stream_message(int16_t code, int32_t protocol_version)
+{
+    struct BoltValue* request = BoltValue_create();
+    if (protocol_version >= 4)
+    {
+        BoltValue_to_Message(request, code, 1);
+        struct BoltValue* extra = BoltMessage_value(request, 0);
+        BoltValue_to_Dictionary(extra, 1);
+        BoltDictionary_set_key(extra, 0, "n", 1);
+        BoltValue_to_Int64(BoltDictionary_value(extra, 0), -1);
+    }
+    else
+    {
+        BoltValue_to_Message(request, code, 0);
+    }
+    return request;
 }
 
-struct BoltProtocolV1State* BoltProtocolV1_create_state()
+struct BoltBuffer* encode_message(struct BoltValue * value);
+
+void clear_summary(struct BoltSummary * summary)
+{
+    memset(summary, 0, sizeof(struct BoltSummary));
+    summary->result_available_after = -1;
+    summary->result_consumed_after = -1;
+    summary->type = BOLT_QUERY_UNKNOWN;
+}
+
+struct BoltProtocolV1State* BoltProtocolV1_create_state(int32_t protocol_version)
 {
     struct BoltProtocolV1State* state = BoltMem_allocate(sizeof(struct BoltProtocolV1State));
 
     state->tx_buffer = BoltBuffer_create(INITIAL_TX_BUFFER_SIZE);
     state->rx_buffer = BoltBuffer_create(INITIAL_RX_BUFFER_SIZE);
+    state->rx_message = state->rx_buffer;
+    state->rx_view = 0;
+    state->rx_view_size = 0;
 
     state->server = BoltMem_allocate(MAX_SERVER_SIZE);
     memset(state->server, 0, MAX_SERVER_SIZE);
     state->fields = BoltValue_create();
     state->last_bookmark = BoltMem_allocate(MAX_BOOKMARK_SIZE);
     memset(state->last_bookmark, 0, MAX_BOOKMARK_SIZE);
+    clear_summary(&state->summary);
 
     state->next_request_id = 0;
     state->response_counter = 0;
+    state->record_counter = 0;
 
-    compile_RUN(&state->run, 0);
-    compile_RUN(&state->begin, 0);
-    BoltValue_to_String(state->begin.statement, "BEGIN", 5);
-    compile_RUN(&state->commit, 0);
-    BoltValue_to_String(state->commit.statement, "COMMIT", 6);
-    compile_RUN(&state->rollback, 0);
-    BoltValue_to_String(state->rollback.statement, "ROLLBACK", 8);
-
-    state->discard_request = BoltValue_create();
-    BoltValue_to_Message(state->discard_request, DISCARD_ALL, 0);
+    compile_RUN(&state->run, 0, protocol_version);
+    if (protocol_version >= 3)
+    {
+        compile_transaction_message(&state->begin, BEGIN, 1);
+        compile_transaction_message(&state->commit, COMMIT, 0);
+        compile_transaction_message(&state->rollback, ROLLBACK, 0);
+    }
+    else
+    {
+        compile_RUN(&state->begin, 0, protocol_version);
+        BoltValue_to_String(state->begin.statement, "BEGIN", 5);
+        compile_RUN(&state->commit, 0, protocol_version);
+        BoltValue_to_String(state->commit.statement, "COMMIT", 6);
+        compile_RUN(&state->rollback, 0, protocol_version);
+        BoltValue_to_String(state->rollback.statement, "ROLLBACK", 8);
+    }
+    // Transaction control messages are sent unchanged, except when BEGIN carries bookmarks
+    state->begin.encoded = encode_message(state->begin.request);
+    state->commit.encoded = encode_message(state->commit.request);
+    state->rollback.encoded = encode_message(state->rollback.request);
 
-    state->pull_request = BoltValue_create();
-    BoltValue_to_Message(state->pull_request, PULL_ALL, 0);
+    state->discard_request = compile_stream_message(DISCARD_ALL, protocol_version);
+    state->pull_request = compile_stream_message(PULL_ALL, protocol_version);
+    state->encoded_discard_all = encode_message(state->discard_request);
+    state->encoded_pull_all = encode_message(state->pull_request);
+    state->fetch_size = -1;
+    state->windows = NULL;
+    state->n_windows = 0;
+    state->windows_capacity = 0;
+    state->responses = NULL;
 
     state->data = BoltValue_create();
+
+    state->entity_cache = NULL;
+    state->string_views = 0;
+    state->rx_string_views = 0;
+    state->projection = NULL;
+    state->stream_remaining = -1;
+    state->stream_mark = 0;
+    state->stream_flushed = 0;
+    state->writer.open = 0;
     return state;
 }
 
@@ -118,9 +248,14 @@ void BoltProtocolV1_destroy_state(struct BoltProtocolV1State* state)
     BoltValue_destroy(state->begin.request);
     BoltValue_destroy(state->commit.request);
     BoltValue_destroy(state->rollback.request);
+    BoltBuffer_destroy(state->begin.encoded);
+    BoltBuffer_destroy(state->commit.encoded);
+    BoltBuffer_destroy(state->rollback.encoded);
 
     BoltValue_destroy(state->discard_request);
     BoltValue_destroy(state->pull_request);
+    BoltBuffer_destroy(state->encoded_discard_all);
+    BoltBuffer_destroy(state->encoded_pull_all);
 
     BoltMem_deallocate(state->server, MAX_SERVER_SIZE);
     BoltValue_destroy(state->fields);
@@ -128,6 +263,23 @@ void BoltProtocolV1_destroy_state(struct BoltProtocolV1State* state)
 
     BoltValue_destroy(state->data);
 
+    if (state->entity_cache != NULL)
+    {
+        BoltEntityCache_destroy(state->entity_cache);
+    }
+
+    if (state->projection != NULL)
+    {
+        BoltValue_destroy(state->projection);
+    }
+
+    if (state->responses != NULL)
+    {
+        BoltResponseBuffer_destroy(state->responses);
+    }
+
+    BoltMem_deallocate(state->windows, sizeof_n(bolt_request_t, state->windows_capacity));
+
     BoltMem_deallocate(state, sizeof(struct BoltProtocolV1State));
 }
 
@@ -136,44 +288,181 @@ struct BoltProtocolV1State* BoltProtocolV1_state(struct BoltConnection* connecti
     return (struct BoltProtocolV1State*)(connection->protocol_state);
 }
 
+/**
+ * Description of a PackStream marker byte.
+ */
+struct _marker
+{
+    /// General type of value introduced by the marker
+    uint8_t type;
+    /// Size held within the marker itself (tiny strings, lists, maps and structures)
+    uint8_t size;
+    /// Width in bytes of the size field or value that follows the marker
+    uint8_t width;
+};
+
+#define MARKER(type, size, width) {BOLT_V1_##type, size, width}
+
+#define MARKER_ROW(type) \
+    MARKER(type, 0, 0), MARKER(type, 0, 0), MARKER(type, 0, 0), MARKER(type, 0, 0), \
+    MARKER(type, 0, 0), MARKER(type, 0, 0), MARKER(type, 0, 0), MARKER(type, 0, 0), \
+    MARKER(type, 0, 0), MARKER(type, 0, 0), MARKER(type, 0, 0), MARKER(type, 0, 0), \
+    MARKER(type, 0, 0), MARKER(type, 0, 0), MARKER(type, 0, 0), MARKER(type, 0, 0)
+
+#define TINY_MARKER_ROW(type) \
+    MARKER(type, 0x0, 0), MARKER(type, 0x1, 0), MARKER(type, 0x2, 0), MARKER(type, 0x3, 0), \
+    MARKER(type, 0x4, 0), MARKER(type, 0x5, 0), MARKER(type, 0x6, 0), MARKER(type, 0x7, 0), \
+    MARKER(type, 0x8, 0), MARKER(type, 0x9, 0), MARKER(type, 0xA, 0), MARKER(type, 0xB, 0), \
+    MARKER(type, 0xC, 0), MARKER(type, 0xD, 0), MARKER(type, 0xE, 0), MARKER(type, 0xF, 0)
+
+const struct _marker MARKERS[256] = {
+    MARKER_ROW(INTEGER),                                                                    // 0x00..0x0F
+    MARKER_ROW(INTEGER),                                                                    // 0x10..0x1F
+    MARKER_ROW(INTEGER),                                                                    // 0x20..0x2F
+    MARKER_ROW(INTEGER),                                                                    // 0x30..0x3F
+    MARKER_ROW(INTEGER),                                                                    // 0x40..0x4F
+    MARKER_ROW(INTEGER),                                                                    // 0x50..0x5F
+    MARKER_ROW(INTEGER),                                                                    // 0x60..0x6F
+    MARKER_ROW(INTEGER),                                                                    // 0x70..0x7F
+    TINY_MARKER_ROW(STRING),                                                                // 0x80..0x8F
+    TINY_MARKER_ROW(LIST),                                                                  // 0x90..0x9F
+    TINY_MARKER_ROW(MAP),                                                                   // 0xA0..0xAF
+    TINY_MARKER_ROW(STRUCTURE),                                                             // 0xB0..0xBF
+    MARKER(NULL, 0, 0), MARKER(FLOAT, 0, 8), MARKER(BOOLEAN, 0, 0), MARKER(BOOLEAN, 0, 0),  // 0xC0..0xC3
+    MARKER(RESERVED, 0, 0), MARKER(RESERVED, 0, 0), MARKER(RESERVED, 0, 0), MARKER(RESERVED, 0, 0),
+    MARKER(INTEGER, 0, 1), MARKER(INTEGER, 0, 2), MARKER(INTEGER, 0, 4), MARKER(INTEGER, 0, 8),
+    MARKER(BYTES, 0, 1), MARKER(BYTES, 0, 2), MARKER(BYTES, 0, 4), MARKER(RESERVED, 0, 0),
+    MARKER(STRING, 0, 1), MARKER(STRING, 0, 2), MARKER(STRING, 0, 4), MARKER(RESERVED, 0, 0),  // 0xD0..0xD3
+    MARKER(LIST, 0, 1), MARKER(LIST, 0, 2), MARKER(LIST, 0, 4), MARKER(RESERVED, 0, 0),
+    MARKER(MAP, 0, 1), MARKER(MAP, 0, 2), MARKER(MAP, 0, 4), MARKER(RESERVED, 0, 0),
+    MARKER(STRUCTURE, 0, 1), MARKER(STRUCTURE, 0, 2), MARKER(RESERVED, 0, 0), MARKER(RESERVED, 0, 0),
+    MARKER_ROW(RESERVED),                                                                   // 0xE0..0xEF
+    MARKER_ROW(INTEGER),                                                                    // 0xF0..0xFF
+};
+
 enum BoltProtocolV1Type marker_type(uint8_t marker)
 {
-    if (marker < 0x80 || (marker >= 0xC8 && marker <= 0xCB) || marker >= 0xF0)
-    {
-        return BOLT_V1_INTEGER;
-    }
-    if ((marker >= 0x80 && marker <= 0x8F) || (marker >= 0xD0 && marker <= 0xD2))
-    {
-        return BOLT_V1_STRING;
-    }
-    if ((marker >= 0x90 && marker <= 0x9F) || (marker >= 0xD4 && marker <= 0xD6))
-    {
-        return BOLT_V1_LIST;
-    }
-    if ((marker >= 0xA0 && marker <= 0xAF) || (marker >= 0xD8 && marker <= 0xDA))
-    {
-        return BOLT_V1_MAP;
-    }
-    if ((marker >= 0xB0 && marker <= 0xBF) || (marker >= 0xDC && marker <= 0xDD))
+    return (enum BoltProtocolV1Type)(MARKERS[marker].type);
+}
+
+/**
+ * Validate the structure of a whole message before any of it is decoded.
+ * Every marker is checked to be known, and every size checked against
+ * the bytes that remain, counting each value still to be read within a
+ * container as taking at least one byte. A message that passes can then
+ * be decoded without checking the bounds of each individual read.
+ *
+ * @param buffer buffer holding exactly one message, from its cursor
+ * @return 0 if the message is well-formed, -1 otherwise
+ */
+int validate_message(struct BoltBuffer * buffer)
+{
+    const uint8_t* data = (const uint8_t*)(&buffer->data[buffer->cursor]);
+    const uint8_t* end = data + BoltBuffer_unloadable(buffer);
+    int64_t pending = 1;
+    while (pending > 0)
     {
-        return BOLT_V1_STRUCTURE;
+        if (data == end)
+        {
+            return -1;
+        }
+        uint8_t marker = *data++;
+        pending -= 1;
+        if (marker < 0x80 || marker >= 0xF0)
+        {
+            // Tiny integer
+            continue;
+        }
+        const struct _marker* m = &MARKERS[marker];
+        if (m->type == BOLT_V1_RESERVED || m->width > end - data)
+        {
+            return -1;
+        }
+        if (m->type == BOLT_V1_INTEGER || m->type == BOLT_V1_FLOAT)
+        {
+            data += m->width;
+            continue;
+        }
+        int64_t size = m->size;
+        if (m->width > 0)
+        {
+            size = 0;
+            for (int i = 0; i < m->width; i++)
+            {
+                size = (size << 8) | data[i];
+            }
+            data += m->width;
+            if (size > INT32_MAX)
+            {
+                return -1;
+            }
+        }
+        switch (m->type)
+        {
+            case BOLT_V1_STRING:
+            case BOLT_V1_BYTES:
+                if (size > end - data)
+                {
+                    return -1;
+                }
+                data += size;
+                continue;
+            case BOLT_V1_LIST:
+                pending += size;
+                break;
+            case BOLT_V1_MAP:
+                pending += 2 * size;
+                break;
+            case BOLT_V1_STRUCTURE:
+                if (data == end)
+                {
+                    return -1;
+                }
+                data += 1;
+                pending += size;
+                break;
+            default:
+                continue;
+        }
+        if (pending > end - data)
+        {
+            return -1;
+        }
     }
-    switch(marker)
+    return data == end ? 0 : -1;
+}
+
+// The following read directly from a message that has already been
+// validated, without checking bounds.
+
+uint8_t take_uint8(struct BoltBuffer * buffer)
+{
+    return (uint8_t)(buffer->data[buffer->cursor++]);
+}
+
+uint64_t take_uint_be(struct BoltBuffer * buffer, int width)
+{
+    uint64_t x = 0;
+    for (int i = 0; i < width; i++)
     {
-        case 0xC0:
-            return BOLT_V1_NULL;
-        case 0xC1:
-            return BOLT_V1_FLOAT;
-        case 0xC2:
-        case 0xC3:
-            return BOLT_V1_BOOLEAN;
-        case 0xCC:
-        case 0xCD:
-        case 0xCE:
-            return BOLT_V1_BYTES;
-        default:
-            return BOLT_V1_RESERVED;
+        x = (x << 8) | (uint8_t)(buffer->data[buffer->cursor++]);
     }
+    return x;
+}
+
+double take_double_be(struct BoltBuffer * buffer)
+{
+    uint64_t bits = take_uint_be(buffer, 8);
+    double x;
+    memcpy(&x, &bits, sizeof(x));
+    return x;
+}
+
+const char* take_bytes(struct BoltBuffer * buffer, int32_t size)
+{
+    const char* data = &buffer->data[buffer->cursor];
+    buffer->cursor += size;
+    return data;
 }
 
 int load(struct BoltBuffer * buffer, struct BoltValue * value);
@@ -383,15 +672,72 @@ int load_structure_header(struct BoltBuffer * buffer, int16_t code, int8_t size)
     return 0;
 }
 
-int load_message(struct BoltConnection * connection, struct BoltValue * value)
+int load_message_body(struct BoltBuffer * buffer, struct BoltValue * value)
 {
     assert(BoltValue_type(value) == BOLT_MESSAGE);
-    struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
-    try(load_structure_header(state->tx_buffer, BoltMessage_code(value), value->size));
+    try(load_structure_header(buffer, BoltMessage_code(value), value->size));
     for (int32_t i = 0; i < value->size; i++)
     {
-        try(load(state->tx_buffer, BoltMessage_value(value, i)));
+        try(load(buffer, BoltMessage_value(value, i)));
+    }
+    return 0;
+}
+
+int load_message(struct BoltConnection * connection, struct BoltValue * value)
+{
+    struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
+    try(load_message_body(state->tx_buffer, value));
+    enqueue(connection);
+    return 0;
+}
+
+/**
+ * Encode a message once, so that it can later be queued repeatedly by
+ * copying bytes rather than by walking its value tree.
+ *
+ * @param value
+ * @return a new buffer holding the encoded message
+ */
+struct BoltBuffer* encode_message(struct BoltValue * value)
+{
+    struct BoltBuffer* encoded = BoltBuffer_create(16);
+    load_message_body(encoded, value);
+    return encoded;
+}
+
+/**
+ * Check that a message can be loaded. This is not the case while a RUN
+ * request is being streamed or written, as its body is still incomplete
+ * in the transmit buffer.
+ *
+ * @param connection
+ * @return 0 if a message can be loaded, -1 otherwise
+ */
+int check_loadable(struct BoltConnection * connection)
+{
+    struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
+    if (state->stream_remaining >= 0 || state->writer.open)
+    {
+        BoltLog_error("bolt: Cannot load a message while a RUN request is open");
+        return -1;
     }
+    return 0;
+}
+
+/**
+ * Queue a message from its pre-encoded form. The message value itself
+ * is only used for logging.
+ *
+ * @param connection
+ * @param value
+ * @param encoded
+ * @return
+ */
+int load_encoded_message(struct BoltConnection * connection, struct BoltValue * value, struct BoltBuffer * encoded)
+{
+    struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
+    BoltLog_message("C", state->next_request_id, value, connection->protocol_version);
+    BoltBuffer_load(state->tx_buffer, encoded->data, encoded->extent);
     enqueue(connection);
     return 0;
 }
@@ -399,12 +745,14 @@ int load_message(struct BoltConnection * connection, struct BoltValue * value)
 int BoltProtocolV1_load_message(struct BoltConnection * connection, struct BoltValue * value)
 {
     struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
+    try(check_loadable(connection));
     BoltLog_message("C", state->next_request_id, value, connection->protocol_version);
     return load_message(connection, value);
 }
 
 int BoltProtocolV1_load_message_quietly(struct BoltConnection * connection, struct BoltValue * value)
 {
+    try(check_loadable(connection));
     return load_message(connection, value);
 }
 
@@ -437,9 +785,11 @@ int load(struct BoltBuffer * buffer, struct BoltValue * value)
         case BOLT_BIT_ARRAY:
         {
             try(load_list_header(buffer, value->size));
+            const uint64_t* words = BoltBitArray_get_all(value);
+            char* target = BoltBuffer_load_target(buffer, value->size);
             for (int32_t i = 0; i < value->size; i++)
             {
-                try(load_boolean(buffer, BoltBitArray_get(value, i)));
+                target[i] = (char)(0xC2 | ((words[i / 64] >> (i % 64)) & 1));
             }
             return 0;
         }
@@ -510,6 +860,54 @@ int load(struct BoltBuffer * buffer, struct BoltValue * value)
             }
             return 0;
         }
+        case BOLT_POINT:
+        {
+            const double * coordinates = BoltPoint_coordinates(value);
+            try(load_structure_header(buffer, value->size == 2 ? 'X' : 'Y', (int8_t)(value->size + 1)));
+            try(load_integer(buffer, BoltPoint_srid(value)));
+            for (int32_t i = 0; i < value->size; i++)
+            {
+                try(load_float(buffer, coordinates[i]));
+            }
+            return 0;
+        }
+        case BOLT_DATE:
+            try(load_structure_header(buffer, 'D', 1));
+            return load_integer(buffer, BoltDate_get(value));
+        case BOLT_TIME:
+        {
+            struct BoltTime time = BoltTime_get(value);
+            try(load_structure_header(buffer, 'T', 2));
+            try(load_integer(buffer, time.nanoseconds));
+            return load_integer(buffer, time.tz_offset_seconds);
+        }
+        case BOLT_LOCAL_TIME:
+            try(load_structure_header(buffer, 't', 1));
+            return load_integer(buffer, BoltLocalTime_get(value));
+        case BOLT_DATE_TIME:
+        {
+            struct BoltDateTime date_time = BoltDateTime_get(value);
+            try(load_structure_header(buffer, 'F', 3));
+            try(load_integer(buffer, date_time.seconds));
+            try(load_integer(buffer, date_time.nanoseconds));
+            return load_integer(buffer, date_time.tz_offset_seconds);
+        }
+        case BOLT_LOCAL_DATE_TIME:
+        {
+            struct BoltLocalDateTime date_time = BoltLocalDateTime_get(value);
+            try(load_structure_header(buffer, 'd', 2));
+            try(load_integer(buffer, date_time.seconds));
+            return load_integer(buffer, date_time.nanoseconds);
+        }
+        case BOLT_DURATION:
+        {
+            struct BoltDuration duration = BoltDuration_get(value);
+            try(load_structure_header(buffer, 'E', 4));
+            try(load_integer(buffer, duration.months));
+            try(load_integer(buffer, duration.days));
+            try(load_integer(buffer, duration.seconds));
+            return load_integer(buffer, duration.nanoseconds);
+        }
         case BOLT_STRUCTURE:
         {
             try(load_structure_header(buffer, BoltStructure_code(value), value->size));
@@ -533,698 +931,3094 @@ int load(struct BoltBuffer * buffer, struct BoltValue * value)
 }
 
 /**
- * Copy request data from buffer 1 to buffer 0, also adding chunks.
+ * Move the message body held in the protocol tx_buffer into the
+ * connection tx_buffer, split into chunks of at most MAX_CHUNK_SIZE
+ * bytes. Unless `final` is set, only full-size chunks are moved and any
+ * remainder is held back until more of the message has been loaded;
+ * otherwise everything is moved and the message is terminated.
  *
  * @param connection
- * @return request ID
+ * @param final
  */
-void enqueue(struct BoltConnection * connection)
+void load_chunks(struct BoltConnection * connection, int final)
 {
-    // TODO: more chunks if size is too big
     struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
     int size = BoltBuffer_unloadable(state->tx_buffer);
     char header[2];
-    header[0] = (char)(size >> 8);
-    header[1] = (char)(size);
-    BoltBuffer_load(connection->tx_buffer, &header[0], sizeof(header));
-    BoltBuffer_load(connection->tx_buffer, BoltBuffer_unload_target(state->tx_buffer, size), size);
-    header[0] = (char)(0);
-    header[1] = (char)(0);
-    BoltBuffer_load(connection->tx_buffer, &header[0], sizeof(header));
+    while (size >= MAX_CHUNK_SIZE || (final && size > 0))
+    {
+        int chunk_size = size > MAX_CHUNK_SIZE ? MAX_CHUNK_SIZE : size;
+        header[0] = (char)(chunk_size >> 8);
+        header[1] = (char)(chunk_size);
+        BoltBuffer_load(connection->tx_buffer, &header[0], sizeof(header));
+        BoltBuffer_load(connection->tx_buffer, BoltBuffer_unload_target(state->tx_buffer, chunk_size), chunk_size);
+        size -= chunk_size;
+    }
+    if (final)
+    {
+        header[0] = (char)(0);
+        header[1] = (char)(0);
+        BoltBuffer_load(connection->tx_buffer, &header[0], sizeof(header));
+    }
     BoltBuffer_compact(state->tx_buffer);
+}
+
+void enqueue(struct BoltConnection * connection)
+{
+    struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
+    load_chunks(connection, 1);
     state->next_request_id += 1;
 }
 
 int unload(struct BoltConnection * connection, struct BoltValue * value);
 
-int unload_null(struct BoltConnection * connection, struct BoltValue * value)
+/**
+ * Unload the size that follows a string, bytes, list, map or structure
+ * marker. Tiny sizes are held within the marker itself; otherwise the two
+ * low bits of the marker select an 8-, 16- or 32-bit size field.
+ *
+ * @param connection
+ * @param marker
+ * @param size
+ * @return
+ */
+int unload_size(struct BoltConnection * connection, uint8_t marker, int32_t * size)
 {
     struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
-    uint8_t marker;
-    BoltBuffer_unload_uint8(state->rx_buffer, &marker);
-    if (marker == 0xC0)
+    if (MARKERS[marker].width == 0)
     {
-        BoltValue_to_Null(value);
+        *size = MARKERS[marker].size;
     }
     else
     {
-        return -1;  // BOLT_ERROR_WRONG_TYPE
+        *size = (int32_t)(take_uint_be(state->rx_message, MARKERS[marker].width));
     }
     return 0;
 }
 
-int unload_boolean(struct BoltConnection * connection, struct BoltValue * value)
+/**
+ * Unload the value of an integer, given its marker. Tiny integers are
+ * held within the marker itself; otherwise the value follows the marker.
+ *
+ * @param connection
+ * @param marker
+ * @param x
+ * @return
+ */
+int unload_integer_value(struct BoltConnection * connection, uint8_t marker, int64_t * x)
 {
     struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
-    uint8_t marker;
-    BoltBuffer_unload_uint8(state->rx_buffer, &marker);
-    if (marker == 0xC3)
+    switch (MARKERS[marker].width)
     {
-        BoltValue_to_Bit(value, 1);
+        case 0:
+            *x = (int8_t)(marker);
+            return 0;
+        case 1:
+            *x = (int8_t)(take_uint8(state->rx_message));
+            return 0;
+        case 2:
+            *x = (int16_t)(take_uint_be(state->rx_message, 2));
+            return 0;
+        case 4:
+            *x = (int32_t)(take_uint_be(state->rx_message, 4));
+            return 0;
+        default:
+            *x = (int64_t)(take_uint_be(state->rx_message, 8));
+            return 0;
     }
-    else if (marker == 0xC2)
+}
+
+int skip_bytes(struct BoltConnection * connection, int32_t size)
+{
+    struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
+    take_bytes(state->rx_message, size);
+    return 0;
+}
+
+/**
+ * Skip over the next value without decoding it.
+ *
+ * @param connection
+ * @return
+ */
+int skip(struct BoltConnection * connection)
+{
+    struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
+    uint8_t marker;
+    int32_t size;
+    marker = take_uint8(state->rx_message);
+    switch (marker_type(marker))
     {
-        BoltValue_to_Bit(value, 0);
+        case BOLT_V1_NULL:
+        case BOLT_V1_BOOLEAN:
+            return 0;
+        case BOLT_V1_INTEGER:
+        case BOLT_V1_FLOAT:
+            return skip_bytes(connection, MARKERS[marker].width);
+        case BOLT_V1_STRING:
+        case BOLT_V1_BYTES:
+            try(unload_size(connection, marker, &size));
+            return skip_bytes(connection, size);
+        case BOLT_V1_LIST:
+            try(unload_size(connection, marker, &size));
+            for (int32_t i = 0; i < size; i++)
+            {
+                try(skip(connection));
+            }
+            return 0;
+        case BOLT_V1_MAP:
+            try(unload_size(connection, marker, &size));
+            for (int32_t i = 0; i < 2 * size; i++)
+            {
+                try(skip(connection));
+            }
+            return 0;
+        case BOLT_V1_STRUCTURE:
+            try(unload_size(connection, marker, &size));
+            try(skip_bytes(connection, 1));
+            for (int32_t i = 0; i < size; i++)
+            {
+                try(skip(connection));
+            }
+            return 0;
+        default:
+            return -1;
     }
-    else
+}
+
+int unload_int64(struct BoltConnection * connection, int64_t * x)
+{
+    struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
+    uint8_t marker;
+    marker = take_uint8(state->rx_message);
+    if (MARKERS[marker].type != BOLT_V1_INTEGER)
     {
         return -1;  // BOLT_ERROR_WRONG_TYPE
     }
-    return 0;
+    return unload_integer_value(connection, marker, x);
 }
 
-int unload_integer(struct BoltConnection * connection, struct BoltValue * value)
+int unload_double(struct BoltConnection * connection, double * x)
 {
     struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
     uint8_t marker;
-    BoltBuffer_unload_uint8(state->rx_buffer, &marker);
-    if (marker < 0x80)
+    marker = take_uint8(state->rx_message);
+    if (marker == 0xC1)
     {
-        BoltValue_to_Int64(value, marker);
+        *x = take_double_be(state->rx_message);
     }
-    else if (marker >= 0xF0)
+    else
     {
-        BoltValue_to_Int64(value, marker - 0x100);
+        return -1;  // BOLT_ERROR_WRONG_TYPE
     }
-    else if (marker == 0xC8)
+    return 0;
+}
+
+int is_entity(int8_t code, int32_t size)
+{
+    switch (code)
     {
-        int8_t x;
-        BoltBuffer_unload_int8(state->rx_buffer, &x);
-        BoltValue_to_Int64(value, x);
+        case 'N':
+        case 'r':
+            return size == 3;
+        case 'R':
+            return size == 5;
+        default:
+            return 0;
     }
-    else if (marker == 0xC9)
-    {
-        int16_t x;
-        BoltBuffer_unload_int16_be(state->rx_buffer, &x);
-        BoltValue_to_Int64(value, x);
-    }
-    else if (marker == 0xCA)
-    {
-        int32_t x;
-        BoltBuffer_unload_int32_be(state->rx_buffer, &x);
-        BoltValue_to_Int64(value, x);
-    }
-    else if (marker == 0xCB)
-    {
-        int64_t x;
-        BoltBuffer_unload_int64_be(state->rx_buffer, &x);
-        BoltValue_to_Int64(value, x);
-    }
-    else
-    {
-        return -1;  // BOLT_ERROR_WRONG_TYPE
-    }
-    return 0;
 }
 
-int unload_float(struct BoltConnection * connection, struct BoltValue * value)
+/**
+ * Unload a node or relationship through the entity cache. The identity
+ * is decoded first; if the entity has already been received as part of
+ * the current result, the remaining fields are skipped over and the
+ * cached entity is shared instead. New entities are only cached once all
+ * of their fields have been decoded.
+ *
+ * @param connection
+ * @param value
+ * @param code
+ * @param size
+ * @return
+ */
+int unload_entity(struct BoltConnection * connection, struct BoltValue * value, int8_t code, int32_t size)
 {
     struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
-    uint8_t marker;
-    BoltBuffer_unload_uint8(state->rx_buffer, &marker);
-    if (marker == 0xC1)
+    int64_t id;
+    try(unload_int64(connection, &id));
+    struct BoltSharedValue * entity = BoltEntityCache_get(state->entity_cache, code, id);
+    if (entity == NULL)
     {
-        double x;
-        BoltBuffer_unload_double_be(state->rx_buffer, &x);
-        BoltValue_to_Float64(value, x);
+        entity = BoltSharedValue_create();
+        BoltValue_to_Structure(&entity->value, code, size);
+        BoltValue_to_Int64(BoltStructure_value(&entity->value, 0), id);
+        // Cached entities outlive the message, so cannot hold views of it
+        int string_views = state->rx_string_views;
+        state->rx_string_views = 0;
+        int status = 0;
+        for (int i = 1; status == 0 && i < size; i++)
+        {
+            status = unload(connection, BoltStructure_value(&entity->value, i));
+        }
+        state->rx_string_views = string_views;
+        if (status == -1)
+        {
+            BoltSharedValue_release(entity);
+            return -1;
+        }
+        BoltEntityCache_put(state->entity_cache, code, id, entity);
     }
     else
     {
-        return -1;  // BOLT_ERROR_WRONG_TYPE
+        for (int i = 1; i < size; i++)
+        {
+            try(skip(connection));
+        }
     }
+    BoltValue_borrow(value, entity);
     return 0;
 }
 
-int unload_string(struct BoltConnection * connection, struct BoltValue * value)
+int is_point(int8_t code, int32_t size)
 {
-    struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
-    uint8_t marker;
-    BoltBuffer_unload_uint8(state->rx_buffer, &marker);
-    if (marker >= 0x80 && marker <= 0x8F)
+    return (code == 'X' && size == 3) || (code == 'Y' && size == 4);
+}
+
+int is_temporal(int8_t code, int32_t size)
+{
+    switch (code)
     {
-        int32_t size;
-        size = marker & 0x0F;
-        BoltValue_to_String(value, NULL, size);
-        BoltBuffer_unload(state->rx_buffer, BoltString_get(value), size);
-        return 0;
+        case 'D':
+        case 't':
+            return size == 1;
+        case 'T':
+        case 'd':
+            return size == 2;
+        case 'F':
+            return size == 3;
+        case 'E':
+            return size == 4;
+        default:
+            return 0;
     }
-    if (marker == 0xD0)
+}
+
+int fits_int32(int64_t x)
+{
+    return x >= INT32_MIN && x <= INT32_MAX;
+}
+
+/**
+ * Unload a Point2D or Point3D structure (Bolt v2) into a `BOLT_POINT`.
+ * If the SRID cannot be held in the subtype, the point is left as a
+ * generic structure instead.
+ *
+ * @param connection
+ * @param value
+ * @param code
+ * @param size
+ * @return
+ */
+int unload_point(struct BoltConnection * connection, struct BoltValue * value, int8_t code, int32_t size)
+{
+    int64_t srid;
+    double coordinates[3];
+    int32_t dimensions = size - 1;
+    try(unload_int64(connection, &srid));
+    for (int32_t i = 0; i < dimensions; i++)
     {
-        uint8_t size;
-        BoltBuffer_unload_uint8(state->rx_buffer, &size);
-        BoltValue_to_String(value, NULL, size);
-        BoltBuffer_unload(state->rx_buffer, BoltString_get(value), size);
-        return 0;
+        try(unload_double(connection, &coordinates[i]));
     }
-    if (marker == 0xD1)
+    if (srid >= INT16_MIN && srid <= INT16_MAX)
     {
-        uint16_t size;
-        BoltBuffer_unload_uint16_be(state->rx_buffer, &size);
-        BoltValue_to_String(value, NULL, size);
-        BoltBuffer_unload(state->rx_buffer, BoltString_get(value), size);
+        BoltValue_to_Point(value, (int16_t)(srid), coordinates, dimensions);
         return 0;
     }
-    if (marker == 0xD2)
+    BoltValue_to_Structure(value, code, size);
+    BoltValue_to_Int64(BoltStructure_value(value, 0), srid);
+    for (int32_t i = 0; i < dimensions; i++)
     {
-        int32_t size;
-        BoltBuffer_unload_int32_be(state->rx_buffer, &size);
-        BoltValue_to_String(value, NULL, size);
-        BoltBuffer_unload(state->rx_buffer, BoltString_get(value), size);
-        return 0;
+        BoltValue_to_Float64(BoltStructure_value(value, i + 1), coordinates[i]);
     }
-    BoltLog_error("bolt: Unknown marker: %d", marker);
-    return -1;  // BOLT_ERROR_WRONG_TYPE
+    return 0;
 }
 
-int unload_bytes(struct BoltConnection * connection, struct BoltValue * value)
+/**
+ * Unload a temporal structure (Bolt v2) into the corresponding compact
+ * type. Fields that cannot be held in the compact form cause the value
+ * to be left as a generic structure instead.
+ *
+ * @param connection
+ * @param value
+ * @param code
+ * @param size
+ * @return
+ */
+int unload_temporal(struct BoltConnection * connection, struct BoltValue * value, int8_t code, int32_t size)
 {
-    struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
-    uint8_t marker;
-    BoltBuffer_unload_uint8(state->rx_buffer, &marker);
-    if (marker == 0xCC)
+    int64_t x[4];
+    for (int32_t i = 0; i < size; i++)
     {
-        uint8_t size;
-        BoltBuffer_unload_uint8(state->rx_buffer, &size);
-        BoltValue_to_ByteArray(value, NULL, size);
-        BoltBuffer_unload(state->rx_buffer, BoltByteArray_get_all(value), size);
-        return 0;
+        try(unload_int64(connection, &x[i]));
     }
-    if (marker == 0xCD)
+    switch (code)
     {
-        uint16_t size;
-        BoltBuffer_unload_uint16_be(state->rx_buffer, &size);
-        BoltValue_to_ByteArray(value, NULL, size);
-        BoltBuffer_unload(state->rx_buffer, BoltByteArray_get_all(value), size);
-        return 0;
+        case 'D':
+            BoltValue_to_Date(value, x[0]);
+            return 0;
+        case 't':
+            BoltValue_to_LocalTime(value, x[0]);
+            return 0;
+        case 'T':
+            if (fits_int32(x[1]))
+            {
+                BoltValue_to_Time(value, x[0], (int32_t)(x[1]));
+                return 0;
+            }
+            break;
+        case 'd':
+            if (fits_int32(x[1]))
+            {
+                BoltValue_to_LocalDateTime(value, x[0], (int32_t)(x[1]));
+                return 0;
+            }
+            break;
+        case 'F':
+            if (fits_int32(x[1]) && fits_int32(x[2]))
+            {
+                BoltValue_to_DateTime(value, x[0], (int32_t)(x[1]), (int32_t)(x[2]));
+                return 0;
+            }
+            break;
+        case 'E':
+            if (fits_int32(x[3]))
+            {
+                BoltValue_to_Duration(value, x[0], x[1], x[2], (int32_t)(x[3]));
+                return 0;
+            }
+            break;
+        default:
+            break;
     }
-    if (marker == 0xCE)
+    BoltValue_to_Structure(value, code, size);
+    for (int32_t i = 0; i < size; i++)
     {
-        int32_t size;
-        BoltBuffer_unload_int32_be(state->rx_buffer, &size);
-        BoltValue_to_ByteArray(value, NULL, size);
-        BoltBuffer_unload(state->rx_buffer, BoltByteArray_get_all(value), size);
-        return 0;
+        BoltValue_to_Int64(BoltStructure_value(value, i), x[i]);
     }
-    BoltLog_error("bolt: Unknown marker: %d", marker);
-    return -1;  // BOLT_ERROR_WRONG_TYPE
+    return 0;
 }
 
-int unload_list(struct BoltConnection * connection, struct BoltValue * value)
+/**
+ * Unload the fields of a path into a compact form. Nodes and
+ * relationships are held in lists as usual, but the index sequence is
+ * held in a single `BOLT_INT32_ARRAY` rather than as a list of integer
+ * values. The sequence is validated against the node and relationship
+ * lists so that the `BoltPath_*` accessors need not check it again.
+ *
+ * @param connection
+ * @param value
+ * @return
+ */
+int unload_path(struct BoltConnection * connection, struct BoltValue * value)
 {
     struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
+    BoltValue_to_Structure(value, 'P', 3);
+    struct BoltValue* nodes = BoltStructure_value(value, 0);
+    struct BoltValue* relationships = BoltStructure_value(value, 1);
+    struct BoltValue* sequence = BoltStructure_value(value, 2);
+    try(unload(connection, nodes));
+    try(unload(connection, relationships));
+    if (BoltValue_type(nodes) != BOLT_LIST || BoltValue_type(relationships) != BOLT_LIST || nodes->size == 0)
+    {
+        return -1;  // BOLT_ERROR_WRONG_TYPE
+    }
     uint8_t marker;
     int32_t size;
-    BoltBuffer_unload_uint8(state->rx_buffer, &marker);
-    if (marker >= 0x90 && marker <= 0x9F)
+    marker = take_uint8(state->rx_message);
+    if (marker_type(marker) != BOLT_V1_LIST)
     {
-        size = marker & 0x0F;
+        return -1;  // BOLT_ERROR_WRONG_TYPE
     }
-    else if (marker == 0xD4)
+    try(unload_size(connection, marker, &size));
+    if (size < 0 || size % 2 != 0)
     {
-        uint8_t size_;
-        BoltBuffer_unload_uint8(state->rx_buffer, &size_);
-        size = size_;
+        return -1;  // invalid size
     }
-    else if (marker == 0xD5)
+    BoltValue_to_Int32Array(sequence, NULL, size);
+    int32_t* indexes = BoltInt32Array_get_all(sequence);
+    int valid = 1;
+    for (int32_t i = 0; i < size; i++)
     {
-        uint16_t size_;
-        BoltBuffer_unload_uint16_be(state->rx_buffer, &size_);
-        size = size_;
+        int64_t x;
+        try(unload_int64(connection, &x));
+        int64_t limit = i % 2 == 0 ? relationships->size : nodes->size - 1;
+        if (i % 2 == 0 ? (x == 0 || x > limit || x < -limit) : (x < 0 || x > limit))
+        {
+            valid = 0;
+            x = 0;
+        }
+        indexes[i] = (int32_t)(x);
     }
-    else if (marker == 0xD6)
+    if (!valid)
     {
-        int32_t size_;
-        BoltBuffer_unload_int32_be(state->rx_buffer, &size_);
-        size = size_;
+        // Never hand out a path that the accessors cannot safely resolve.
+        BoltValue_to_Null(value);
+        return -1;  // index out of range
     }
-    else
+    return 0;
+}
+
+int unload_structure(struct BoltConnection * connection, struct BoltValue * value, int8_t code, int32_t size)
+{
+    struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
+    if (state->entity_cache != NULL && is_entity(code, size))
     {
-        return -1;  // BOLT_ERROR_WRONG_TYPE
+        return unload_entity(connection, value, code, size);
     }
-    if (size < 0)
+    if (code == 'P' && size == 3)
     {
-        return -1;  // invalid size
+        return unload_path(connection, value);
     }
-    BoltValue_to_List(value, size);
+    if (connection->protocol_version >= 2 && is_point(code, size))
+    {
+        return unload_point(connection, value, code, size);
+    }
+    if (connection->protocol_version >= 2 && is_temporal(code, size))
+    {
+        return unload_temporal(connection, value, code, size);
+    }
+    BoltValue_to_Structure(value, code, size);
     for (int i = 0; i < size; i++)
     {
-        unload(connection, BoltList_value(value, i));
+        try(unload(connection, BoltStructure_value(value, i)));
     }
-    return size;
+    return 0;
 }
 
-int unload_map(struct BoltConnection * connection, struct BoltValue * value)
+/**
+ * Check whether the next list of the message holds booleans only, by
+ * looking ahead at the markers of its items. Booleans are single byte
+ * values, so the items are the next `size` bytes.
+ *
+ * @param connection
+ * @param size number of items in the list
+ * @return 1 if all items are booleans, 0 otherwise
+ */
+int is_bit_list(struct BoltConnection * connection, int32_t size)
 {
     struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
-    uint8_t marker;
-    int32_t size;
-    BoltBuffer_unload_uint8(state->rx_buffer, &marker);
-    if (marker >= 0xA0 && marker <= 0xAF)
+    // Messages are validated as a whole before decoding, so any list of
+    // `size` items spans at least `size` bytes
+    const uint8_t* markers = (const uint8_t*)(&state->rx_message->data[state->rx_message->cursor]);
+    if (size == 0)
     {
-        size = marker & 0x0F;
+        return 0;
     }
-    else if (marker == 0xD8)
+    for (int32_t i = 0; i < size; i++)
     {
-        uint8_t size_;
-        BoltBuffer_unload_uint8(state->rx_buffer, &size_);
-        size = size_;
+        if ((markers[i] & 0xFE) != 0xC2)
+        {
+            return 0;
+        }
     }
-    else if (marker == 0xD9)
+    return 1;
+}
+
+/**
+ * Unload a list of booleans, as checked by is_bit_list, into a packed
+ * bit array.
+ *
+ * @param connection
+ * @param value
+ * @param size number of items in the list
+ * @return
+ */
+int unload_bit_array(struct BoltConnection * connection, struct BoltValue * value, int32_t size)
+{
+    struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
+    const char* markers = take_bytes(state->rx_message, size);
+    BoltValue_to_PackedBitArray(value, NULL, size);
+    uint64_t* words = BoltBitArray_get_all(value);
+    for (int32_t i = 0; i < size; i++)
     {
-        uint16_t size_;
-        BoltBuffer_unload_uint16_be(state->rx_buffer, &size_);
-        size = size_;
+        words[i / 64] |= (uint64_t)(markers[i] & 0x01) << (i % 64);
     }
-    else if (marker == 0xDA)
+    return 0;
+}
+
+/**
+ * Unload a string of the given size, copying it or, while string views
+ * are enabled, viewing it where it lies in the message.
+ *
+ * @param connection
+ * @param value
+ * @param size
+ */
+void unload_string_value(struct BoltConnection * connection, struct BoltValue * value, int32_t size)
+{
+    struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
+    const char* data = take_bytes(state->rx_message, size);
+    if (state->rx_string_views)
     {
-        int32_t size_;
-        BoltBuffer_unload_int32_be(state->rx_buffer, &size_);
-        size = size_;
+        BoltValue_to_StringView(value, data, size);
     }
     else
     {
-        return -1;  // BOLT_ERROR_WRONG_TYPE
+        BoltValue_to_String(value, data, size);
     }
-    if (size < 0)
+}
+
+/**
+ * Unload a byte array of the given size, copying it or, while string
+ * views are enabled, viewing it where it lies in the message.
+ *
+ * @param connection
+ * @param value
+ * @param size
+ */
+void unload_bytes_value(struct BoltConnection * connection, struct BoltValue * value, int32_t size)
+{
+    struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
+    const char* data = take_bytes(state->rx_message, size);
+    if (state->rx_string_views)
     {
-        return -1;  // invalid size
+        BoltValue_to_ByteArrayView(value, data, size);
     }
-    BoltValue_to_Dictionary(value, size);
-    for (int i = 0; i < size; i++)
+    else
     {
-        unload(connection, BoltDictionary_key(value, i));
-        unload(connection, BoltDictionary_value(value, i));
+        BoltValue_to_ByteArray(value, (char*)(data), size);
     }
-    return size;
 }
 
-int unload_structure(struct BoltConnection * connection, struct BoltValue * value)
+/**
+ * Unload a map key. String keys are always copied, even while string
+ * views are enabled, as the keys of one record are compared against
+ * those of the next.
+ *
+ * @param connection
+ * @param key
+ * @return
+ */
+int unload_key(struct BoltConnection * connection, struct BoltValue * key)
 {
     struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
-    uint8_t marker;
-    int8_t code;
+    // Messages are validated as a whole before decoding
+    uint8_t marker = (uint8_t)(state->rx_message->data[state->rx_message->cursor]);
     int32_t size;
-    BoltBuffer_unload_uint8(state->rx_buffer, &marker);
-    if (marker >= 0xB0 && marker <= 0xBF)
+    if (MARKERS[marker].type != BOLT_V1_STRING)
     {
-        size = marker & 0x0F;
-        BoltBuffer_unload_int8(state->rx_buffer, &code);
-        BoltValue_to_Structure(value, code, size);
-        for (int i = 0; i < size; i++)
-        {
-            unload(connection, BoltStructure_value(value, i));
-        }
-        return 0;
+        return unload(connection, key);
     }
-    // TODO: bigger structures (that are never actually used)
-    return -1;  // BOLT_ERROR_WRONG_TYPE
+    take_uint8(state->rx_message);
+    try(unload_size(connection, marker, &size));
+    BoltValue_to_String(key, take_bytes(state->rx_message, size), size);
+    return 0;
 }
 
+/**
+ * Unload the next value. The marker is read exactly once and looked up
+ * in the marker table, which drives a single dispatch to the code for
+ * that type of value (via computed goto where supported).
+ *
+ * @param connection
+ * @param value
+ * @return
+ */
 int unload(struct BoltConnection * connection, struct BoltValue * value)
 {
     struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
     uint8_t marker;
-    BoltBuffer_peek_uint8(state->rx_buffer, &marker);
-    switch(marker_type(marker))
+    int32_t size;
+    marker = take_uint8(state->rx_message);
+#if defined(__GNUC__)
+    static void* const targets[] = {
+        [BOLT_V1_NULL] = &&on_null,
+        [BOLT_V1_BOOLEAN] = &&on_boolean,
+        [BOLT_V1_INTEGER] = &&on_integer,
+        [BOLT_V1_FLOAT] = &&on_float,
+        [BOLT_V1_STRING] = &&on_string,
+        [BOLT_V1_BYTES] = &&on_bytes,
+        [BOLT_V1_LIST] = &&on_list,
+        [BOLT_V1_MAP] = &&on_map,
+        [BOLT_V1_STRUCTURE] = &&on_structure,
+        [BOLT_V1_RESERVED] = &&on_reserved,
+    };
+    goto *targets[MARKERS[marker].type];
+#else
+    switch (MARKERS[marker].type)
     {
-        case BOLT_V1_NULL:
-            return unload_null(connection, value);
-        case BOLT_V1_BOOLEAN:
-            return unload_boolean(connection, value);
-        case BOLT_V1_INTEGER:
-            return unload_integer(connection, value);
-        case BOLT_V1_FLOAT:
-            return unload_float(connection, value);
-        case BOLT_V1_STRING:
-            return unload_string(connection, value);
-        case BOLT_V1_BYTES:
-            return unload_bytes(connection, value);
-        case BOLT_V1_LIST:
-            return unload_list(connection, value);
-        case BOLT_V1_MAP:
-            return unload_map(connection, value);
-        case BOLT_V1_STRUCTURE:
-            return unload_structure(connection, value);
-        default:
-            BoltLog_error("bolt: Unknown marker: %d", marker);
-            return -1;  // BOLT_UNSUPPORTED_MARKER
+        case BOLT_V1_NULL: goto on_null;
+        case BOLT_V1_BOOLEAN: goto on_boolean;
+        case BOLT_V1_INTEGER: goto on_integer;
+        case BOLT_V1_FLOAT: goto on_float;
+        case BOLT_V1_STRING: goto on_string;
+        case BOLT_V1_BYTES: goto on_bytes;
+        case BOLT_V1_LIST: goto on_list;
+        case BOLT_V1_MAP: goto on_map;
+        case BOLT_V1_STRUCTURE: goto on_structure;
+        default: goto on_reserved;
+    }
+#endif
+on_null:
+    BoltValue_to_Null(value);
+    return 0;
+on_boolean:
+    BoltValue_to_Bit(value, (char)(marker & 0x01));
+    return 0;
+on_integer:
+    {
+        int64_t x;
+        try(unload_integer_value(connection, marker, &x));
+        BoltValue_to_Int64(value, x);
+        return 0;
+    }
+on_float:
+    {
+        double x;
+        x = take_double_be(state->rx_message);
+        BoltValue_to_Float64(value, x);
+        return 0;
+    }
+on_string:
+    try(unload_size(connection, marker, &size));
+    unload_string_value(connection, value, size);
+    return 0;
+on_bytes:
+    try(unload_size(connection, marker, &size));
+    unload_bytes_value(connection, value, size);
+    return 0;
+on_list:
+    try(unload_size(connection, marker, &size));
+    if (is_bit_list(connection, size))
+    {
+        return unload_bit_array(connection, value, size);
+    }
+    BoltValue_to_List(value, size);
+    for (int32_t i = 0; i < size; i++)
+    {
+        try(unload(connection, BoltList_value(value, i)));
+    }
+    return 0;
+on_map:
+    try(unload_size(connection, marker, &size));
+    BoltValue_to_Dictionary(value, size);
+    for (int32_t i = 0; i < size; i++)
+    {
+        try(unload_key(connection, BoltDictionary_key(value, i)));
+        try(unload(connection, BoltDictionary_value(value, i)));
+    }
+    return 0;
+on_structure:
+    {
+        int8_t code;
+        try(unload_size(connection, marker, &size));
+        code = (int8_t)(take_uint8(state->rx_message));
+        return unload_structure(connection, value, code, size);
     }
+on_reserved:
+    BoltLog_error("bolt: Unknown marker: %d", marker);
+    return -1;  // BOLT_UNSUPPORTED_MARKER
 }
 
-int BoltProtocolV1_fetch_b(struct BoltConnection * connection, bolt_request_t request_id)
+/**
+ * Unload the next value into a value that is expected to have the same
+ * shape as it did for the previous record of the result. Records of a
+ * result generally share a layout, so the value tree of the first record
+ * serves as the prediction for the rest: lists and maps are decoded item
+ * by item into the slots already allocated, map keys are only rewritten
+ * if they differ from those held, and common scalars are decoded
+ * directly from their marker. Wherever the prediction does not hold, the
+ * value is reformatted, or unloaded as usual.
+ *
+ * @param connection
+ * @param value
+ * @return
+ */
+int unload_predicted(struct BoltConnection * connection, struct BoltValue * value)
 {
-    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
-    bolt_request_t response_id;
-    do
+    struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
+    // Messages are validated as a whole before decoding
+    uint8_t marker = (uint8_t)(state->rx_message->data[state->rx_message->cursor]);
+    int32_t size;
+    switch (MARKERS[marker].type)
     {
-        char header[2];
-        int fetched = BoltConnection_receive_b(connection, &header[0], 2);
-        if (fetched == -1)
+        case BOLT_V1_INTEGER:
         {
-            BoltLog_error("bolt: Could not fetch chunk header");
-            return -1;
+            int64_t x;
+            take_uint8(state->rx_message);
+            try(unload_integer_value(connection, marker, &x));
+            BoltValue_to_Int64(value, x);
+            return 0;
         }
-        uint16_t chunk_size = char_to_uint16be(header);
-        BoltBuffer_compact(state->rx_buffer);
-        while (chunk_size != 0)
+        case BOLT_V1_FLOAT:
         {
-            fetched = BoltConnection_receive_b(connection, BoltBuffer_load_target(state->rx_buffer, chunk_size),
-                                               chunk_size);
-            if (fetched == -1)
+            take_uint8(state->rx_message);
+            BoltValue_to_Float64(value, take_double_be(state->rx_message));
+            return 0;
+        }
+        case BOLT_V1_STRING:
+        {
+            take_uint8(state->rx_message);
+            try(unload_size(connection, marker, &size));
+            unload_string_value(connection, value, size);
+            return 0;
+        }
+        case BOLT_V1_LIST:
+        {
+            take_uint8(state->rx_message);
+            try(unload_size(connection, marker, &size));
+            if (is_bit_list(connection, size))
             {
-                BoltLog_error("bolt: Could not fetch chunk data");
-                return -1;
+                return unload_bit_array(connection, value, size);
             }
-            fetched = BoltConnection_receive_b(connection, &header[0], 2);
-            if (fetched == -1)
+            if (BoltValue_type(value) != BOLT_LIST || size != value->size)
             {
-                BoltLog_error("bolt: Could not fetch chunk header");
-                return -1;
+                BoltValue_to_List(value, size);
+            }
+            for (int32_t i = 0; i < size; i++)
+            {
+                try(unload_predicted(connection, BoltList_value(value, i)));
             }
-            chunk_size = char_to_uint16be(header);
+            return 0;
         }
-        response_id = state->response_counter;
-        BoltProtocolV1_unload(connection);
-        if (BoltValue_type(state->data) == BOLT_MESSAGE)
+        case BOLT_V1_MAP:
         {
-            state->response_counter += 1;
+            take_uint8(state->rx_message);
+            try(unload_size(connection, marker, &size));
+            if (BoltValue_type(value) != BOLT_DICTIONARY || size != value->size)
+            {
+                BoltValue_to_Dictionary(value, size);
+            }
+            for (int32_t i = 0; i < size; i++)
+            {
+                struct BoltValue* key = BoltDictionary_key(value, i);
+                uint8_t key_marker = (uint8_t)(state->rx_message->data[state->rx_message->cursor]);
+                if (MARKERS[key_marker].type != BOLT_V1_STRING)
+                {
+                    try(unload(connection, key));
+                }
+                else
+                {
+                    int32_t key_size;
+                    take_uint8(state->rx_message);
+                    try(unload_size(connection, key_marker, &key_size));
+                    const char* key_data = take_bytes(state->rx_message, key_size);
+                    if (BoltValue_type(key) != BOLT_STRING || key->size != key_size ||
+                        memcmp(BoltString_get(key), key_data, (size_t)(key_size)) != 0)
+                    {
+                        BoltValue_to_String(key, key_data, key_size);
+                    }
+                }
+                try(unload_predicted(connection, BoltDictionary_value(value, i)));
+            }
+            return 0;
         }
-    } while (response_id != request_id);
-    if (BoltValue_type(state->data) == BOLT_MESSAGE)
-    {
-        BoltProtocolV1_extract_metadata(connection, state->data);
-        return 0;
+        default:
+            return unload(connection, value);
     }
-    return 1;
 }
 
-int BoltProtocolV1_unload(struct BoltConnection* connection)
+/**
+ * Find the projection for a property key within a projection
+ * dictionary.
+ *
+ * @param projection
+ * @param key
+ * @param key_size
+ * @return the nested projection, or NULL if the key is not projected
+ */
+struct BoltValue* projection_get(struct BoltValue * projection, const char * key, int32_t key_size)
 {
-    struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
-    if (BoltBuffer_unloadable(state->rx_buffer) == 0)
+    for (int32_t i = 0; i < projection->size; i++)
     {
-        return 0;
-    }
-    uint8_t marker;
-    uint8_t code;
-    int32_t size;
-    BoltBuffer_unload_uint8(state->rx_buffer, &marker);
-    if (marker_type(marker) != BOLT_V1_STRUCTURE)
+        struct BoltValue* projected_key = BoltDictionary_key(projection, i);
+        if (projected_key->size == key_size && memcmp(BoltString_get(projected_key), key, (size_t)(key_size)) == 0)
+        {
+            return BoltDictionary_value(projection, i);
+        }
+    }
+    return NULL;
+}
+
+int unload_projected(struct BoltConnection * connection, struct BoltValue * value, struct BoltValue * projection);
+
+/**
+ * Unload a map of the given size, keeping only the projected keys. Keys
+ * are matched directly in the receive buffer, and the values of all
+ * other keys are skipped over without being decoded.
+ *
+ * @param connection
+ * @param value
+ * @param size
+ * @param projection
+ * @return
+ */
+int unload_projected_map(struct BoltConnection * connection, struct BoltValue * value, int32_t size,
+                         struct BoltValue * projection)
+{
+    struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
+    int32_t capacity = size < projection->size ? size : projection->size;
+    int32_t n = 0;
+    BoltValue_to_Dictionary(value, capacity);
+    for (int32_t i = 0; i < size; i++)
     {
-        return -1;
+        uint8_t marker;
+        int32_t key_size;
+        marker = take_uint8(state->rx_message);
+        if (MARKERS[marker].type != BOLT_V1_STRING)
+        {
+            return -1;
+        }
+        try(unload_size(connection, marker, &key_size));
+        const char* key = take_bytes(state->rx_message, key_size);
+        struct BoltValue* nested = n < capacity ? projection_get(projection, key, key_size) : NULL;
+        if (nested == NULL)
+        {
+            try(skip(connection));
+            continue;
+        }
+        BoltDictionary_set_key(value, n, key, (size_t)(key_size));
+        try(unload_projected(connection, BoltDictionary_value(value, n), nested));
+        n += 1;
     }
-    size = marker & 0x0F;
-    struct BoltValue* received = ((struct BoltProtocolV1State*)(connection->protocol_state))->data;
-    BoltBuffer_unload_uint8(state->rx_buffer, &code);
-    if (code == BOLT_V1_RECORD)
+    if (n < capacity)
     {
-        if (size >= 1)
+        BoltValue_to_Dictionary(value, n);
+    }
+    return 0;
+}
+
+/**
+ * Unload the next value according to a projection. A null projection
+ * skips the value entirely and a boolean projection unloads it in full.
+ * A dictionary projection is applied to maps and to the properties of
+ * nodes and relationships (within lists too); any other value is
+ * unloaded in full.
+ *
+ * @param connection
+ * @param value
+ * @param projection
+ * @return
+ */
+int unload_projected(struct BoltConnection * connection, struct BoltValue * value, struct BoltValue * projection)
+{
+    struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
+    switch (BoltValue_type(projection))
+    {
+        case BOLT_NULL:
+            BoltValue_to_Null(value);
+            return skip(connection);
+        case BOLT_DICTIONARY:
+            break;
+        default:
+            return unload(connection, value);
+    }
+    uint8_t marker;
+    int32_t size;
+    try(BoltBuffer_peek_uint8(state->rx_message, &marker));
+    switch (MARKERS[marker].type)
+    {
+        case BOLT_V1_MAP:
+        {
+            marker = take_uint8(state->rx_message);
+            try(unload_size(connection, marker, &size));
+            return unload_projected_map(connection, value, size, projection);
+        }
+        case BOLT_V1_LIST:
         {
-            unload(connection, received);
-            if (size > 1)
+            marker = take_uint8(state->rx_message);
+            try(unload_size(connection, marker, &size));
+            if (is_bit_list(connection, size))
             {
-                struct BoltValue* black_hole = BoltValue_create();
-                for (int i = 1; i < size; i++)
+                return unload_bit_array(connection, value, size);
+            }
+            BoltValue_to_List(value, size);
+            for (int32_t i = 0; i < size; i++)
+            {
+                try(unload_projected(connection, BoltList_value(value, i), projection));
+            }
+            return 0;
+        }
+        case BOLT_V1_STRUCTURE:
+        {
+            int8_t code;
+            marker = take_uint8(state->rx_message);
+            try(unload_size(connection, marker, &size));
+            code = (int8_t)(take_uint8(state->rx_message));
+            int32_t properties = ((code == 'N' || code == 'r') && size == 3) ? 2 : (code == 'R' && size == 5) ? 4 : -1;
+            if (properties == -1)
+            {
+                return unload_structure(connection, value, code, size);
+            }
+            BoltValue_to_Structure(value, code, size);
+            for (int32_t i = 0; i < size; i++)
+            {
+                if (i == properties)
+                {
+                    try(unload_projected(connection, BoltStructure_value(value, i), projection));
+                }
+                else
                 {
-                    unload(connection, black_hole);
+                    try(unload(connection, BoltStructure_value(value, i)));
                 }
-                BoltValue_destroy(black_hole);
             }
+            return 0;
+        }
+        default:
+            return unload(connection, value);
+    }
+}
+
+/**
+ * Unload the list of fields of a record according to the registered
+ * projection. Fields that are not projected are left as null.
+ *
+ * @param connection
+ * @param value
+ * @return
+ */
+int unload_projected_fields(struct BoltConnection * connection, struct BoltValue * value)
+{
+    struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
+    uint8_t marker;
+    int32_t size;
+    marker = take_uint8(state->rx_message);
+    if (MARKERS[marker].type != BOLT_V1_LIST)
+    {
+        return -1;
+    }
+    try(unload_size(connection, marker, &size));
+    BoltValue_to_List(value, size);
+    for (int32_t i = 0; i < size; i++)
+    {
+        struct BoltValue* field = BoltList_value(value, i);
+        if (i < state->projection->size)
+        {
+            try(unload_projected(connection, field, BoltList_value(state->projection, i)));
         }
         else
         {
-            BoltValue_to_Null(received);
+            BoltValue_to_Null(field);
+            try(skip(connection));
         }
-        if (state->record_counter < MAX_LOGGED_RECORDS)
+    }
+    return 0;
+}
+
+/**
+ * Discard the remainder of a message, chunk by chunk, without decoding
+ * it. The header of the current chunk has not yet been consumed.
+ *
+ * @param connection
+ * @return
+ */
+int skip_chunks_b(struct BoltConnection * connection)
+{
+    uint16_t chunk_size;
+    do
+    {
+        try(BoltConnection_buffer_b(connection, 2));
+        chunk_size = char_to_uint16be(&connection->rx_buffer->data[connection->rx_buffer->cursor]);
+        try(BoltConnection_buffer_b(connection, 2 + chunk_size));
+        BoltBuffer_unload_target(connection->rx_buffer, 2 + chunk_size);
+    } while (chunk_size != 0);
+    return 0;
+}
+
+/**
+ * Reassemble a message that spans several chunks into `state->rx_buffer`.
+ *
+ * @param connection
+ * @param chunk_size size of the first chunk, whose header is still unread
+ * @return 0 on success, -1 on error
+ */
+int reassemble_message_b(struct BoltConnection * connection, uint16_t chunk_size)
+{
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    char header[2];
+    BoltConnection_receive_b(connection, &header[0], 2);
+    BoltBuffer_compact(state->rx_buffer);
+    while (chunk_size != 0)
+    {
+        int fetched = BoltConnection_receive_b(connection, BoltBuffer_load_target(state->rx_buffer, chunk_size),
+                                               chunk_size);
+        if (fetched == -1)
         {
-            BoltLog_message("S", state->response_counter, state->data, connection->protocol_version);
+            BoltLog_error("bolt: Could not fetch chunk data");
+            return -1;
         }
-        state->record_counter += 1;
+        fetched = BoltConnection_receive_b(connection, &header[0], 2);
+        if (fetched == -1)
+        {
+            BoltLog_error("bolt: Could not fetch chunk header");
+            return -1;
+        }
+        chunk_size = char_to_uint16be(header);
     }
-    else /* Summary */
+    return 0;
+}
+
+#define UNLOAD_RECORDS 0
+#define SKIP_RECORDS 1
+#define VIEW_RECORDS 2
+
+// Summary flag of a held message that ends a window which could not be refilled
+#define HELD_WINDOW_SUMMARY 2
+
+/**
+ * Release a record left in place for a `BoltPackReader`, consuming it
+ * from whichever buffer it was read.
+ *
+ * @param connection
+ */
+void release_record_view(struct BoltConnection * connection)
+{
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    if (!state->rx_view)
     {
-        BoltValue_to_Message(received, code, size);
-        for (int i = 0; i < size; i++)
+        return;
+    }
+    if (state->rx_message == state->rx_buffer)
+    {
+        BoltBuffer_unload_target(state->rx_buffer, BoltBuffer_unloadable(state->rx_buffer));
+    }
+    if (state->rx_view_size > 0)
+    {
+        BoltBuffer_unload_target(connection->rx_buffer, state->rx_view_size);
+    }
+    state->rx_message = state->rx_buffer;
+    state->rx_view = 0;
+    state->rx_view_size = 0;
+}
+
+/**
+ * Validate a record held in `state->rx_message` and, if well-formed,
+ * leave it in place with the buffer positioned at its first field.
+ *
+ * @param connection
+ * @return 0 on success, -1 if the record is malformed
+ */
+int view_record(struct BoltConnection * connection)
+{
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    if (validate_message(state->rx_message) == -1)
+    {
+        BoltLog_error("bolt: Malformed record (%d bytes)", BoltBuffer_unloadable(state->rx_message));
+        connection->error = BOLT_PROTOCOL_VIOLATION;
+        return -1;
+    }
+    state->rx_message->cursor += 2;
+    state->rx_view = 1;
+    state->rx_view_size = 0;
+    return 0;
+}
+
+/**
+ * Receive the next message and unload it into `state->data`.
+ *
+ * With `SKIP_RECORDS`, RECORD messages are recognised by the structure
+ * marker and signature at the start of their first chunk and jumped over
+ * at chunk level, without any PackStream decoding. With `VIEW_RECORDS`,
+ * they are instead left undecoded in whichever buffer they were received
+ * into, with `state->rx_message` positioned at their first field, until
+ * released by `release_record_view`.
+ *
+ * @param connection
+ * @param records one of UNLOAD_RECORDS, SKIP_RECORDS or VIEW_RECORDS
+ * @return 2 if a record was left in place, 1 if a record was skipped,
+ *         0 if a message was unloaded, -1 on error
+ */
+int receive_message_b(struct BoltConnection * connection, int records)
+{
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    if (BoltConnection_buffer_b(connection, 2) == -1)
+    {
+        BoltLog_error("bolt: Could not fetch chunk header");
+        return -1;
+    }
+    uint16_t chunk_size = char_to_uint16be(&connection->rx_buffer->data[connection->rx_buffer->cursor]);
+    if (chunk_size != 0 && BoltConnection_buffer_b(connection, 2 + chunk_size + 2) == -1)
+    {
+        BoltLog_error("bolt: Could not fetch chunk data");
+        return -1;
+    }
+    const char* chunk = &connection->rx_buffer->data[connection->rx_buffer->cursor + 2];
+    int record = chunk_size >= 2 && marker_type((uint8_t)(chunk[0])) == BOLT_V1_STRUCTURE &&
+                 (uint8_t)(chunk[1]) == BOLT_V1_RECORD;
+    if (record && records == SKIP_RECORDS)
+    {
+        if (skip_chunks_b(connection) == -1)
         {
-            unload(connection, BoltMessage_value(received, i));
+            BoltLog_error("bolt: Could not fetch chunk data");
+            return -1;
         }
-        if (state->record_counter > MAX_LOGGED_RECORDS)
+        return 1;
+    }
+    // Most messages fit in a single chunk. These are decoded in place,
+    // directly from the connection receive buffer; only messages that
+    // span several chunks are reassembled into the protocol rx_buffer.
+    if (chunk_size != 0 && char_to_uint16be(&chunk[chunk_size]) == 0)
+    {
+        state->rx_window.data = &connection->rx_buffer->data[connection->rx_buffer->cursor + 2];
+        state->rx_window.size = chunk_size;
+        state->rx_window.extent = chunk_size;
+        state->rx_window.cursor = 0;
+        state->rx_message = &state->rx_window;
+        int status;
+        if (record && records == VIEW_RECORDS)
         {
-            BoltLog_info("bolt: S[%d]: Received %llu more records", state->response_counter, state->record_counter - MAX_LOGGED_RECORDS);
+            status = view_record(connection);
+            if (status == 0)
+            {
+                state->rx_view_size = 2 + chunk_size + 2;
+                return 2;
+            }
         }
-        state->record_counter = 0;
-        BoltLog_message("S", state->response_counter, received, connection->protocol_version);
+        else
+        {
+            // Decoded in place, so the message stays put until the next fetch
+            state->rx_string_views = state->string_views;
+            status = BoltProtocolV1_unload(connection);
+            state->rx_string_views = 0;
+        }
+        state->rx_message = state->rx_buffer;
+        BoltBuffer_unload_target(connection->rx_buffer, 2 + chunk_size + 2);
+        return status == -1 ? -1 : 0;
     }
-    return 1;
+    try(reassemble_message_b(connection, chunk_size));
+    int status = record && records == VIEW_RECORDS ? view_record(connection) : BoltProtocolV1_unload(connection);
+    if (status == -1)
+    {
+        // Discard whatever remains of a malformed message
+        BoltBuffer_unload_target(state->rx_buffer, BoltBuffer_unloadable(state->rx_buffer));
+        return -1;
+    }
+    return record && records == VIEW_RECORDS ? 2 : 0;
 }
 
-const char* BoltProtocolV1_structure_name(int16_t code)
+/**
+ * Start pulling the records of a request in windows.
+ *
+ * @param state
+ * @param request_id
+ */
+void open_window(struct BoltProtocolV1State * state, bolt_request_t request_id)
 {
-    switch(code)
+    if (state->n_windows == state->windows_capacity)
     {
-        case 'N':
-            return "Node";
-        case 'R':
-            return "Relationship";
-        case 'r':
-            return "UnboundRelationship";
-        case 'P':
-            return "Path";
-        default:
-            return "?";
+        int32_t capacity = state->windows_capacity == 0 ? 4 : 2 * state->windows_capacity;
+        state->windows = BoltMem_reallocate(state->windows, sizeof_n(bolt_request_t, state->windows_capacity),
+                                            sizeof_n(bolt_request_t, capacity));
+        state->windows_capacity = capacity;
+    }
+    state->windows[state->n_windows] = request_id;
+    state->n_windows += 1;
+}
+
+/**
+ * Determine whether the records of a response are being pulled in
+ * windows. Responses arrive in request order, so only the oldest window
+ * can be current.
+ *
+ * @param state
+ * @param response_id
+ * @return non-zero if windowed
+ */
+int is_window(struct BoltProtocolV1State * state, bolt_request_t response_id)
+{
+    return state->n_windows > 0 && state->windows[0] == response_id;
+}
+
+/**
+ * Stop pulling the records of the oldest windowed request.
+ *
+ * @param state
+ */
+void close_window(struct BoltProtocolV1State * state)
+{
+    state->n_windows -= 1;
+    memmove(&state->windows[0], &state->windows[1], sizeof_n(bolt_request_t, state->n_windows));
+}
+
+/**
+ * Receive the next message without decoding it, and hold it back in the
+ * response buffer for the request to which it responds.
+ *
+ * @param connection
+ * @param response_id
+ * @return 1 if a record was held, 0 if a summary was held, -1 on error
+ *         or if the response buffer is full
+ */
+int hold_message_b(struct BoltConnection * connection, bolt_request_t response_id)
+{
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    if (BoltResponseBuffer_full(state->responses))
+    {
+        BoltLog_error("bolt: Response buffer full (%zu bytes held)", state->responses->buffered_size);
+        connection->error = BOLT_RESPONSE_BUFFER_FULL;
+        return -1;
+    }
+    if (BoltConnection_buffer_b(connection, 2) == -1)
+    {
+        BoltLog_error("bolt: Could not fetch chunk header");
+        return -1;
+    }
+    uint16_t chunk_size = char_to_uint16be(&connection->rx_buffer->data[connection->rx_buffer->cursor]);
+    if (chunk_size != 0 && BoltConnection_buffer_b(connection, 2 + chunk_size + 2) == -1)
+    {
+        BoltLog_error("bolt: Could not fetch chunk data");
+        return -1;
+    }
+    char* data = &connection->rx_buffer->data[connection->rx_buffer->cursor + 2];
+    int32_t size = chunk_size;
+    int in_place = chunk_size != 0 && char_to_uint16be(&data[chunk_size]) == 0;
+    if (!in_place)
+    {
+        try(reassemble_message_b(connection, chunk_size));
+        size = BoltBuffer_unloadable(state->rx_buffer);
+        data = BoltBuffer_unload_target(state->rx_buffer, size);
+    }
+    if (size < 2)
+    {
+        if (in_place)
+        {
+            BoltBuffer_unload_target(connection->rx_buffer, 2 + chunk_size + 2);
+        }
+        if (size > 0)
+        {
+            BoltLog_error("bolt: Malformed message (%d bytes)", size);
+            connection->error = BOLT_PROTOCOL_VIOLATION;
+            return -1;
+        }
+        // Nothing to hold for an empty message
+        return 1;
+    }
+    int summary = (uint8_t)(data[1]) != BOLT_V1_RECORD;
+    if (summary && is_window(state, response_id))
+    {
+        // A later request is queued, so the window cannot be refilled
+        close_window(state);
+        summary = HELD_WINDOW_SUMMARY;
+    }
+    if (BoltResponseBuffer_push(state->responses, response_id, data, size, summary) == -1)
+    {
+        BoltLog_error("bolt: Could not spill response data");
+        return -1;
+    }
+    if (in_place)
+    {
+        BoltBuffer_unload_target(connection->rx_buffer, 2 + chunk_size + 2);
+    }
+    return summary ? 0 : 1;
+}
+
+/**
+ * Decode a message taken from the response buffer into `state->data`.
+ *
+ * @param connection
+ * @param response_id
+ * @param data
+ * @param size
+ * @return 0 on success, -1 if the message is malformed
+ */
+int unload_held_message(struct BoltConnection * connection, bolt_request_t response_id, char * data, int32_t size)
+{
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    state->rx_window.data = data;
+    state->rx_window.size = size;
+    state->rx_window.extent = size;
+    state->rx_window.cursor = 0;
+    state->rx_message = &state->rx_window;
+    // Log against the request to which the message responds
+    bolt_request_t response_counter = state->response_counter;
+    state->response_counter = response_id;
+    int status = BoltProtocolV1_unload(connection);
+    state->response_counter = response_counter;
+    state->rx_message = state->rx_buffer;
+    return status == -1 ? -1 : 0;
+}
+
+/**
+ * Fail the fetch of a windowed result for which the server has more
+ * records, but which cannot be refilled as later requests are queued
+ * behind it.
+ *
+ * @param connection
+ * @param response_id
+ * @return -1, for convenience
+ */
+int cut_window_short(struct BoltConnection * connection, bolt_request_t response_id)
+{
+    BoltLog_error("bolt: S[%llu]: Result has more records, but later requests are queued behind it", response_id);
+    connection->error = BOLT_RESULT_TRUNCATED;
+    return -1;
+}
+
+/**
+ * Continue a windowed result after the summary of one window has been
+ * received. If the server has more records, and nothing has been queued
+ * behind the result, another window is requested (or, if `discard` is
+ * set, the remainder is discarded). The follow-up request continues the
+ * response to the original request, so it does not take a request ID of
+ * its own. If the result cannot be continued, and its records are wanted,
+ * the fetch fails rather than report the result as complete.
+ *
+ * @param connection
+ * @param response_id
+ * @param discard
+ * @return 1 if a follow-up request was sent, 0 if not, -1 on error
+ */
+int refill_window_b(struct BoltConnection * connection, bolt_request_t response_id, int discard)
+{
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    if (!is_window(state, response_id))
+    {
+        return 0;
+    }
+    if (!state->summary.has_more)
+    {
+        close_window(state);
+        return 0;
+    }
+    if (state->next_request_id - 1 != response_id || state->stream_remaining >= 0 || state->writer.open)
+    {
+        close_window(state);
+        return discard ? 0 : cut_window_short(connection, response_id);
+    }
+    struct BoltValue * request = discard ? state->discard_request : state->pull_request;
+    BoltValue_to_Int64(BoltDictionary_value(BoltMessage_value(request, 0), 0), discard ? -1 : state->fetch_size);
+    BoltLog_message("C", response_id, request, connection->protocol_version);
+    try(load_message(connection, request));
+    state->next_request_id -= 1;
+    try(BoltConnection_send_b(connection));
+    return 1;
+}
+
+/**
+ * Fetch the next message in response to a request, either unloading
+ * records into `state->data` or, with `VIEW_RECORDS`, leaving them in
+ * place to be read by a `BoltPackReader`.
+ *
+ * @param connection
+ * @param request_id
+ * @param records UNLOAD_RECORDS or VIEW_RECORDS
+ * @return 1 if a record was received, 0 if a summary was received, -1 on error
+ */
+int fetch_message_b(struct BoltConnection * connection, bolt_request_t request_id, int records)
+{
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    release_record_view(connection);
+    if (state->responses != NULL)
+    {
+        if (BoltResponseBuffer_holds(state->responses, request_id))
+        {
+            int32_t size;
+            int summary;
+            char * data = BoltResponseBuffer_pop(state->responses, request_id, &size, &summary);
+            if (data == NULL)
+            {
+                BoltLog_error("bolt: Could not read back spilled response data");
+                return -1;
+            }
+            if (!summary && records == VIEW_RECORDS)
+            {
+                // Held data remains valid until the next pop
+                state->rx_window.data = data;
+                state->rx_window.size = size;
+                state->rx_window.extent = size;
+                state->rx_window.cursor = 0;
+                state->rx_message = &state->rx_window;
+                if (view_record(connection) == -1)
+                {
+                    state->rx_message = state->rx_buffer;
+                    return -1;
+                }
+                return 1;
+            }
+            try(unload_held_message(connection, request_id, data, size));
+            if (summary == HELD_WINDOW_SUMMARY && state->summary.has_more)
+            {
+                return cut_window_short(connection, request_id);
+            }
+            return summary ? 0 : 1;
+        }
+        if (request_id < state->response_counter)
+        {
+            // Already fetched in full
+            return -1;
+        }
+    }
+    while (1)
+    {
+        bolt_request_t response_id = state->response_counter;
+        if (state->responses != NULL && response_id < request_id)
+        {
+            int held = hold_message_b(connection, response_id);
+            if (held == -1)
+            {
+                return -1;
+            }
+            if (held == 0)
+            {
+                state->response_counter += 1;
+            }
+            continue;
+        }
+        // Records of earlier responses are discarded without decoding
+        int received = receive_message_b(connection, response_id == request_id ? records : SKIP_RECORDS);
+        if (received == -1)
+        {
+            return -1;
+        }
+        if (received > 0 || BoltValue_type(state->data) != BOLT_MESSAGE)
+        {
+            if (response_id == request_id)
+            {
+                return 1;
+            }
+            continue;
+        }
+        // Records of earlier windowed results are not wanted, so they are
+        // not cut short
+        int refilled = refill_window_b(connection, response_id, response_id != request_id);
+        if (refilled == 1)
+        {
+            continue;
+        }
+        state->response_counter += 1;
+        if (refilled == -1)
+        {
+            return -1;
+        }
+        if (response_id == request_id)
+        {
+            return 0;
+        }
+    }
+}
+
+int BoltProtocolV1_fetch_b(struct BoltConnection * connection, bolt_request_t request_id)
+{
+    return fetch_message_b(connection, request_id, UNLOAD_RECORDS);
+}
+
+int BoltProtocolV1_fetch_reader_b(struct BoltConnection * connection, bolt_request_t request_id,
+                                  struct BoltPackReader * reader)
+{
+    int fetched = fetch_message_b(connection, request_id, VIEW_RECORDS);
+    reader->connection = connection;
+    reader->started = 0;
+    reader->depth = 0;
+    return fetched;
+}
+
+/**
+ * Unload the next record for a request straight from the connection
+ * receive buffer into `slot`, provided it is already there in full as a
+ * single chunk and no earlier messages stand in front of it.
+ *
+ * @param connection
+ * @param request_id
+ * @param slot
+ * @return 1 if a record was unloaded, 0 if none is ready this way, -1 on error
+ */
+int unload_buffered_record(struct BoltConnection * connection, bolt_request_t request_id, struct BoltValue * slot)
+{
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    if (state->response_counter != request_id ||
+        (state->responses != NULL && BoltResponseBuffer_holds(state->responses, request_id)))
+    {
+        return 0;
+    }
+    const char * data = &connection->rx_buffer->data[connection->rx_buffer->cursor];
+    int available = BoltBuffer_unloadable(connection->rx_buffer);
+    if (available < 6)
+    {
+        return 0;
+    }
+    uint16_t chunk_size = char_to_uint16be(data);
+    if (chunk_size < 2 || available < 2 + chunk_size + 2 || char_to_uint16be(&data[2 + chunk_size]) != 0 ||
+        marker_type((uint8_t)(data[2])) != BOLT_V1_STRUCTURE || (uint8_t)(data[3]) != BOLT_V1_RECORD)
+    {
+        return 0;
+    }
+    struct BoltValue * received = state->data;
+    state->data = slot;
+    state->rx_window.data = (char *)(&data[2]);
+    state->rx_window.size = chunk_size;
+    state->rx_window.extent = chunk_size;
+    state->rx_window.cursor = 0;
+    state->rx_message = &state->rx_window;
+    state->rx_string_views = state->string_views;
+    int status = BoltProtocolV1_unload(connection);
+    state->rx_string_views = 0;
+    state->rx_message = state->rx_buffer;
+    state->data = received;
+    BoltBuffer_unload_target(connection->rx_buffer, 2 + chunk_size + 2);
+    return status == -1 ? -1 : 1;
+}
+
+/**
+ * Determine whether the next message for a request is a record that can
+ * be received without a blocking read: either held in the response
+ * buffer or already received in full into the connection receive buffer.
+ *
+ * @param connection
+ * @param request_id
+ * @return non-zero if a record is ready
+ */
+int record_ready(struct BoltConnection * connection, bolt_request_t request_id)
+{
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    if (state->responses != NULL && BoltResponseBuffer_holds(state->responses, request_id))
+    {
+        return BoltResponseBuffer_holds_record(state->responses, request_id);
+    }
+    if (state->response_counter != request_id)
+    {
+        return 0;
+    }
+    const char * data = &connection->rx_buffer->data[connection->rx_buffer->cursor];
+    int available = BoltBuffer_unloadable(connection->rx_buffer);
+    if (available < 4 || marker_type((uint8_t)(data[2])) != BOLT_V1_STRUCTURE || (uint8_t)(data[3]) != BOLT_V1_RECORD)
+    {
+        return 0;
+    }
+    int offset = 0;
+    while (offset + 2 <= available)
+    {
+        uint16_t chunk_size = char_to_uint16be(&data[offset]);
+        offset += 2 + chunk_size;
+        if (chunk_size == 0)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int BoltProtocolV1_fetch_batch_b(struct BoltConnection * connection, bolt_request_t request_id,
+                                 int32_t max_records, struct BoltValue * records)
+{
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    if (max_records < 1)
+    {
+        return -1;
+    }
+    if (BoltValue_type(records) != BOLT_LIST || records->size < max_records)
+    {
+        BoltValue_to_List(records, max_records);
+    }
+    release_record_view(connection);
+    struct BoltValue * data = state->data;
+    int32_t n = 0;
+    while (n < max_records)
+    {
+        if (n > 0)
+        {
+            // Records already buffered in full skip the per-message checks
+            int unloaded = unload_buffered_record(connection, request_id, BoltList_value(records, n));
+            if (unloaded == -1)
+            {
+                return -1;
+            }
+            if (unloaded == 1)
+            {
+                n += 1;
+                continue;
+            }
+            if (!record_ready(connection, request_id))
+            {
+                break;
+            }
+        }
+        // Decode straight into the record slot
+        state->data = BoltList_value(records, n);
+        int fetched = fetch_message_b(connection, request_id, UNLOAD_RECORDS);
+        state->data = data;
+        if (fetched == -1)
+        {
+            return -1;
+        }
+        if (fetched == 0)
+        {
+            // Only the first message can be a summary; move it to where it belongs
+            struct BoltValue summary = *BoltList_value(records, 0);
+            *BoltList_value(records, 0) = *data;
+            *data = summary;
+            return 0;
+        }
+        n += 1;
+    }
+    return n;
+}
+
+int BoltProtocolV1_fetch_summary_b(struct BoltConnection * connection, bolt_request_t request_id)
+{
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    int records = 0;
+    release_record_view(connection);
+    if (state->responses != NULL)
+    {
+        // Any held records are skipped, and the summary is only received
+        // here if the whole response was held
+        while (BoltResponseBuffer_holds(state->responses, request_id))
+        {
+            int32_t size;
+            int summary;
+            char * data = BoltResponseBuffer_pop(state->responses, request_id, &size, &summary);
+            if (data == NULL)
+            {
+                BoltLog_error("bolt: Could not read back spilled response data");
+                return -1;
+            }
+            if (summary)
+            {
+                try(unload_held_message(connection, request_id, data, size));
+                return records;
+            }
+            records += 1;
+        }
+        if (request_id < state->response_counter)
+        {
+            return -1;
+        }
+    }
+    while (1)
+    {
+        bolt_request_t response_id = state->response_counter;
+        if (state->responses != NULL && response_id < request_id)
+        {
+            int held = hold_message_b(connection, response_id);
+            if (held == -1)
+            {
+                return -1;
+            }
+            if (held == 0)
+            {
+                state->response_counter += 1;
+            }
+            continue;
+        }
+        int skipped = receive_message_b(connection, SKIP_RECORDS);
+        if (skipped == -1)
+        {
+            return -1;
+        }
+        if (skipped == 0 && BoltValue_type(state->data) == BOLT_MESSAGE)
+        {
+            int refilled = refill_window_b(connection, response_id, 1);
+            if (refilled == -1)
+            {
+                return -1;
+            }
+            if (refilled == 1)
+            {
+                continue;
+            }
+            state->response_counter += 1;
+            if (response_id == request_id)
+            {
+                break;
+            }
+        }
+        else if (response_id == request_id)
+        {
+            records += 1;
+        }
+    }
+    if (records > 0)
+    {
+        BoltLog_info("bolt: S[%llu]: Skipped %d records", request_id, records);
+    }
+    return records;
+}
+
+/**
+ * Unload the next value into `x` if it is an integer, or skip it if not.
+ *
+ * @param connection
+ * @param x
+ * @return
+ */
+int unload_metadata_integer(struct BoltConnection * connection, int64_t * x)
+{
+    struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
+    uint8_t marker;
+    try(BoltBuffer_peek_uint8(state->rx_message, &marker));
+    if (MARKERS[marker].type != BOLT_V1_INTEGER)
+    {
+        return skip(connection);
+    }
+    take_uint8(state->rx_message);
+    return unload_integer_value(connection, marker, x);
+}
+
+/**
+ * Unload the next value, in place, if it is a string, or skip it and
+ * set `string` to NULL if not.
+ *
+ * @param connection
+ * @param string
+ * @param size
+ * @return
+ */
+int unload_metadata_string(struct BoltConnection * connection, const char ** string, int32_t * size)
+{
+    struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
+    uint8_t marker;
+    try(BoltBuffer_peek_uint8(state->rx_message, &marker));
+    if (MARKERS[marker].type != BOLT_V1_STRING)
+    {
+        *string = NULL;
+        return skip(connection);
+    }
+    take_uint8(state->rx_message);
+    try(unload_size(connection, marker, size));
+    *string = take_bytes(state->rx_message, *size);
+    return 0;
+}
+
+/**
+ * Unload the next value as a list size if it is a list, leaving the
+ * buffer positioned at its first item, or skip it if not.
+ *
+ * @param connection
+ * @param size the list size, or -1 if not a list
+ * @return
+ */
+int unload_metadata_list(struct BoltConnection * connection, int32_t * size)
+{
+    struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
+    uint8_t marker;
+    try(BoltBuffer_peek_uint8(state->rx_message, &marker));
+    if (MARKERS[marker].type != BOLT_V1_LIST)
+    {
+        *size = -1;
+        return skip(connection);
+    }
+    take_uint8(state->rx_message);
+    return unload_size(connection, marker, size);
+}
+
+#define METADATA_KEY(key, key_size, name) ((key_size) == sizeof(name) - 1 && memcmp(key, name, sizeof(name) - 1) == 0)
+
+/// Update counters reported within the "stats" metadata entry
+static const struct
+{
+    const char* key;
+    size_t offset;
+} SUMMARY_COUNTERS[] = {
+        {"nodes-created", offsetof(struct BoltSummary, nodes_created)},
+        {"nodes-deleted", offsetof(struct BoltSummary, nodes_deleted)},
+        {"relationships-created", offsetof(struct BoltSummary, relationships_created)},
+        {"relationships-deleted", offsetof(struct BoltSummary, relationships_deleted)},
+        {"properties-set", offsetof(struct BoltSummary, properties_set)},
+        {"labels-added", offsetof(struct BoltSummary, labels_added)},
+        {"labels-removed", offsetof(struct BoltSummary, labels_removed)},
+        {"indexes-added", offsetof(struct BoltSummary, indexes_added)},
+        {"indexes-removed", offsetof(struct BoltSummary, indexes_removed)},
+        {"constraints-added", offsetof(struct BoltSummary, constraints_added)},
+        {"constraints-removed", offsetof(struct BoltSummary, constraints_removed)},
+        {"system-updates", offsetof(struct BoltSummary, system_updates)},
+};
+
+/**
+ * Unload the "stats" metadata entry into the update counters of the
+ * summary. Counters not recognised are skipped.
+ *
+ * @param connection
+ * @return
+ */
+int unload_metadata_stats(struct BoltConnection * connection)
+{
+    struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
+    uint8_t marker;
+    int32_t size;
+    try(BoltBuffer_peek_uint8(state->rx_message, &marker));
+    if (MARKERS[marker].type != BOLT_V1_MAP)
+    {
+        return skip(connection);
+    }
+    take_uint8(state->rx_message);
+    try(unload_size(connection, marker, &size));
+    for (int32_t i = 0; i < size; i++)
+    {
+        const char* key;
+        int32_t key_size;
+        try(unload_metadata_string(connection, &key, &key_size));
+        if (key == NULL)
+        {
+            return -1;
+        }
+        int64_t* counter = NULL;
+        for (size_t j = 0; j < sizeof(SUMMARY_COUNTERS) / sizeof(SUMMARY_COUNTERS[0]); j++)
+        {
+            if (strlen(SUMMARY_COUNTERS[j].key) == (size_t)(key_size) &&
+                memcmp(SUMMARY_COUNTERS[j].key, key, (size_t)(key_size)) == 0)
+            {
+                counter = (int64_t*)((char*)(&state->summary) + SUMMARY_COUNTERS[j].offset);
+                break;
+            }
+        }
+        if (counter == NULL)
+        {
+            try(skip(connection));
+        }
+        else
+        {
+            try(unload_metadata_integer(connection, counter));
+        }
+    }
+    return 0;
+}
+
+/**
+ * Unload the "fields" metadata entry straight into the field name array.
+ *
+ * @param connection
+ * @return
+ */
+int unload_metadata_fields(struct BoltConnection * connection)
+{
+    struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
+    int32_t size;
+    try(unload_metadata_list(connection, &size));
+    if (size == -1)
+    {
+        return 0;
+    }
+    BoltValue_to_StringArray(state->fields, size);
+    for (int32_t i = 0; i < size; i++)
+    {
+        const char* name;
+        int32_t name_size;
+        try(unload_metadata_string(connection, &name, &name_size));
+        if (name == NULL)
+        {
+            BoltStringArray_put(state->fields, i, "?", 1);
+        }
+        else
+        {
+            BoltStringArray_put(state->fields, i, name, name_size);
+        }
+    }
+    BoltLog_value(state->fields, 1, "<SET fields=", ">");
+    return 0;
+}
+
+/**
+ * Copy a string into a fixed size, zero-terminated buffer, truncating
+ * it if necessary.
+ *
+ * @param target
+ * @param capacity
+ * @param string
+ * @param size
+ */
+void copy_metadata_string(char * target, size_t capacity, const char * string, int32_t size)
+{
+    size_t n = (size_t)(size) < capacity ? (size_t)(size) : capacity - 1;
+    memcpy(target, string, n);
+    memset(target + n, 0, capacity - n);
+}
+
+/**
+ * Unload the metadata map of a SUCCESS message. Well-known entries are
+ * decoded directly into the typed summary, the field names, the server
+ * name and the last bookmark, without building a value for them; any
+ * other entries are unloaded into `metadata`, which is otherwise left as
+ * an empty dictionary.
+ *
+ * @param connection
+ * @param metadata
+ * @return
+ */
+int unload_success_metadata(struct BoltConnection * connection, struct BoltValue * metadata)
+{
+    struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
+    struct BoltSummary* summary = &state->summary;
+    uint8_t marker;
+    int32_t size;
+    try(BoltBuffer_peek_uint8(state->rx_message, &marker));
+    if (MARKERS[marker].type != BOLT_V1_MAP)
+    {
+        return unload(connection, metadata);
+    }
+    take_uint8(state->rx_message);
+    try(unload_size(connection, marker, &size));
+    BoltValue_to_Dictionary(metadata, 0);
+    for (int32_t i = 0; i < size; i++)
+    {
+        const char* key;
+        int32_t key_size;
+        try(unload_metadata_string(connection, &key, &key_size));
+        if (key == NULL)
+        {
+            return -1;
+        }
+        if (METADATA_KEY(key, key_size, "fields"))
+        {
+            try(unload_metadata_fields(connection));
+        }
+        else if (METADATA_KEY(key, key_size, "result_available_after") || METADATA_KEY(key, key_size, "t_first"))
+        {
+            try(unload_metadata_integer(connection, &summary->result_available_after));
+        }
+        else if (METADATA_KEY(key, key_size, "result_consumed_after") || METADATA_KEY(key, key_size, "t_last"))
+        {
+            try(unload_metadata_integer(connection, &summary->result_consumed_after));
+        }
+        else if (METADATA_KEY(key, key_size, "stats"))
+        {
+            try(unload_metadata_stats(connection));
+        }
+        else if (METADATA_KEY(key, key_size, "type"))
+        {
+            const char* type;
+            int32_t type_size;
+            try(unload_metadata_string(connection, &type, &type_size));
+            if (type != NULL)
+            {
+                summary->type = METADATA_KEY(type, type_size, "r") ? BOLT_QUERY_READ_ONLY :
+                                METADATA_KEY(type, type_size, "rw") ? BOLT_QUERY_READ_WRITE :
+                                METADATA_KEY(type, type_size, "w") ? BOLT_QUERY_WRITE_ONLY :
+                                METADATA_KEY(type, type_size, "s") ? BOLT_QUERY_SCHEMA_WRITE : BOLT_QUERY_UNKNOWN;
+            }
+        }
+        else if (METADATA_KEY(key, key_size, "has_more"))
+        {
+            uint8_t value;
+            try(BoltBuffer_peek_uint8(state->rx_message, &value));
+            summary->has_more = MARKERS[value].type == BOLT_V1_BOOLEAN && (value & 0x01);
+            try(skip(connection));
+        }
+        else if (METADATA_KEY(key, key_size, "bookmark"))
+        {
+            const char* bookmark;
+            int32_t bookmark_size;
+            try(unload_metadata_string(connection, &bookmark, &bookmark_size));
+            if (bookmark != NULL)
+            {
+                copy_metadata_string(state->last_bookmark, MAX_BOOKMARK_SIZE, bookmark, bookmark_size);
+                BoltLog_info("bolt: <SET last_bookmark=\"%s\">", state->last_bookmark);
+            }
+        }
+        else if (METADATA_KEY(key, key_size, "server"))
+        {
+            const char* server;
+            int32_t server_size;
+            try(unload_metadata_string(connection, &server, &server_size));
+            if (server != NULL)
+            {
+                copy_metadata_string(state->server, MAX_SERVER_SIZE, server, server_size);
+                BoltLog_info("bolt: <SET server=\"%s\">", state->server);
+            }
+        }
+        else
+        {
+            // Anything else is kept as a value
+            struct BoltValue* value = BoltDictionary_append(metadata, key, (size_t)(key_size));
+            try(unload(connection, value));
+            if (METADATA_KEY(key, key_size, "notifications") && BoltValue_type(value) == BOLT_LIST)
+            {
+                summary->notifications = value->size;
+            }
+        }
+    }
+    return 0;
+}
+
+int BoltProtocolV1_unload(struct BoltConnection* connection)
+{
+    struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
+    if (BoltBuffer_unloadable(state->rx_message) == 0)
+    {
+        return 0;
+    }
+    if (validate_message(state->rx_message) == -1)
+    {
+        BoltLog_error("bolt: Malformed message (%d bytes)", BoltBuffer_unloadable(state->rx_message));
+        connection->error = BOLT_PROTOCOL_VIOLATION;
+        return -1;
+    }
+    uint8_t marker;
+    uint8_t code;
+    int32_t size;
+    marker = take_uint8(state->rx_message);
+    if (marker_type(marker) != BOLT_V1_STRUCTURE)
+    {
+        return -1;
+    }
+    try(unload_size(connection, marker, &size));
+    struct BoltValue* received = ((struct BoltProtocolV1State*)(connection->protocol_state))->data;
+    code = take_uint8(state->rx_message);
+    if (code == BOLT_V1_RECORD)
+    {
+        if (size >= 1)
+        {
+            if (state->projection != NULL)
+            {
+                try(unload_projected_fields(connection, received));
+            }
+            else
+            {
+                try(unload_predicted(connection, received));
+            }
+            for (int i = 1; i < size; i++)
+            {
+                try(skip(connection));
+            }
+        }
+        else
+        {
+            BoltValue_to_Null(received);
+        }
+        if (state->record_counter < MAX_LOGGED_RECORDS)
+        {
+            BoltLog_message("S", state->response_counter, state->data, connection->protocol_version);
+        }
+        state->record_counter += 1;
+    }
+    else /* Summary */
+    {
+        // Summaries are kept beyond the next fetch, so never hold views
+        state->rx_string_views = 0;
+        BoltValue_to_Message(received, code, size);
+        clear_summary(&state->summary);
+        for (int i = 0; i < size; i++)
+        {
+            if (i == 0 && code == BOLT_V1_SUCCESS)
+            {
+                try(unload_success_metadata(connection, BoltMessage_value(received, 0)));
+            }
+            else
+            {
+                try(unload(connection, BoltMessage_value(received, i)));
+            }
+        }
+        if (state->record_counter > MAX_LOGGED_RECORDS)
+        {
+            BoltLog_info("bolt: S[%d]: Received %llu more records", state->response_counter, state->record_counter - MAX_LOGGED_RECORDS);
+        }
+        state->record_counter = 0;
+        BoltLog_message("S", state->response_counter, received, connection->protocol_version);
+        if (state->entity_cache != NULL)
+        {
+            if (state->entity_cache->size > 0)
+            {
+                BoltLog_info("bolt: S[%llu]: Shared %d entities across %llu repeat occurrences",
+                             state->response_counter, state->entity_cache->size, state->entity_cache->hits);
+            }
+            BoltEntityCache_clear(state->entity_cache);
+        }
+    }
+    return 1;
+}
+
+const char* BoltProtocolV1_structure_name(int16_t code)
+{
+    switch(code)
+    {
+        case 'N':
+            return "Node";
+        case 'R':
+            return "Relationship";
+        case 'r':
+            return "UnboundRelationship";
+        case 'P':
+            return "Path";
+        case 'X':
+            return "Point2D";
+        case 'Y':
+            return "Point3D";
+        case 'D':
+            return "Date";
+        case 'T':
+            return "Time";
+        case 't':
+            return "LocalTime";
+        case 'F':
+            return "DateTime";
+        case 'f':
+            return "DateTimeZoneId";
+        case 'd':
+            return "LocalDateTime";
+        case 'E':
+            return "Duration";
+        default:
+            return "?";
+    }
+}
+
+const char* BoltProtocolV1_message_name(int16_t code)
+{
+    switch(code)
+    {
+        case 0x01:
+            return "INIT";
+        case 0x02:
+            return "GOODBYE";
+        case 0x0E:
+            return "ACK_FAILURE";
+        case 0x0F:
+            return "RESET";
+        case 0x10:
+            return "RUN";
+        case 0x11:
+            return "BEGIN";
+        case 0x12:
+            return "COMMIT";
+        case 0x13:
+            return "ROLLBACK";
+        case 0x2F:
+            return "DISCARD_ALL";
+        case 0x3F:
+            return "PULL_ALL";
+        case 0x70:
+            return "SUCCESS";
+        case 0x7E:
+            return "IGNORED";
+        case 0x7F:
+            return "FAILURE";
+        default:
+            return "?";
+    }
+}
+
+int BoltProtocolV1_init_b(struct BoltConnection * connection, const char * user_agent,
+                          const char * user, const char * password)
+{
+    struct BoltValue * init = BoltValue_create();
+    int (*compile)(struct BoltValue*, const char*, const char*, const char*) =
+            connection->protocol_version >= 3 ? BoltProtocolV1_compile_HELLO : BoltProtocolV1_compile_INIT;
+    compile(init, user_agent, user, "*******");
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    BoltLog_message("C", state->next_request_id, init, connection->protocol_version);
+    compile(init, user_agent, user, password);
+    BoltProtocolV1_load_message_quietly(connection, init);
+    bolt_request_t init_id = BoltConnection_last_request(connection);
+    BoltValue_destroy(init);
+    try(BoltConnection_send_b(connection));
+    BoltConnection_fetch_summary_b(connection, init_id);
+    return BoltMessage_code(BoltConnection_data(connection));
+}
+
+int BoltProtocolV1_set_cypher_template(struct BoltConnection * connection, const char * statement, size_t size)
+{
+    if (size <= INT32_MAX)
+    {
+        struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+        BoltValue_to_String(state->run.statement, statement, (int32_t)(size));
+        return 0;
+    }
+    return -1;
+}
+
+int BoltProtocolV1_set_n_cypher_parameters(struct BoltConnection * connection, int32_t size)
+{
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    BoltValue_to_Dictionary(state->run.parameters, size);
+    return 0;
+}
+
+int BoltProtocolV1_set_cypher_parameter_key(struct BoltConnection * connection, int32_t index, const char * key,
+                                            size_t key_size)
+{
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    return BoltDictionary_set_key(state->run.parameters, index, key, key_size);
+}
+
+struct BoltValue * BoltProtocolV1_cypher_parameter_value(struct BoltConnection * connection, int32_t index)
+{
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    return BoltDictionary_value(state->run.parameters, index);
+}
+
+int BoltProtocolV1_set_entity_cache(struct BoltConnection * connection, int enabled)
+{
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    if (enabled && state->entity_cache == NULL)
+    {
+        state->entity_cache = BoltEntityCache_create();
+    }
+    else if (!enabled && state->entity_cache != NULL)
+    {
+        BoltEntityCache_destroy(state->entity_cache);
+        state->entity_cache = NULL;
+    }
+    return 0;
+}
+
+int BoltProtocolV1_set_string_views(struct BoltConnection * connection, int enabled)
+{
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    state->string_views = enabled != 0;
+    return 0;
+}
+
+int BoltProtocolV1_project(struct BoltConnection * connection, int32_t field, const char * path, size_t path_size)
+{
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    if (field < 0)
+    {
+        return -1;
+    }
+    if (state->projection == NULL)
+    {
+        state->projection = BoltValue_create();
+        BoltValue_to_List(state->projection, 0);
+    }
+    if (field >= state->projection->size)
+    {
+        BoltValue_to_List(state->projection, field + 1);
+    }
+    struct BoltValue* node = BoltList_value(state->projection, field);
+    size_t start = 0;
+    while (start < path_size && BoltValue_type(node) != BOLT_BIT)
+    {
+        size_t end = start;
+        while (end < path_size && path[end] != '.')
+        {
+            end += 1;
+        }
+        if (BoltValue_type(node) != BOLT_DICTIONARY)
+        {
+            BoltValue_to_Dictionary(node, 0);
+        }
+        struct BoltValue* nested = projection_get(node, &path[start], (int32_t)(end - start));
+        if (nested == NULL)
+        {
+            nested = BoltDictionary_append(node, &path[start], end - start);
+        }
+        node = nested;
+        start = end + 1;
+    }
+    if (start >= path_size)
+    {
+        // the whole of the value at the end of the path is required
+        BoltValue_to_Bit(node, 1);
+    }
+    return 0;
+}
+
+int BoltProtocolV1_clear_projection(struct BoltConnection * connection)
+{
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    if (state->projection != NULL)
+    {
+        BoltValue_destroy(state->projection);
+        state->projection = NULL;
+    }
+    return 0;
+}
+
+int BoltProtocolV1_set_fetch_size(struct BoltConnection * connection, int32_t size)
+{
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    if (size > 0 && connection->protocol_version < 4)
+    {
+        return -1;
+    }
+    state->fetch_size = size > 0 ? size : -1;
+    return 0;
+}
+
+int BoltProtocolV1_goodbye_b(struct BoltConnection * connection)
+{
+    try(check_loadable(connection));
+    struct BoltValue * goodbye = BoltValue_create();
+    BoltValue_to_Message(goodbye, GOODBYE, 0);
+    BoltProtocolV1_load_message(connection, goodbye);
+    BoltValue_destroy(goodbye);
+    return BoltConnection_send_b(connection);
+}
+
+int BoltProtocolV1_set_response_buffer(struct BoltConnection * connection, size_t max_size,
+                                      enum BoltResponseOverflow overflow)
+{
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    if (max_size == 0)
+    {
+        if (state->responses != NULL)
+        {
+            BoltResponseBuffer_destroy(state->responses);
+            state->responses = NULL;
+        }
+    }
+    else if (state->responses != NULL)
+    {
+        state->responses->max_size = max_size;
+        state->responses->overflow = overflow;
+    }
+    else
+    {
+        state->responses = BoltResponseBuffer_create(max_size, overflow);
+    }
+    return 0;
+}
+
+int BoltProtocolV1_load_bookmark(struct BoltConnection * connection, const char * bookmark)
+{
+    if (bookmark == NULL)
+    {
+        return 0;
+    }
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    struct BoltValue * bookmarks;
+    if (state->begin.parameters->size == 0)
+    {
+        BoltValue_to_Dictionary(state->begin.parameters, 1);
+        BoltDictionary_set_key(state->begin.parameters, 0, "bookmarks", 9);
+        bookmarks = BoltDictionary_value(state->begin.parameters, 0);
+        BoltValue_to_List(bookmarks, 0);
+    }
+    else
+    {
+        bookmarks = BoltDictionary_value(state->begin.parameters, 0);
+    }
+    size_t bookmark_size = strlen(bookmark);
+    if (bookmark_size > INT32_MAX)
+    {
+        return -1;
+    }
+    BoltValue_to_String(BoltList_append(bookmarks), bookmark, (int32_t)(bookmark_size));
+    return 1;
+}
+
+int BoltProtocolV1_load_begin_request(struct BoltConnection * connection)
+{
+    struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
+    try(check_loadable(connection));
+    if (state->begin.parameters->size == 0)
+    {
+        load_encoded_message(connection, state->begin.request, state->begin.encoded);
+    }
+    else
+    {
+        BoltProtocolV1_load_message(connection, state->begin.request);
+        BoltValue_to_Dictionary(state->begin.parameters, 0);
+    }
+    if (connection->protocol_version < 3)
+    {
+        load_encoded_message(connection, state->discard_request, state->encoded_discard_all);
+    }
+    return 0;
+}
+
+int BoltProtocolV1_load_commit_request(struct BoltConnection * connection)
+{
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    try(check_loadable(connection));
+    load_encoded_message(connection, state->commit.request, state->commit.encoded);
+    if (connection->protocol_version < 3)
+    {
+        load_encoded_message(connection, state->discard_request, state->encoded_discard_all);
+    }
+    return 0;
+}
+
+int BoltProtocolV1_load_rollback_request(struct BoltConnection * connection)
+{
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    try(check_loadable(connection));
+    load_encoded_message(connection, state->rollback.request, state->rollback.encoded);
+    if (connection->protocol_version < 3)
+    {
+        load_encoded_message(connection, state->discard_request, state->encoded_discard_all);
+    }
+    return 0;
+}
+
+int BoltProtocolV1_load_run_request(struct BoltConnection * connection)
+{
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    try(check_loadable(connection));
+    BoltProtocolV1_load_message(connection, state->run.request);
+    return 0;
+}
+
+/**
+ * Abandon a RUN request that could not be completed. If nothing of it has
+ * yet been moved to the connection transmit buffer, the protocol transmit
+ * buffer is simply rolled back. Otherwise part of the message may already
+ * have been sent, and the connection can no longer be used.
+ *
+ * @param connection
+ * @return -1, for convenience
+ */
+int abort_run_request(struct BoltConnection * connection)
+{
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    state->stream_remaining = -1;
+    state->writer.open = 0;
+    if (state->stream_flushed)
+    {
+        BoltLog_error("bolt: RUN request abandoned after being partly sent");
+        connection->status = BOLT_DEFUNCT;
+        connection->error = BOLT_PROTOCOL_VIOLATION;
+    }
+    else
+    {
+        state->tx_buffer->extent = state->stream_mark;
+    }
+    state->stream_flushed = 0;
+    return -1;
+}
+
+/**
+ * Load the start of a RUN request, up to and including the given number
+ * of entries of the parameter map. Further parameters must follow.
+ *
+ * @param connection
+ * @param n_parameters total number of parameters in the map
+ * @return 0 on success, -1 on failure
+ */
+int load_run_header(struct BoltConnection * connection, int32_t n_parameters)
+{
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    struct BoltValue * parameters = state->run.parameters;
+    try(load_structure_header(state->tx_buffer, RUN, state->run.request->size));
+    try(load(state->tx_buffer, state->run.statement));
+    try(load_map_header(state->tx_buffer, n_parameters));
+    for (int32_t i = 0; i < parameters->size; i++)
+    {
+        try(load(state->tx_buffer, BoltDictionary_key(parameters, i)));
+        try(load(state->tx_buffer, BoltDictionary_value(parameters, i)));
+    }
+    return 0;
+}
+
+int BoltProtocolV1_open_run_stream_b(struct BoltConnection * connection, const char * key, size_t key_size,
+                                     int32_t size)
+{
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    if (state->stream_remaining >= 0 || state->writer.open || size < 0 || key_size > INT32_MAX)
+    {
+        return -1;
+    }
+    BoltLog_message("C", state->next_request_id, state->run.request, connection->protocol_version);
+    BoltLog_info("bolt: C[%llu]: Streaming %d values as parameter %.*s", state->next_request_id, size,
+                 (int)(key_size), key);
+    state->stream_mark = state->tx_buffer->extent;
+    state->stream_flushed = 0;
+    if (load_run_header(connection, state->run.parameters->size + 1) == -1 ||
+        load_string(state->tx_buffer, key, (int32_t)(key_size)) == -1 ||
+        load_list_header(state->tx_buffer, size) == -1)
+    {
+        return abort_run_request(connection);
+    }
+    state->stream_remaining = size;
+    return 0;
+}
+
+/**
+ * Move complete chunks of an open stream into the connection transmit
+ * buffer, and send them once enough have accumulated.
+ *
+ * @param connection
+ * @return
+ */
+int flush_stream_b(struct BoltConnection * connection)
+{
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    if (BoltBuffer_unloadable(state->tx_buffer) >= MAX_CHUNK_SIZE)
+    {
+        load_chunks(connection, 0);
+        state->stream_flushed = 1;
+        if (BoltBuffer_unloadable(connection->tx_buffer) >= STREAM_SEND_SIZE)
+        {
+            try(BoltConnection_send_b(connection));
+        }
+    }
+    return 0;
+}
+
+int BoltProtocolV1_load_stream_value_b(struct BoltConnection * connection, struct BoltValue * value)
+{
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    if (state->stream_remaining <= 0)
+    {
+        return -1;
+    }
+    if (load(state->tx_buffer, value) == -1)
+    {
+        return abort_run_request(connection);
+    }
+    state->stream_remaining -= 1;
+    if (flush_stream_b(connection) == -1)
+    {
+        return abort_run_request(connection);
+    }
+    return 0;
+}
+
+int BoltProtocolV1_close_run_stream_b(struct BoltConnection * connection)
+{
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    if (state->stream_remaining != 0)
+    {
+        return -1;
+    }
+    if (connection->protocol_version >= 3 && load(state->tx_buffer, BoltMessage_value(state->run.request, 2)) == -1)
+    {
+        return abort_run_request(connection);
+    }
+    enqueue(connection);
+    state->stream_remaining = -1;
+    state->stream_flushed = 0;
+    return 0;
+}
+
+/**
+ * Check that a column of a batch can be encoded for the given number of
+ * rows, so that a batch is rejected before any of it is loaded.
+ *
+ * @param column
+ * @param n_rows
+ * @return 0 if the column can be encoded, -1 otherwise
+ */
+int check_column(const struct BoltColumn * column, int32_t n_rows)
+{
+    if (column->name == NULL)
+    {
+        return -1;
+    }
+    switch (column->type)
+    {
+        case BOLT_INT64_COLUMN:
+        case BOLT_FLOAT64_COLUMN:
+            return column->values == NULL && n_rows > 0 ? -1 : 0;
+        case BOLT_STRING_COLUMN:
+            if (column->values == NULL)
+            {
+                return n_rows > 0 ? -1 : 0;
+            }
+            for (int32_t i = 0; i < n_rows; i++)
+            {
+                int is_null = column->nulls != NULL && (column->nulls[i >> 3] >> (i & 7)) & 1;
+                if (!is_null && ((const char * const *)(column->values))[i] == NULL)
+                {
+                    BoltLog_error("bolt: Column %.*s holds a NULL string in row %d", column->name_size, column->name, i);
+                    return -1;
+                }
+            }
+            return 0;
+        default:
+            return -1;
+    }
+}
+
+int BoltProtocolV1_load_run_batch_b(struct BoltConnection * connection, const char * key, size_t key_size,
+                                    struct BoltColumnBatch * batch, int32_t n_rows)
+{
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    if (n_rows < 0)
+    {
+        return -1;
+    }
+    for (int32_t j = 0; j < batch->n_columns; j++)
+    {
+        if (check_column(&batch->columns[j], n_rows) == -1)
+        {
+            return -1;
+        }
+    }
+    // The map header and keys are the same for every row, so are encoded once
+    struct BoltBuffer * keys = BoltBuffer_create(64);
+    int32_t * key_ends = BoltMem_allocate(sizeof_n(int32_t, batch->n_columns));
+    int status = load_map_header(keys, batch->n_columns);
+    int32_t header_end = keys->extent;
+    for (int32_t j = 0; status == 0 && j < batch->n_columns; j++)
+    {
+        status = load_string(keys, batch->columns[j].name, batch->columns[j].name_size);
+        key_ends[j] = keys->extent;
+    }
+    int opened = 0;
+    if (status == 0)
+    {
+        status = BoltProtocolV1_open_run_stream_b(connection, key, key_size, n_rows);
+        opened = status == 0;
+    }
+    for (int32_t i = 0; status == 0 && i < n_rows; i++)
+    {
+        struct BoltBuffer * buffer = state->tx_buffer;
+        BoltBuffer_load(buffer, keys->data, header_end);
+        int32_t key_start = header_end;
+        for (int32_t j = 0; status == 0 && j < batch->n_columns; j++)
+        {
+            struct BoltColumn * column = &batch->columns[j];
+            BoltBuffer_load(buffer, keys->data + key_start, key_ends[j] - key_start);
+            key_start = key_ends[j];
+            if (column->nulls != NULL && (column->nulls[i >> 3] >> (i & 7)) & 1)
+            {
+                status = load_null(buffer);
+                continue;
+            }
+            switch (column->type)
+            {
+                case BOLT_INT64_COLUMN:
+                    status = load_integer(buffer, ((const int64_t *)(column->values))[i]);
+                    break;
+                case BOLT_FLOAT64_COLUMN:
+                    status = load_float(buffer, ((const double *)(column->values))[i]);
+                    break;
+                case BOLT_STRING_COLUMN:
+                {
+                    const char * string = ((const char * const *)(column->values))[i];
+                    size_t size = column->sizes == NULL ? strlen(string) : (size_t)(column->sizes[i]);
+                    status = size > INT32_MAX ? -1 : load_string(buffer, string, (int32_t)(size));
+                    break;
+                }
+                default:
+                    status = -1;
+            }
+        }
+        state->stream_remaining -= 1;
+        if (status == 0)
+        {
+            status = flush_stream_b(connection);
+        }
+    }
+    if (status == 0)
+    {
+        status = BoltProtocolV1_close_run_stream_b(connection);
+    }
+    else if (opened)
+    {
+        // Only the request opened here is abandoned, never one already open
+        abort_run_request(connection);
     }
+    BoltMem_deallocate(key_ends, sizeof_n(int32_t, batch->n_columns));
+    BoltBuffer_destroy(keys);
+    return status;
 }
 
-const char* BoltProtocolV1_message_name(int16_t code)
+struct BoltPackWriter * BoltProtocolV1_open_run_writer(struct BoltConnection * connection, int32_t size)
 {
-    switch(code)
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    if (state->stream_remaining >= 0 || state->writer.open || size < 0)
     {
-        case 0x01:
-            return "INIT";
-        case 0x0E:
-            return "ACK_FAILURE";
-        case 0x0F:
-            return "RESET";
-        case 0x10:
-            return "RUN";
-        case 0x2F:
-            return "DISCARD_ALL";
-        case 0x3F:
-            return "PULL_ALL";
-        case 0x70:
-            return "SUCCESS";
-        case 0x7E:
-            return "IGNORED";
-        case 0x7F:
-            return "FAILURE";
-        default:
-            return "?";
+        return NULL;
+    }
+    BoltLog_message("C", state->next_request_id, state->run.request, connection->protocol_version);
+    BoltLog_info("bolt: C[%llu]: Writing %d further parameters", state->next_request_id, size);
+    state->stream_mark = state->tx_buffer->extent;
+    state->stream_flushed = 0;
+    if (load_run_header(connection, state->run.parameters->size + size) == -1)
+    {
+        abort_run_request(connection);
+        return NULL;
+    }
+    struct BoltPackWriter * writer = &state->writer;
+    writer->connection = connection;
+    writer->open = 1;
+    writer->depth = 0;
+    if (size > 0)
+    {
+        writer->remaining[0] = 2 * size;
+        writer->is_map[0] = 1;
+        writer->depth = 1;
     }
+    return writer;
 }
 
-int BoltProtocolV1_init_b(struct BoltConnection * connection, const char * user_agent,
-                          const char * user, const char * password)
+int BoltProtocolV1_close_run_writer(struct BoltConnection * connection)
 {
-    struct BoltValue * init = BoltValue_create();
-    BoltProtocolV1_compile_INIT(init, user_agent, user, "*******");
     struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
-    BoltLog_message("C", state->next_request_id, init, connection->protocol_version);
-    BoltProtocolV1_compile_INIT(init, user_agent, user, password);
-    BoltProtocolV1_load_message_quietly(connection, init);
-    bolt_request_t init_id = BoltConnection_last_request(connection);
-    BoltValue_destroy(init);
-    try(BoltConnection_send_b(connection));
-    BoltConnection_fetch_summary_b(connection, init_id);
-    return BoltMessage_code(BoltConnection_data(connection));
+    if (!state->writer.open)
+    {
+        return -1;
+    }
+#ifndef NDEBUG
+    if (state->writer.depth != 0)
+    {
+        BoltLog_error("bolt: Pack writer closed with %d tokens outstanding", state->writer.remaining[state->writer.depth - 1]);
+        return -1;
+    }
+#endif
+    if (connection->protocol_version >= 3 && load(state->tx_buffer, BoltMessage_value(state->run.request, 2)) == -1)
+    {
+        return abort_run_request(connection);
+    }
+    enqueue(connection);
+    state->writer.open = 0;
+    state->stream_flushed = 0;
+    return 0;
 }
 
-void BoltProtocolV1_extract_metadata(struct BoltConnection * connection, struct BoltValue * summary)
+#ifndef NDEBUG
+/**
+ * Check that a token fits at the current position of a writer, and
+ * track any nesting that it begins.
+ *
+ * @param writer
+ * @param is_key non-zero if the token is written as a map key
+ * @param is_string non-zero if the token can serve as a map key
+ * @param size number of tokens that follow as part of this one
+ * @param is_map non-zero if the token begins a map
+ * @return 0 if the token fits, -1 otherwise
+ */
+int check_token(struct BoltPackWriter * writer, int is_key, int is_string, int32_t size, int is_map)
 {
-    struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
-    if (summary->size >= 1)
+    if (!writer->open || writer->depth == 0)
+    {
+        BoltLog_error("bolt: Pack writer token beyond the declared size");
+        return -1;
+    }
+    int32_t top = writer->depth - 1;
+    int key_expected = writer->is_map[top] && writer->remaining[top] % 2 == 0;
+    if (key_expected ? !is_string : is_key)
+    {
+        BoltLog_error(key_expected ? "bolt: Pack writer expected a map key" : "bolt: Pack writer expected a value");
+        return -1;
+    }
+    writer->remaining[top] -= 1;
+    if (size > 0)
     {
-        struct BoltValue * metadata = BoltMessage_value(summary, 0);
-        switch (BoltValue_type(metadata))
+        if (writer->depth == BOLT_PACK_WRITER_MAX_DEPTH)
         {
-            case BOLT_DICTIONARY:
-            {
-                for (int32_t i = 0; i < metadata->size; i++)
-                {
-                    const char * key = BoltDictionary_get_key(metadata, i);
-                    if (strcmp(key, "bookmark") == 0)
-                    {
-                        struct BoltValue * value = BoltDictionary_value(metadata, i);
-                        switch (BoltValue_type(value))
-                        {
-                            case BOLT_STRING:
-                            {
-                                memset(state->last_bookmark, 0, MAX_BOOKMARK_SIZE);
-                                memcpy(state->last_bookmark, BoltString_get(value), (size_t)(value->size));
-                                BoltLog_info("bolt: <SET last_bookmark=\"%s\">", state->last_bookmark);
-                                break;
-                            }
-                            default:
-                                break;
-                        }
-                    }
-                    else if (strcmp(key, "fields") == 0)
-                    {
-                        struct BoltValue * value = BoltDictionary_value(metadata, i);
-                        switch (BoltValue_type(value))
-                        {
-                            case BOLT_LIST:
-                            {
-                                struct BoltValue * target_value = state->fields;
-                                BoltValue_to_StringArray(target_value, value->size);
-                                for (int j = 0; j < value->size; j++)
-                                {
-                                    struct BoltValue * source_value = BoltList_value(value, j);
-                                    switch (BoltValue_type(source_value))
-                                    {
-                                        case BOLT_STRING:
-                                            BoltStringArray_put(target_value, j, BoltString_get(source_value), source_value->size);
-                                            break;
-                                        default:
-                                            BoltStringArray_put(target_value, j, "?", 1);
-                                    }
-                                }
-                                BoltLog_value(target_value, 1, "<SET fields=", ">");
-                                break;
-                            }
-                            default:
-                                break;
-                        }
-                    }
-                    else if (strcmp(key, "server") == 0)
-                    {
-                        struct BoltValue * value = BoltDictionary_value(metadata, i);
-                        switch (BoltValue_type(value))
-                        {
-                            case BOLT_STRING:
-                            {
-                                memset(state->server, 0, MAX_SERVER_SIZE);
-                                memcpy(state->server, BoltString_get(value), (size_t)(value->size));
-                                BoltLog_info("bolt: <SET server=\"%s\">", state->server);
-                                break;
-                            }
-                            default:
-                                break;
-                        }
-                    }
-                }
-                break;
-            }
-            default:
-                break;
+            BoltLog_error("bolt: Pack writer nesting deeper than %d", BOLT_PACK_WRITER_MAX_DEPTH);
+            return -1;
         }
+        writer->remaining[writer->depth] = is_map ? 2 * size : size;
+        writer->is_map[writer->depth] = (char)(is_map);
+        writer->depth += 1;
+        return 0;
     }
+    while (writer->depth > 0 && writer->remaining[writer->depth - 1] == 0)
+    {
+        writer->depth -= 1;
+    }
+    return 0;
 }
 
-int BoltProtocolV1_set_cypher_template(struct BoltConnection * connection, const char * statement, size_t size)
+#define CHECK_TOKEN(writer, is_key, is_string, size, is_map) try(check_token(writer, is_key, is_string, size, is_map))
+#else
+// Nesting is only tracked in debug builds, but a closed writer is always refused
+#define CHECK_TOKEN(writer, is_key, is_string, size, is_map) { if (!(writer)->open) { return -1; } }
+#endif
+
+struct BoltBuffer * writer_buffer(struct BoltPackWriter * writer)
 {
-    if (size <= INT32_MAX)
+    return BoltProtocolV1_state(writer->connection)->tx_buffer;
+}
+
+/**
+ * Move any complete chunks written so far into the connection transmit
+ * buffer, so that they can be sent before the request is complete.
+ *
+ * @param writer
+ * @return
+ */
+int flush_writer(struct BoltPackWriter * writer)
+{
+    if (BoltBuffer_unloadable(writer_buffer(writer)) >= MAX_CHUNK_SIZE)
     {
-        struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
-        BoltValue_to_String(state->run.statement, statement, (int32_t)(size));
-        return 0;
+        load_chunks(writer->connection, 0);
+        BoltProtocolV1_state(writer->connection)->stream_flushed = 1;
     }
-    return -1;
+    return 0;
 }
 
-int BoltProtocolV1_set_n_cypher_parameters(struct BoltConnection * connection, int32_t size)
+int BoltPackWriter_null(struct BoltPackWriter * writer)
 {
-    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
-    BoltValue_to_Dictionary(state->run.parameters, size);
-    return 0;
+    CHECK_TOKEN(writer, 0, 0, 0, 0);
+    try(load_null(writer_buffer(writer)));
+    return flush_writer(writer);
 }
 
-int BoltProtocolV1_set_cypher_parameter_key(struct BoltConnection * connection, int32_t index, const char * key,
-                                            size_t key_size)
+int BoltPackWriter_boolean(struct BoltPackWriter * writer, int x)
 {
-    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
-    return BoltDictionary_set_key(state->run.parameters, index, key, key_size);
+    CHECK_TOKEN(writer, 0, 0, 0, 0);
+    try(load_boolean(writer_buffer(writer), x));
+    return flush_writer(writer);
 }
 
-struct BoltValue * BoltProtocolV1_cypher_parameter_value(struct BoltConnection * connection, int32_t index)
+int BoltPackWriter_integer(struct BoltPackWriter * writer, int64_t x)
 {
-    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
-    return BoltDictionary_value(state->run.parameters, index);
+    CHECK_TOKEN(writer, 0, 0, 0, 0);
+    try(load_integer(writer_buffer(writer), x));
+    return flush_writer(writer);
 }
 
-int BoltProtocolV1_load_bookmark(struct BoltConnection * connection, const char * bookmark)
+int BoltPackWriter_float(struct BoltPackWriter * writer, double x)
 {
-    if (bookmark == NULL)
+    CHECK_TOKEN(writer, 0, 0, 0, 0);
+    try(load_float(writer_buffer(writer), x));
+    return flush_writer(writer);
+}
+
+int BoltPackWriter_string(struct BoltPackWriter * writer, const char * string, int32_t size)
+{
+    CHECK_TOKEN(writer, 0, 1, 0, 0);
+    try(load_string(writer_buffer(writer), string, size));
+    return flush_writer(writer);
+}
+
+int BoltPackWriter_bytes(struct BoltPackWriter * writer, const char * data, int32_t size)
+{
+    CHECK_TOKEN(writer, 0, 0, 0, 0);
+    try(load_bytes(writer_buffer(writer), data, size));
+    return flush_writer(writer);
+}
+
+int BoltPackWriter_key(struct BoltPackWriter * writer, const char * key, int32_t size)
+{
+    CHECK_TOKEN(writer, 1, 1, 0, 0);
+    try(load_string(writer_buffer(writer), key, size));
+    return flush_writer(writer);
+}
+
+int BoltPackWriter_begin_list(struct BoltPackWriter * writer, int32_t size)
+{
+    CHECK_TOKEN(writer, 0, 0, size, 0);
+    try(load_list_header(writer_buffer(writer), size));
+    return flush_writer(writer);
+}
+
+int BoltPackWriter_begin_map(struct BoltPackWriter * writer, int32_t size)
+{
+    CHECK_TOKEN(writer, 0, 0, size, 1);
+    try(load_map_header(writer_buffer(writer), size));
+    return flush_writer(writer);
+}
+
+int BoltPackWriter_begin_structure(struct BoltPackWriter * writer, int16_t code, int8_t size)
+{
+    CHECK_TOKEN(writer, 0, 0, size, 0);
+    try(load_structure_header(writer_buffer(writer), code, size));
+    return flush_writer(writer);
+}
+
+/**
+ * Account for the next value read from the current container, and
+ * determine whether it is expected to be a map key.
+ *
+ * @param reader
+ * @return 1 if a key is expected, 0 if a value is expected, -1 if the
+ *         record is exhausted
+ */
+int begin_reader_token(struct BoltPackReader * reader)
+{
+    if (reader->depth == 0)
     {
+        if (reader->started)
+        {
+            return -1;
+        }
+        reader->started = 1;
         return 0;
     }
+    int32_t top = reader->depth - 1;
+    if (reader->remaining[top] == 0)
+    {
+        return -1;
+    }
+    int is_key = reader->is_map[top] && reader->remaining[top] % 2 == 0;
+    reader->remaining[top] -= 1;
+    return is_key;
+}
+
+int push_reader_container(struct BoltPackReader * reader, int32_t size, int is_map)
+{
+    if (reader->depth == BOLT_PACK_READER_MAX_DEPTH)
+    {
+        BoltLog_error("bolt: Pack reader nesting deeper than %d", BOLT_PACK_READER_MAX_DEPTH);
+        return -1;
+    }
+    reader->remaining[reader->depth] = is_map ? 2 * size : size;
+    reader->is_map[reader->depth] = (char)(is_map);
+    reader->depth += 1;
+    return 0;
+}
+
+int BoltPackReader_next(struct BoltPackReader * reader)
+{
+    if (reader->depth > 0 && reader->remaining[reader->depth - 1] == 0)
+    {
+        reader->depth -= 1;
+        return BOLT_PACK_END;
+    }
+    if (reader->depth == 0 && reader->started)
+    {
+        return BOLT_PACK_END_OF_RECORD;
+    }
+    struct BoltConnection * connection = reader->connection;
     struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
-    struct BoltValue * bookmarks;
-    if (state->begin.parameters->size == 0)
+    if (BoltBuffer_unloadable(state->rx_message) == 0)
     {
-        BoltValue_to_Dictionary(state->begin.parameters, 1);
-        BoltDictionary_set_key(state->begin.parameters, 0, "bookmarks", 9);
-        bookmarks = BoltDictionary_value(state->begin.parameters, 0);
-        BoltValue_to_List(bookmarks, 0);
+        return -1;
     }
-    else
+    int is_key = begin_reader_token(reader);
+    uint8_t marker;
+    marker = take_uint8(state->rx_message);
+    if (is_key && marker_type(marker) != BOLT_V1_STRING)
     {
-        bookmarks = BoltDictionary_value(state->begin.parameters, 0);
+        return -1;
     }
-    int32_t n_bookmarks = bookmarks->size;
-    BoltList_resize(bookmarks, n_bookmarks + 1);
-    size_t bookmark_size = strlen(bookmark);
-    if (bookmark_size > INT32_MAX)
+    switch (marker_type(marker))
+    {
+        case BOLT_V1_NULL:
+            return BOLT_PACK_NULL;
+        case BOLT_V1_BOOLEAN:
+            reader->integer = marker == 0xC3;
+            return BOLT_PACK_BOOLEAN;
+        case BOLT_V1_INTEGER:
+            try(unload_integer_value(connection, marker, &reader->integer));
+            return BOLT_PACK_INTEGER;
+        case BOLT_V1_FLOAT:
+            reader->real = take_double_be(state->rx_message);
+            return BOLT_PACK_FLOAT;
+        case BOLT_V1_STRING:
+        case BOLT_V1_BYTES:
+            try(unload_size(connection, marker, &reader->size));
+            reader->data = take_bytes(state->rx_message, reader->size);
+            if (marker_type(marker) == BOLT_V1_BYTES)
+            {
+                return BOLT_PACK_BYTES;
+            }
+            return is_key ? BOLT_PACK_KEY : BOLT_PACK_STRING;
+        case BOLT_V1_LIST:
+            try(unload_size(connection, marker, &reader->size));
+            try(push_reader_container(reader, reader->size, 0));
+            return BOLT_PACK_START_LIST;
+        case BOLT_V1_MAP:
+            try(unload_size(connection, marker, &reader->size));
+            try(push_reader_container(reader, reader->size, 1));
+            return BOLT_PACK_START_MAP;
+        case BOLT_V1_STRUCTURE:
+        {
+            uint8_t code;
+            try(unload_size(connection, marker, &reader->size));
+            code = take_uint8(state->rx_message);
+            reader->code = code;
+            try(push_reader_container(reader, reader->size, 0));
+            return BOLT_PACK_STRUCTURE;
+        }
+        default:
+            return -1;
+    }
+}
+
+int BoltPackReader_skip(struct BoltPackReader * reader)
+{
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(reader->connection);
+    if (BoltBuffer_unloadable(state->rx_message) == 0 || begin_reader_token(reader) == -1)
     {
         return -1;
     }
-    BoltValue_to_String(BoltList_value(bookmarks, n_bookmarks), bookmark, (int32_t)(bookmark_size));
-    return 1;
+    return skip(reader->connection);
 }
 
-int BoltProtocolV1_load_begin_request(struct BoltConnection * connection)
+struct BoltPreparedRequest * BoltProtocolV1_prepare_run_request(struct BoltConnection * connection)
 {
-    struct BoltProtocolV1State* state = BoltProtocolV1_state(connection);
-    BoltProtocolV1_load_message(connection, state->begin.request);
-    BoltValue_to_Dictionary(state->begin.parameters, 0);
-    BoltProtocolV1_load_message(connection, state->discard_request);
-    return 0;
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    struct BoltValue * parameters = state->run.parameters;
+    struct BoltPreparedRequest * prepared = BoltMem_allocate(sizeof(struct BoltPreparedRequest));
+    prepared->protocol_version = connection->protocol_version;
+    prepared->request = BoltValue_create();
+    BoltValue_copy(prepared->request, state->run.request);
+    prepared->n_slots = parameters->size;
+    prepared->slots = BoltMem_allocate((size_t)(parameters->size) * sizeof(int32_t));
+    prepared->encoded = BoltBuffer_create(64);
+    int status = load_structure_header(prepared->encoded, RUN, state->run.request->size);
+    if (status == 0) status = load(prepared->encoded, state->run.statement);
+    if (status == 0) status = load_map_header(prepared->encoded, parameters->size);
+    for (int32_t i = 0; status == 0 && i < parameters->size; i++)
+    {
+        status = load(prepared->encoded, BoltDictionary_key(parameters, i));
+        prepared->slots[i] = prepared->encoded->extent;
+    }
+    if (status == 0 && connection->protocol_version >= 3)
+    {
+        status = load(prepared->encoded, BoltMessage_value(state->run.request, 2));
+    }
+    if (status != 0)
+    {
+        BoltPreparedRequest_destroy(prepared);
+        return NULL;
+    }
+    return prepared;
 }
 
-int BoltProtocolV1_load_commit_request(struct BoltConnection * connection)
+int BoltProtocolV1_load_prepared_run_request(struct BoltConnection * connection,
+                                             struct BoltPreparedRequest * prepared)
 {
     struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
-    BoltProtocolV1_load_message(connection, state->commit.request);
-    BoltProtocolV1_load_message(connection, state->discard_request);
+    try(check_loadable(connection));
+    if (prepared->protocol_version != connection->protocol_version)
+    {
+        return -1;
+    }
+    BoltLog_message("C", state->next_request_id, prepared->request, connection->protocol_version);
+    struct BoltValue * parameters = BoltMessage_value(prepared->request, 1);
+    int32_t offset = 0;
+    for (int32_t i = 0; i < prepared->n_slots; i++)
+    {
+        BoltBuffer_load(state->tx_buffer, prepared->encoded->data + offset, prepared->slots[i] - offset);
+        try(load(state->tx_buffer, BoltDictionary_value(parameters, i)));
+        offset = prepared->slots[i];
+    }
+    BoltBuffer_load(state->tx_buffer, prepared->encoded->data + offset, prepared->encoded->extent - offset);
+    enqueue(connection);
     return 0;
 }
 
-int BoltProtocolV1_load_rollback_request(struct BoltConnection * connection)
+/**
+ * Queue a PULL or DISCARD request for `n` records. Any number other
+ * than -1 (all records) requires Bolt v4.
+ *
+ * @param connection
+ * @param request
+ * @param encoded_all pre-encoded form of the request for all records
+ * @param n
+ * @return
+ */
+int load_stream_request(struct BoltConnection * connection, struct BoltValue * request,
+                        struct BoltBuffer * encoded_all, int32_t n)
 {
-    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
-    BoltProtocolV1_load_message(connection, state->rollback.request);
-    BoltProtocolV1_load_message(connection, state->discard_request);
+    try(check_loadable(connection));
+    if (connection->protocol_version < 4)
+    {
+        if (n >= 0)
+        {
+            return -1;
+        }
+    }
+    else
+    {
+        if (n == 0)
+        {
+            return -1;
+        }
+        BoltValue_to_Int64(BoltDictionary_value(BoltMessage_value(request, 0), 0), n < 0 ? -1 : n);
+    }
+    if (n < 0)
+    {
+        return load_encoded_message(connection, request, encoded_all);
+    }
+    BoltProtocolV1_load_message(connection, request);
     return 0;
 }
 
-int BoltProtocolV1_load_run_request(struct BoltConnection * connection)
+int BoltProtocolV1_load_discard_request(struct BoltConnection * connection, int32_t n)
 {
     struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
-    BoltProtocolV1_load_message(connection, state->run.request);
-    return 0;
+    return load_stream_request(connection, state->discard_request, state->encoded_discard_all, n);
 }
 
 int BoltProtocolV1_load_pull_request(struct BoltConnection * connection, int32_t n)
 {
-    if (n >= 0)
-    {
-        return -1;
-    }
-    else
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    if (n < 0 && state->fetch_size > 0)
     {
-        struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
-        BoltProtocolV1_load_message(connection, state->pull_request);
+        try(load_stream_request(connection, state->pull_request, state->encoded_pull_all,
+                                      state->fetch_size));
+        open_window(state, state->next_request_id - 1);
         return 0;
     }
+    return load_stream_request(connection, state->pull_request, state->encoded_pull_all, n);
 }
 
 int32_t BoltProtocolV1_n_fields(struct BoltConnection * connection)
@@ -1281,3 +4075,84 @@ int BoltProtocolV1_dump(struct BoltValue * value, struct BoltBuffer * buffer)
 {
     return load(buffer, value);
 }
+
+struct BoltValue * BoltProtocolV1_data(struct BoltConnection * connection)
+{
+    return BoltProtocolV1_state(connection)->data;
+}
+
+const struct BoltSummary * BoltProtocolV1_summary(struct BoltConnection * connection)
+{
+    return &BoltProtocolV1_state(connection)->summary;
+}
+
+struct BoltValue * BoltProtocolV1_field_names(struct BoltConnection * connection)
+{
+    return BoltProtocolV1_state(connection)->fields;
+}
+
+bolt_request_t BoltProtocolV1_last_request(struct BoltConnection * connection)
+{
+    struct BoltProtocolV1State * state = BoltProtocolV1_state(connection);
+    return state == NULL ? 0 : state->next_request_id - 1;
+}
+
+struct BoltResponseBuffer * BoltProtocolV1_response_buffer(struct BoltConnection * connection)
+{
+    return BoltProtocolV1_state(connection)->responses;
+}
+
+void * create_protocol_state(int32_t protocol_version)
+{
+    return BoltProtocolV1_create_state(protocol_version);
+}
+
+void destroy_protocol_state(void * state)
+{
+    BoltProtocolV1_destroy_state(state);
+}
+
+const struct BoltProtocol BOLT_PROTOCOL_V1 = {
+    .create_state = create_protocol_state,
+    .destroy_state = destroy_protocol_state,
+    .init_b = BoltProtocolV1_init_b,
+    .goodbye_b = BoltProtocolV1_goodbye_b,
+    .fetch_b = BoltProtocolV1_fetch_b,
+    .fetch_reader_b = BoltProtocolV1_fetch_reader_b,
+    .fetch_summary_b = BoltProtocolV1_fetch_summary_b,
+    .fetch_batch_b = BoltProtocolV1_fetch_batch_b,
+    .data = BoltProtocolV1_data,
+    .summary = BoltProtocolV1_summary,
+    .last_request = BoltProtocolV1_last_request,
+    .set_cypher_template = BoltProtocolV1_set_cypher_template,
+    .set_n_cypher_parameters = BoltProtocolV1_set_n_cypher_parameters,
+    .set_cypher_parameter_key = BoltProtocolV1_set_cypher_parameter_key,
+    .cypher_parameter_value = BoltProtocolV1_cypher_parameter_value,
+    .set_entity_cache = BoltProtocolV1_set_entity_cache,
+    .set_string_views = BoltProtocolV1_set_string_views,
+    .project = BoltProtocolV1_project,
+    .clear_projection = BoltProtocolV1_clear_projection,
+    .set_fetch_size = BoltProtocolV1_set_fetch_size,
+    .set_response_buffer = BoltProtocolV1_set_response_buffer,
+    .response_buffer = BoltProtocolV1_response_buffer,
+    .load_bookmark = BoltProtocolV1_load_bookmark,
+    .load_begin_request = BoltProtocolV1_load_begin_request,
+    .load_commit_request = BoltProtocolV1_load_commit_request,
+    .load_rollback_request = BoltProtocolV1_load_rollback_request,
+    .load_run_request = BoltProtocolV1_load_run_request,
+    .load_discard_request = BoltProtocolV1_load_discard_request,
+    .load_pull_request = BoltProtocolV1_load_pull_request,
+    .open_run_stream_b = BoltProtocolV1_open_run_stream_b,
+    .load_stream_value_b = BoltProtocolV1_load_stream_value_b,
+    .close_run_stream_b = BoltProtocolV1_close_run_stream_b,
+    .open_run_writer = BoltProtocolV1_open_run_writer,
+    .close_run_writer = BoltProtocolV1_close_run_writer,
+    .load_run_batch_b = BoltProtocolV1_load_run_batch_b,
+    .prepare_run_request = BoltProtocolV1_prepare_run_request,
+    .load_prepared_run_request = BoltProtocolV1_load_prepared_run_request,
+    .n_fields = BoltProtocolV1_n_fields,
+    .field_name = BoltProtocolV1_field_name,
+    .field_name_size = BoltProtocolV1_field_name_size,
+    .field_names = BoltProtocolV1_field_names,
+    .dump = BoltProtocolV1_dump,
+};
@@ -25,7 +25,11 @@
 #define SEABOLT_PROTOCOL_V1
 
 #include <stdint.h>
+#include <bolt/buffering.h>
 #include <bolt/connect.h>
+#include <bolt/packstream.h>
+
+#include "protocol.h"
 
 
 #define BOLT_V1_SUCCESS 0x70
@@ -53,6 +57,8 @@ struct _run_request
     struct BoltValue* request;
     struct BoltValue* statement;
     struct BoltValue* parameters;
+    /// The request as initially compiled, pre-encoded (NULL unless the request is usually sent unchanged)
+    struct BoltBuffer* encoded;
 };
 
 struct BoltProtocolV1State
@@ -60,6 +66,14 @@ struct BoltProtocolV1State
     // These buffers exclude chunk headers.
     struct BoltBuffer* tx_buffer;
     struct BoltBuffer* rx_buffer;
+    /// Window onto a single-chunk message, held in place in the connection receive buffer
+    struct BoltBuffer rx_window;
+    /// The buffer from which the current message is decoded (either rx_buffer or rx_window)
+    struct BoltBuffer* rx_message;
+    /// Non-zero while a record is left in place to be read by a BoltPackReader
+    int rx_view;
+    /// Number of bytes of the connection receive buffer occupied by that record (if held there)
+    int32_t rx_view_size;
 
     /// The product name and version of the remote server
     char * server;
@@ -67,6 +81,8 @@ struct BoltProtocolV1State
     struct BoltValue * fields;
     /// The last bookmark received from the server
     char * last_bookmark;
+    /// Typed metadata of the last SUCCESS received
+    struct BoltSummary summary;
 
     bolt_request_t next_request_id;
     bolt_request_t response_counter;
@@ -78,12 +94,45 @@ struct BoltProtocolV1State
     struct _run_request rollback;
     struct BoltValue* discard_request;
     struct BoltValue* pull_request;
+    /// Pre-encoded DISCARD and PULL requests for all records
+    struct BoltBuffer* encoded_discard_all;
+    struct BoltBuffer* encoded_pull_all;
 
     /// Holder for fetched data and metadata
     struct BoltValue* data;
+
+    /// Identity cache for nodes and relationships (NULL if disabled)
+    struct BoltEntityCache* entity_cache;
+
+    /// Non-zero if strings and byte arrays within records are decoded as views
+    int string_views;
+    /// Non-zero while such views can be taken of the message being decoded
+    int rx_string_views;
+
+    /// Projection applied to subsequent records (NULL if none)
+    struct BoltValue* projection;
+
+    /// Number of values still to be streamed into an open RUN request (-1 if none is open)
+    int32_t stream_remaining;
+    /// Extent of `tx_buffer` before the open RUN request was begun
+    int stream_mark;
+    /// Non-zero once chunks of the open RUN request have been moved to the connection transmit buffer
+    int stream_flushed;
+    /// Writer for the parameters of an open RUN request
+    struct BoltPackWriter writer;
+
+    /// Number of records requested per PULL (-1 to request all records at once)
+    int32_t fetch_size;
+    /// IDs of requests whose records are being pulled in windows, oldest first
+    bolt_request_t* windows;
+    int32_t n_windows;
+    int32_t windows_capacity;
+
+    /// Responses held back for requests other than the one being fetched (NULL if not held)
+    struct BoltResponseBuffer* responses;
 };
 
-struct BoltProtocolV1State* BoltProtocolV1_create_state();
+struct BoltProtocolV1State* BoltProtocolV1_create_state(int32_t protocol_version);
 
 void BoltProtocolV1_destroy_state(struct BoltProtocolV1State* state);
 
@@ -95,8 +144,48 @@ int BoltProtocolV1_load_message_quietly(struct BoltConnection * connection, stru
 
 int BoltProtocolV1_compile_INIT(struct BoltValue* value, const char* user_agent, const char* user, const char* password);
 
+int BoltProtocolV1_compile_HELLO(struct BoltValue* value, const char* user_agent, const char* user, const char* password);
+
 int BoltProtocolV1_fetch_b(struct BoltConnection * connection, bolt_request_t request_id);
 
+/**
+ * Fetch the next message for a request as `BoltProtocolV1_fetch_b`
+ * does, except that a record is not decoded but left in place, with the
+ * reader positioned at its start.
+ *
+ * @param connection
+ * @param request_id
+ * @param reader
+ * @return 1 if a record was received, 0 if a summary was received, -1 on error
+ */
+int BoltProtocolV1_fetch_reader_b(struct BoltConnection * connection, bolt_request_t request_id,
+                                  struct BoltPackReader * reader);
+
+/**
+ * Fetch one or more records for a request, decoding each directly into
+ * the next item of a list. Only the first message may require a blocking
+ * read; further records are only decoded while already received.
+ *
+ * @param connection
+ * @param request_id
+ * @param max_records
+ * @param records
+ * @return the number of records fetched, 0 if a summary was received
+ *         (into `state->data`), or -1 on error
+ */
+int BoltProtocolV1_fetch_batch_b(struct BoltConnection * connection, bolt_request_t request_id,
+                                 int32_t max_records, struct BoltValue * records);
+
+/**
+ * Fetch up to and including the summary for a request, jumping over any
+ * records at chunk level without decoding them.
+ *
+ * @param connection
+ * @param request_id
+ * @return the number of records skipped for this request, or -1 on error
+ */
+int BoltProtocolV1_fetch_summary_b(struct BoltConnection * connection, bolt_request_t request_id);
+
 /**
  * Top-level unload.
  *
@@ -115,7 +204,7 @@ const char* BoltProtocolV1_message_name(int16_t code);
 int BoltProtocolV1_init_b(struct BoltConnection * connection, const char * user_agent,
                           const char * user, const char * password);
 
-void BoltProtocolV1_extract_metadata(struct BoltConnection * connection, struct BoltValue * summary);
+const struct BoltSummary * BoltProtocolV1_summary(struct BoltConnection * connection);
 
 int BoltProtocolV1_set_cypher_template(struct BoltConnection * connection, const char * statement, size_t size);
 
@@ -126,6 +215,21 @@ int BoltProtocolV1_set_cypher_parameter_key(struct BoltConnection * connection,
 
 struct BoltValue * BoltProtocolV1_cypher_parameter_value(struct BoltConnection * connection, int32_t index);
 
+int BoltProtocolV1_set_entity_cache(struct BoltConnection * connection, int enabled);
+
+int BoltProtocolV1_set_string_views(struct BoltConnection * connection, int enabled);
+
+int BoltProtocolV1_set_fetch_size(struct BoltConnection * connection, int32_t size);
+
+int BoltProtocolV1_goodbye_b(struct BoltConnection * connection);
+
+int BoltProtocolV1_project(struct BoltConnection * connection, int32_t field, const char * path, size_t path_size);
+
+int BoltProtocolV1_clear_projection(struct BoltConnection * connection);
+
+int BoltProtocolV1_set_response_buffer(struct BoltConnection * connection, size_t max_size,
+                                      enum BoltResponseOverflow overflow);
+
 int BoltProtocolV1_load_bookmark(struct BoltConnection * connection, const char * bookmark);
 
 int BoltProtocolV1_load_begin_request(struct BoltConnection * connection);
@@ -136,6 +240,27 @@ int BoltProtocolV1_load_rollback_request(struct BoltConnection * connection);
 
 int BoltProtocolV1_load_run_request(struct BoltConnection * connection);
 
+int BoltProtocolV1_load_discard_request(struct BoltConnection * connection, int32_t n);
+
+int BoltProtocolV1_open_run_stream_b(struct BoltConnection * connection, const char * key, size_t key_size,
+                                     int32_t size);
+
+int BoltProtocolV1_load_stream_value_b(struct BoltConnection * connection, struct BoltValue * value);
+
+int BoltProtocolV1_close_run_stream_b(struct BoltConnection * connection);
+
+int BoltProtocolV1_load_run_batch_b(struct BoltConnection * connection, const char * key, size_t key_size,
+                                    struct BoltColumnBatch * batch, int32_t n_rows);
+
+struct BoltPackWriter * BoltProtocolV1_open_run_writer(struct BoltConnection * connection, int32_t size);
+
+int BoltProtocolV1_close_run_writer(struct BoltConnection * connection);
+
+struct BoltPreparedRequest * BoltProtocolV1_prepare_run_request(struct BoltConnection * connection);
+
+int BoltProtocolV1_load_prepared_run_request(struct BoltConnection * connection,
+                                             struct BoltPreparedRequest * prepared);
+
 int BoltProtocolV1_load_pull_request(struct BoltConnection * connection, int32_t n);
 
 int32_t BoltProtocolV1_n_fields(struct BoltConnection * connection);
@@ -146,5 +271,18 @@ int32_t BoltProtocolV1_field_name_size(struct BoltConnection * connection, int32
 
 int BoltProtocolV1_dump(struct BoltValue * value, struct BoltBuffer * buffer);
 
+struct BoltValue * BoltProtocolV1_data(struct BoltConnection * connection);
+
+struct BoltValue * BoltProtocolV1_field_names(struct BoltConnection * connection);
+
+bolt_request_t BoltProtocolV1_last_request(struct BoltConnection * connection);
+
+struct BoltResponseBuffer * BoltProtocolV1_response_buffer(struct BoltConnection * connection);
+
+/**
+ * Operations shared by Bolt v1 to v4.
+ */
+extern const struct BoltProtocol BOLT_PROTOCOL_V1;
+
 
 #endif // SEABOLT_PROTOCOL_V1
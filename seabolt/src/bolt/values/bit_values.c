@@ -23,30 +23,80 @@
 #include <assert.h>
 #include "bolt/mem.h"
 
+#define BITS_PER_WORD 64
 
+#define bit_words(length) (((length) + BITS_PER_WORD - 1) / BITS_PER_WORD)
+
+#if defined(__GNUC__)
+#define popcount64(x) __builtin_popcountll(x)
+#else
+static int popcount64(uint64_t x)
+{
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((x * 0x0101010101010101ULL) >> 56);
+}
+#endif
 
 void BoltValue_to_Bit(struct BoltValue* value, char data)
 {
-    _format(value, BOLT_BIT, 0, 1, NULL, 0);
+    if (value->type != BOLT_BIT)
+    {
+        _format(value, BOLT_BIT, 0, 1, NULL, 0);
+    }
     value->data.as_char[0] = data;
 }
 
 void BoltValue_to_Byte(struct BoltValue* value, char data)
 {
-    _format(value, BOLT_BYTE, 0, 1, NULL, 0);
+    if (value->type != BOLT_BYTE)
+    {
+        _format(value, BOLT_BYTE, 0, 1, NULL, 0);
+    }
     value->data.as_char[0] = data;
 }
 
 void BoltValue_to_BitArray(struct BoltValue* value, char* data, int32_t length)
 {
-    if (length <= sizeof(value->data) / sizeof(char))
+    BoltValue_to_PackedBitArray(value, NULL, length);
+    if (data != NULL)
+    {
+        uint64_t* words = BoltBitArray_get_all(value);
+        for (int32_t i = 0; i < length; i++)
+        {
+            words[i / BITS_PER_WORD] |= (uint64_t)(data[i] != 0) << (i % BITS_PER_WORD);
+        }
+    }
+}
+
+void BoltValue_to_PackedBitArray(struct BoltValue* value, const uint64_t* words, int32_t length)
+{
+    size_t n_words = (size_t)(bit_words(length));
+    uint64_t* target;
+    if (length <= 8 * sizeof(value->data))
     {
         _format(value, BOLT_BIT_ARRAY, 0, length, NULL, 0);
-        memcpy(value->data.as_char, data, (size_t)(length));
+        memset(&value->data, 0, sizeof(value->data));
+        target = value->data.as_uint64;
     }
     else
     {
-        _format(value, BOLT_BIT_ARRAY, 0, length, data, sizeof_n(char, length));
+        _format(value, BOLT_BIT_ARRAY, 0, length, NULL, sizeof_n(uint64_t, n_words));
+        target = value->data.extended.as_uint64;
+        if (words == NULL)
+        {
+            memset(target, 0, sizeof_n(uint64_t, n_words));
+        }
+    }
+    if (words != NULL && n_words > 0)
+    {
+        memcpy(target, words, sizeof_n(uint64_t, n_words));
+        if (length % BITS_PER_WORD != 0)
+        {
+            // Keep the unused bits of the last word clear
+            target[n_words - 1] &= ((uint64_t)(1) << (length % BITS_PER_WORD)) - 1;
+        }
     }
 }
 
@@ -66,6 +116,22 @@ void BoltValue_to_ByteArray(struct BoltValue* value, char* data, int32_t length)
     }
 }
 
+void BoltValue_to_ByteArrayView(struct BoltValue* value, const char* data, int32_t length)
+{
+    if (length <= sizeof(value->data) / sizeof(char))
+    {
+        BoltValue_to_ByteArray(value, (char*)(data), length);
+        return;
+    }
+    if (value->type != BOLT_BYTE_ARRAY || value->storage != BOLT_STORAGE_VIEW)
+    {
+        _format(value, BOLT_BYTE_ARRAY, 0, length, NULL, 0);
+        value->storage = BOLT_STORAGE_VIEW;
+    }
+    value->size = length;
+    value->data.extended.as_char = (char*)(data);
+}
+
 char BoltBit_get(const struct BoltValue* value)
 {
     return to_bit(value->data.as_char[0]);
@@ -78,9 +144,41 @@ char BoltByte_get(const struct BoltValue* value)
 
 char BoltBitArray_get(const struct BoltValue* value, int32_t index)
 {
-    const char* data = value->size <= sizeof(value->data) / sizeof(char) ?
-                       value->data.as_char : value->data.extended.as_char;
-    return to_bit(data[index]);
+    const uint64_t* words = value->size <= 8 * sizeof(value->data) ?
+                            value->data.as_uint64 : value->data.extended.as_uint64;
+    return (char)((words[index / BITS_PER_WORD] >> (index % BITS_PER_WORD)) & 1);
+}
+
+void BoltBitArray_set(struct BoltValue* value, int32_t index, char data)
+{
+    uint64_t* words = BoltBitArray_get_all(value);
+    uint64_t mask = (uint64_t)(1) << (index % BITS_PER_WORD);
+    if (data)
+    {
+        words[index / BITS_PER_WORD] |= mask;
+    }
+    else
+    {
+        words[index / BITS_PER_WORD] &= ~mask;
+    }
+}
+
+uint64_t* BoltBitArray_get_all(struct BoltValue* value)
+{
+    return value->size <= 8 * sizeof(value->data) ?
+           value->data.as_uint64 : value->data.extended.as_uint64;
+}
+
+int32_t BoltBitArray_count(const struct BoltValue* value)
+{
+    const uint64_t* words = value->size <= 8 * sizeof(value->data) ?
+                            value->data.as_uint64 : value->data.extended.as_uint64;
+    int32_t count = 0;
+    for (int32_t i = 0; i < bit_words(value->size); i++)
+    {
+        count += popcount64(words[i]);
+    }
+    return count;
 }
 
 char BoltByteArray_get(const struct BoltValue* value, int32_t index)
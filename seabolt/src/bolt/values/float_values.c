@@ -24,7 +24,10 @@
 
 void BoltValue_to_Float64(struct BoltValue* value, double data)
 {
-    _format(value, BOLT_FLOAT64, 0, 1, NULL, 0);
+    if (value->type != BOLT_FLOAT64)
+    {
+        _format(value, BOLT_FLOAT64, 0, 1, NULL, 0);
+    }
     value->data.as_double[0] = data;
 }
 
@@ -33,7 +36,10 @@ void BoltValue_to_Float64Array(struct BoltValue* value, double * data, int32_t l
     if (length <= sizeof(value->data) / sizeof(double))
     {
         _format(value, BOLT_FLOAT64_ARRAY, 0, length, NULL, 0);
-        memcpy(value->data.as_double, data, (size_t)(length));
+        if (data != NULL)
+        {
+            memcpy(value->data.as_double, data, sizeof_n(double, length));
+        }
     }
     else
     {
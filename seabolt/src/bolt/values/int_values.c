@@ -27,25 +27,37 @@
 
 void BoltValue_to_Int8(struct BoltValue* value, int8_t data)
 {
-    _format(value, BOLT_INT8, 0, 1, NULL, 0);
+    if (value->type != BOLT_INT8)
+    {
+        _format(value, BOLT_INT8, 0, 1, NULL, 0);
+    }
     value->data.as_int8[0] = data;
 }
 
 void BoltValue_to_Int16(struct BoltValue* value, int16_t data)
 {
-    _format(value, BOLT_INT16, 0, 1, NULL, 0);
+    if (value->type != BOLT_INT16)
+    {
+        _format(value, BOLT_INT16, 0, 1, NULL, 0);
+    }
     value->data.as_int16[0] = data;
 }
 
 void BoltValue_to_Int32(struct BoltValue* value, int32_t data)
 {
-    _format(value, BOLT_INT32, 0, 1, NULL, 0);
+    if (value->type != BOLT_INT32)
+    {
+        _format(value, BOLT_INT32, 0, 1, NULL, 0);
+    }
     value->data.as_int32[0] = data;
 }
 
 void BoltValue_to_Int64(struct BoltValue* value, int64_t data)
 {
-    _format(value, BOLT_INT64, 0, 1, NULL, 0);
+    if (value->type != BOLT_INT64)
+    {
+        _format(value, BOLT_INT64, 0, 1, NULL, 0);
+    }
     value->data.as_int64[0] = data;
 }
 
@@ -54,7 +66,10 @@ void BoltValue_to_Int8Array(struct BoltValue* value, int8_t* data, int32_t lengt
     if (length <= sizeof(value->data) / sizeof(int8_t))
     {
         _format(value, BOLT_INT8_ARRAY, 0, length, NULL, 0);
-        memcpy(value->data.as_int8, data, (size_t)(length));
+        if (data != NULL)
+        {
+            memcpy(value->data.as_int8, data, sizeof_n(int8_t, length));
+        }
     }
     else
     {
@@ -67,7 +82,10 @@ void BoltValue_to_Int16Array(struct BoltValue* value, int16_t* data, int32_t len
     if (length <= sizeof(value->data) / sizeof(int16_t))
     {
         _format(value, BOLT_INT16_ARRAY, 0, length, NULL, 0);
-        memcpy(value->data.as_int16, data, (size_t)(length));
+        if (data != NULL)
+        {
+            memcpy(value->data.as_int16, data, sizeof_n(int16_t, length));
+        }
     }
     else
     {
@@ -80,7 +98,10 @@ void BoltValue_to_Int32Array(struct BoltValue* value, int32_t* data, int32_t len
     if (length <= sizeof(value->data) / sizeof(int32_t))
     {
         _format(value, BOLT_INT32_ARRAY, 0, length, NULL, 0);
-        memcpy(value->data.as_int32, data, (size_t)(length));
+        if (data != NULL)
+        {
+            memcpy(value->data.as_int32, data, sizeof_n(int32_t, length));
+        }
     }
     else
     {
@@ -93,7 +114,10 @@ void BoltValue_to_Int64Array(struct BoltValue* value, int64_t* data, int32_t len
     if (length <= sizeof(value->data) / sizeof(int64_t))
     {
         _format(value, BOLT_INT64_ARRAY, 0, length, NULL, 0);
-        memcpy(value->data.as_int64, data, (size_t)(length));
+        if (data != NULL)
+        {
+            memcpy(value->data.as_int64, data, sizeof_n(int64_t, length));
+        }
     }
     else
     {
@@ -142,6 +166,12 @@ int32_t BoltInt32Array_get(const struct BoltValue* value, int32_t index)
     return data[index];
 }
 
+int32_t* BoltInt32Array_get_all(struct BoltValue* value)
+{
+    return value->size <= sizeof(value->data) / sizeof(int32_t) ?
+           value->data.as_int32 : value->data.extended.as_int32;
+}
+
 int64_t BoltInt64Array_get(const struct BoltValue* value, int32_t index)
 {
     const int64_t* data = value->size <= sizeof(value->data) / sizeof(int64_t) ?
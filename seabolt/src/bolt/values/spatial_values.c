@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2002-2017 "Neo Technology,"
+ * Network Engine for Objects in Lund AB [http://neotechnology.com]
+ *
+ * This file is part of Neo4j.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <bolt/values.h>
+#include <assert.h>
+
+
+void BoltValue_to_Point(struct BoltValue * value, int16_t srid, const double * coordinates, int32_t dimensions)
+{
+    assert(dimensions == 2 || dimensions == 3);
+    if (dimensions <= sizeof(value->data) / sizeof(double))
+    {
+        _format(value, BOLT_POINT, srid, dimensions, NULL, 0);
+        memcpy(value->data.as_double, coordinates, sizeof_n(double, dimensions));
+    }
+    else
+    {
+        _format(value, BOLT_POINT, srid, dimensions, coordinates, sizeof_n(double, dimensions));
+    }
+}
+
+int16_t BoltPoint_srid(const struct BoltValue * value)
+{
+    assert(BoltValue_type(value) == BOLT_POINT);
+    return value->subtype;
+}
+
+const double * BoltPoint_coordinates(const struct BoltValue * value)
+{
+    assert(BoltValue_type(value) == BOLT_POINT);
+    return value->size <= sizeof(value->data) / sizeof(double) ?
+           value->data.as_double : value->data.extended.as_double;
+}
+
+int BoltPoint_write(const struct BoltValue * value, FILE * file)
+{
+    assert(BoltValue_type(value) == BOLT_POINT);
+    const double * coordinates = BoltPoint_coordinates(value);
+    fprintf(file, "point(%d;", BoltPoint_srid(value));
+    for (int i = 0; i < value->size; i++)
+    {
+        fprintf(file, " %f", coordinates[i]);
+    }
+    fprintf(file, ")");
+    return 0;
+}
@@ -29,10 +29,8 @@
 void _to_structure(struct BoltValue* value, enum BoltType type, int16_t code, int32_t size)
 {
     _recycle(value);
-    value->data.extended.as_ptr = BoltMem_adjust(value->data.extended.as_ptr, value->data_size,
-                                                 sizeof_n(struct BoltValue, size));
-    value->data_size = sizeof_n(struct BoltValue, size);
-    memset(value->data.extended.as_char, 0, value->data_size);
+    _adjust(value, sizeof_n(struct BoltValue, size));
+    memset(value->data.extended.as_char, 0, sizeof_n(struct BoltValue, size));
     _set_type(value, type, code, size);
 }
 
@@ -94,6 +92,43 @@ struct BoltValue* BoltStructureArray_at(const struct BoltValue* value, int32_t a
     return BoltList_value(&value->data.extended.as_value[array_index], structure_index);
 }
 
+int32_t BoltPath_size(const struct BoltValue* value)
+{
+    assert(BoltValue_type(value) == BOLT_STRUCTURE && BoltStructure_code(value) == 'P');
+    return BoltStructure_value(value, 2)->size / 2;
+}
+
+struct BoltValue* BoltPath_node(const struct BoltValue* value, int32_t index)
+{
+    struct BoltValue* nodes = BoltStructure_value(value, 0);
+    if (index == 0)
+    {
+        return BoltList_value(nodes, 0);
+    }
+    struct BoltValue* sequence = BoltStructure_value(value, 2);
+    assert(BoltValue_type(sequence) == BOLT_INT32_ARRAY);
+    return BoltList_value(nodes, BoltInt32Array_get(sequence, 2 * index - 1));
+}
+
+struct BoltValue* BoltPath_relationship(const struct BoltValue* value, int32_t index)
+{
+    struct BoltValue* sequence = BoltStructure_value(value, 2);
+    assert(BoltValue_type(sequence) == BOLT_INT32_ARRAY);
+    int32_t relationship = BoltInt32Array_get(sequence, 2 * index);
+    return BoltList_value(BoltStructure_value(value, 1), (relationship > 0 ? relationship : -relationship) - 1);
+}
+
+int BoltPath_segment(const struct BoltValue* value, int32_t index, struct BoltValue** start,
+                     struct BoltValue** relationship, struct BoltValue** end)
+{
+    struct BoltValue* sequence = BoltStructure_value(value, 2);
+    assert(BoltValue_type(sequence) == BOLT_INT32_ARRAY);
+    *start = BoltPath_node(value, index);
+    *relationship = BoltPath_relationship(value, index);
+    *end = BoltPath_node(value, index + 1);
+    return BoltInt32Array_get(sequence, 2 * index) > 0 ? 1 : -1;
+}
+
 int BoltStructure_write(struct BoltValue * value, FILE * file, int32_t protocol_version)
 {
     assert(BoltValue_type(value) == BOLT_STRUCTURE);
@@ -101,6 +136,9 @@ int BoltStructure_write(struct BoltValue * value, FILE * file, int32_t protocol_
     switch (protocol_version)
     {
         case 1:
+        case 2:
+        case 3:
+        case 4:
         {
             const char* name = BoltProtocolV1_structure_name(code);
             fprintf(file, "$%s", name);
@@ -126,6 +164,9 @@ int BoltStructureArray_write(struct BoltValue * value, FILE * file, int32_t prot
     switch (protocol_version)
     {
         case 1:
+        case 2:
+        case 3:
+        case 4:
         {
             const char* name = BoltProtocolV1_structure_name(code);
             if (name == NULL)
@@ -162,6 +203,9 @@ int BoltMessage_write(struct BoltValue * value, FILE * file, int32_t protocol_ve
     switch (protocol_version)
     {
         case 1:
+        case 2:
+        case 3:
+        case 4:
         {
             const char* name = BoltProtocolV1_message_name(code);
             if (name == NULL)
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2002-2017 "Neo Technology,"
+ * Network Engine for Objects in Lund AB [http://neotechnology.com]
+ *
+ * This file is part of Neo4j.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <bolt/values.h>
+#include <assert.h>
+#include <inttypes.h>
+
+
+void BoltValue_to_Date(struct BoltValue * value, int64_t days)
+{
+    _format(value, BOLT_DATE, 0, 1, NULL, 0);
+    value->data.as_int64[0] = days;
+}
+
+void BoltValue_to_Time(struct BoltValue * value, int64_t nanoseconds, int32_t tz_offset_seconds)
+{
+    struct BoltTime time = {nanoseconds, tz_offset_seconds};
+    _format(value, BOLT_TIME, 0, 1, &time, sizeof(time));
+}
+
+void BoltValue_to_LocalTime(struct BoltValue * value, int64_t nanoseconds)
+{
+    _format(value, BOLT_LOCAL_TIME, 0, 1, NULL, 0);
+    value->data.as_int64[0] = nanoseconds;
+}
+
+void BoltValue_to_DateTime(struct BoltValue * value, int64_t seconds, int32_t nanoseconds, int32_t tz_offset_seconds)
+{
+    struct BoltDateTime date_time = {seconds, nanoseconds, tz_offset_seconds};
+    _format(value, BOLT_DATE_TIME, 0, 1, &date_time, sizeof(date_time));
+}
+
+void BoltValue_to_LocalDateTime(struct BoltValue * value, int64_t seconds, int32_t nanoseconds)
+{
+    struct BoltLocalDateTime date_time = {seconds, nanoseconds};
+    _format(value, BOLT_LOCAL_DATE_TIME, 0, 1, &date_time, sizeof(date_time));
+}
+
+void BoltValue_to_Duration(struct BoltValue * value, int64_t months, int64_t days, int64_t seconds, int32_t nanoseconds)
+{
+    struct BoltDuration duration = {months, days, seconds, nanoseconds};
+    _format(value, BOLT_DURATION, 0, 1, &duration, sizeof(duration));
+}
+
+int64_t BoltDate_get(const struct BoltValue * value)
+{
+    assert(BoltValue_type(value) == BOLT_DATE);
+    return value->data.as_int64[0];
+}
+
+struct BoltTime BoltTime_get(const struct BoltValue * value)
+{
+    assert(BoltValue_type(value) == BOLT_TIME);
+    struct BoltTime time;
+    memcpy(&time, value->data.extended.as_ptr, sizeof(time));
+    return time;
+}
+
+int64_t BoltLocalTime_get(const struct BoltValue * value)
+{
+    assert(BoltValue_type(value) == BOLT_LOCAL_TIME);
+    return value->data.as_int64[0];
+}
+
+struct BoltDateTime BoltDateTime_get(const struct BoltValue * value)
+{
+    assert(BoltValue_type(value) == BOLT_DATE_TIME);
+    struct BoltDateTime date_time;
+    memcpy(&date_time, value->data.extended.as_ptr, sizeof(date_time));
+    return date_time;
+}
+
+struct BoltLocalDateTime BoltLocalDateTime_get(const struct BoltValue * value)
+{
+    assert(BoltValue_type(value) == BOLT_LOCAL_DATE_TIME);
+    struct BoltLocalDateTime date_time;
+    memcpy(&date_time, value->data.extended.as_ptr, sizeof(date_time));
+    return date_time;
+}
+
+struct BoltDuration BoltDuration_get(const struct BoltValue * value)
+{
+    assert(BoltValue_type(value) == BOLT_DURATION);
+    struct BoltDuration duration;
+    memcpy(&duration, value->data.extended.as_ptr, sizeof(duration));
+    return duration;
+}
+
+int BoltDate_write(const struct BoltValue * value, FILE * file)
+{
+    fprintf(file, "date(%" PRIi64 ")", BoltDate_get(value));
+    return 0;
+}
+
+int BoltTime_write(const struct BoltValue * value, FILE * file)
+{
+    struct BoltTime time = BoltTime_get(value);
+    fprintf(file, "time(%" PRIi64 ", %+" PRIi32 ")", time.nanoseconds, time.tz_offset_seconds);
+    return 0;
+}
+
+int BoltLocalTime_write(const struct BoltValue * value, FILE * file)
+{
+    fprintf(file, "localtime(%" PRIi64 ")", BoltLocalTime_get(value));
+    return 0;
+}
+
+int BoltDateTime_write(const struct BoltValue * value, FILE * file)
+{
+    struct BoltDateTime date_time = BoltDateTime_get(value);
+    fprintf(file, "datetime(%" PRIi64 ", %" PRIi32 ", %+" PRIi32 ")",
+            date_time.seconds, date_time.nanoseconds, date_time.tz_offset_seconds);
+    return 0;
+}
+
+int BoltLocalDateTime_write(const struct BoltValue * value, FILE * file)
+{
+    struct BoltLocalDateTime date_time = BoltLocalDateTime_get(value);
+    fprintf(file, "localdatetime(%" PRIi64 ", %" PRIi32 ")", date_time.seconds, date_time.nanoseconds);
+    return 0;
+}
+
+int BoltDuration_write(const struct BoltValue * value, FILE * file)
+{
+    struct BoltDuration duration = BoltDuration_get(value);
+    fprintf(file, "duration(%" PRIi64 ", %" PRIi64 ", %" PRIi64 ", %" PRIi32 ")",
+            duration.months, duration.days, duration.seconds, duration.nanoseconds);
+    return 0;
+}
@@ -29,7 +29,10 @@ static const char * const REPLACEMENT_CHARACTER = "\xFF\xFD";
 
 void BoltValue_to_Char(struct BoltValue * value, uint32_t data)
 {
-    _format(value, BOLT_CHAR, 0, 1, NULL, 0);
+    if (value->type != BOLT_CHAR)
+    {
+        _format(value, BOLT_CHAR, 0, 1, NULL, 0);
+    }
     value->data.as_uint32[0] = data;
 }
 
@@ -45,7 +48,14 @@ void BoltValue_to_String(struct BoltValue * value, const char * data, int32_t le
     {
         // If the string is short, it can fit entirely within the
         // BoltValue instance
-        _format(value, BOLT_STRING, 0, length, NULL, 0);
+        if (value->type == BOLT_STRING && value->storage == BOLT_STORAGE_INLINE)
+        {
+            value->size = length;
+        }
+        else
+        {
+            _format(value, BOLT_STRING, 0, length, NULL, 0);
+        }
         if (data != NULL)
         {
             memcpy(value->data.as_char, data, (size_t)(length));
@@ -54,8 +64,7 @@ void BoltValue_to_String(struct BoltValue * value, const char * data, int32_t le
     else if (BoltValue_type(value) == BOLT_STRING)
     {
         // This is already a UTF-8 string so we can just tweak the value
-        value->data.extended.as_ptr = BoltMem_adjust(value->data.extended.as_ptr, value->data_size, data_size);
-        value->data_size = data_size;
+        _adjust(value, data_size);
         value->size = length;
         if (data != NULL)
         {
@@ -69,6 +78,22 @@ void BoltValue_to_String(struct BoltValue * value, const char * data, int32_t le
     }
 }
 
+void BoltValue_to_StringView(struct BoltValue * value, const char * data, int32_t length)
+{
+    if (length <= sizeof(value->data) / sizeof(char))
+    {
+        BoltValue_to_String(value, data, length);
+        return;
+    }
+    if (value->type != BOLT_STRING || value->storage != BOLT_STORAGE_VIEW)
+    {
+        _format(value, BOLT_STRING, 0, length, NULL, 0);
+        value->storage = BOLT_STORAGE_VIEW;
+    }
+    value->size = length;
+    value->data.extended.as_char = (char*)(data);
+}
+
 void BoltValue_to_CharArray(struct BoltValue * value, const uint32_t * data, int32_t length)
 {
     size_t data_size = length >= 0 ? sizeof(uint32_t) * length : 0;
@@ -82,8 +107,7 @@ void BoltValue_to_CharArray(struct BoltValue * value, const uint32_t * data, int
     }
     else if (BoltValue_type(value) == BOLT_CHAR_ARRAY)
     {
-        value->data.extended.as_ptr = BoltMem_adjust(value->data.extended.as_ptr, value->data_size, data_size);
-        value->data_size = data_size;
+        _adjust(value, data_size);
         value->size = length;
         if (data != NULL)
         {
@@ -111,15 +135,17 @@ void BoltValue_to_Dictionary(struct BoltValue * value, int32_t length)
 {
     if (value->type == BOLT_DICTIONARY)
     {
-        _resize(value, length, 2);
+        if (value->size != length)
+        {
+            _resize(value, length, 2);
+        }
     }
     else
     {
         size_t unit_size = sizeof(struct BoltValue);
         size_t data_size = 2 * unit_size * length;
         _recycle(value);
-        value->data.extended.as_ptr = BoltMem_adjust(value->data.extended.as_ptr, value->data_size, data_size);
-        value->data_size = data_size;
+        _adjust(value, data_size);
         memset(value->data.extended.as_char, 0, data_size);
         _set_type(value, BOLT_DICTIONARY, 0, length);
     }
@@ -195,6 +221,18 @@ int BoltDictionary_set_key(struct BoltValue * value, int32_t index, const char *
     }
 }
 
+struct BoltValue* BoltDictionary_append(struct BoltValue * value, const char * key, size_t key_size)
+{
+    assert(BoltValue_type(value) == BOLT_DICTIONARY);
+    if (key_size > INT32_MAX)
+    {
+        return NULL;
+    }
+    int32_t index = _append(value, 2);
+    BoltValue_to_String(&value->data.extended.as_value[2 * index], key, (int32_t)(key_size));
+    return &value->data.extended.as_value[2 * index + 1];
+}
+
 struct BoltValue* BoltDictionary_value(struct BoltValue * value, int32_t index)
 {
     assert(BoltValue_type(value) == BOLT_DICTIONARY);
@@ -25,6 +25,60 @@
 #include "bolt/mem.h"
 
 
+/**
+ * Obtain the header of the external data held or borrowed by a value.
+ *
+ * @param value
+ * @return
+ */
+struct BoltExtent* _extent(const struct BoltValue* value)
+{
+    return (struct BoltExtent*)(value->data.extended.as_ptr) - 1;
+}
+
+size_t _data_size(const struct BoltValue* value)
+{
+    return value->storage == BOLT_STORAGE_EXTERNAL ? (size_t)(_extent(value)->data_size) : 0;
+}
+
+void _adjust(struct BoltValue* value, size_t data_size)
+{
+    size_t old_data_size = _data_size(value);
+    if (data_size == old_data_size)
+    {
+        return;
+    }
+    struct BoltExtent* extent = old_data_size == 0 ? NULL : _extent(value);
+    if (data_size == 0)
+    {
+        BoltMem_deallocate(extent, sizeof(struct BoltExtent) + old_data_size);
+        value->data.extended.as_ptr = NULL;
+        value->storage = BOLT_STORAGE_INLINE;
+        return;
+    }
+    extent = BoltMem_adjust(extent, old_data_size == 0 ? 0 : sizeof(struct BoltExtent) + old_data_size,
+                            sizeof(struct BoltExtent) + data_size);
+    if (old_data_size == 0)
+    {
+        extent->owner = NULL;
+    }
+    extent->data_size = data_size;
+    value->data.extended.as_ptr = extent + 1;
+    value->storage = BOLT_STORAGE_EXTERNAL;
+}
+
+/**
+ * Determine whether a value is a view of a shared value. Such values
+ * have a logical size but hold no physical data of their own.
+ *
+ * @param value
+ * @return
+ */
+int _is_borrowed(const struct BoltValue* value)
+{
+    return value->storage == BOLT_STORAGE_BORROWED;
+}
+
 /**
  * Clean up a value for reuse.
  *
@@ -34,6 +88,23 @@
  */
 void _recycle(struct BoltValue* value)
 {
+    if (_is_borrowed(value))
+    {
+        // Nested values belong to the shared value, so we only
+        // need to give up our reference to it
+        struct BoltSharedValue* owner = _extent(value)->owner;
+        value->data.extended.as_ptr = NULL;
+        value->storage = BOLT_STORAGE_INLINE;
+        BoltSharedValue_release(owner);
+        return;
+    }
+    if (value->storage == BOLT_STORAGE_VIEW)
+    {
+        // The viewed data belongs elsewhere and holds no nested values
+        value->data.extended.as_ptr = NULL;
+        value->storage = BOLT_STORAGE_INLINE;
+        return;
+    }
     enum BoltType type = BoltValue_type(value);
     if (type == BOLT_LIST || type == BOLT_STRUCTURE || type == BOLT_STRUCTURE_ARRAY || type == BOLT_MESSAGE)
     {
@@ -73,8 +144,7 @@ void _set_type(struct BoltValue* value, enum BoltType type, int16_t subtype, int
 void _format(struct BoltValue* value, enum BoltType type, int16_t subtype, int32_t size, const void* data, size_t data_size)
 {
     _recycle(value);
-    value->data.extended.as_ptr = BoltMem_adjust(value->data.extended.as_ptr, value->data_size, data_size);
-    value->data_size = data_size;
+    _adjust(value, data_size);
     if (data != NULL && data_size > 0)
     {
         memcpy(value->data.extended.as_char, data, data_size);
@@ -83,6 +153,26 @@ void _format(struct BoltValue* value, enum BoltType type, int16_t subtype, int32
 }
 
 
+/**
+ * Ensure that a value that contains multiple sub-values has physical
+ * space for at least `capacity` entries, without changing its size.
+ * Space beyond the size is kept zeroed.
+ *
+ * @param value
+ * @param capacity
+ * @param multiplier
+ */
+void _reserve(struct BoltValue* value, int32_t capacity, int multiplier)
+{
+    size_t new_data_size = multiplier * sizeof_n(struct BoltValue, capacity);
+    size_t old_data_size = _data_size(value);
+    if (new_data_size > old_data_size)
+    {
+        _adjust(value, new_data_size);
+        memset(value->data.extended.as_char + old_data_size, 0, new_data_size - old_data_size);
+    }
+}
+
 /**
  * Resize a value that contains multiple sub-values.
  *
@@ -94,14 +184,9 @@ void _resize(struct BoltValue* value, int32_t size, int multiplier)
 {
     if (size > value->size)
     {
-        // grow physically
-        size_t unit_size = sizeof(struct BoltValue);
-        size_t new_data_size = multiplier * unit_size * size;
-        size_t old_data_size = value->data_size;
-        value->data.extended.as_ptr = BoltMem_adjust(value->data.extended.as_ptr, value->data_size, new_data_size);
-        value->data_size = new_data_size;
+        // grow physically, unless already reserved
+        _reserve(value, size, multiplier);
         // grow logically
-        memset(value->data.extended.as_char + old_data_size, 0, new_data_size - old_data_size);
         value->size = size;
     }
     else if (size < value->size)
@@ -113,9 +198,7 @@ void _resize(struct BoltValue* value, int32_t size, int multiplier)
         }
         value->size = size;
         // shrink physically
-        size_t new_data_size = multiplier * sizeof_n(struct BoltValue, size);
-        value->data.extended.as_ptr = BoltMem_adjust(value->data.extended.as_ptr, value->data_size, new_data_size);
-        value->data_size = new_data_size;
+        _adjust(value, multiplier * sizeof_n(struct BoltValue, size));
     }
     else
     {
@@ -123,14 +206,33 @@ void _resize(struct BoltValue* value, int32_t size, int multiplier)
     }
 }
 
+/**
+ * Add one entry to the end of a value that contains multiple
+ * sub-values. Capacity is doubled whenever it runs out, so that
+ * building up a value of n entries takes O(log n) reallocations.
+ *
+ * @param value
+ * @param multiplier
+ * @return index of the new entry
+ */
+int32_t _append(struct BoltValue* value, int multiplier)
+{
+    int32_t index = value->size;
+    int32_t capacity = (int32_t)(_data_size(value) / (multiplier * sizeof(struct BoltValue)));
+    if (index >= capacity)
+    {
+        _reserve(value, index < 4 ? 4 : 2 * index, multiplier);
+    }
+    value->size = index + 1;
+    return index;
+}
+
 struct BoltValue* BoltValue_create()
 {
     size_t size = sizeof(struct BoltValue);
     struct BoltValue* value = BoltMem_allocate(size);
     _set_type(value, BOLT_NULL, 0, 0);
-    value->data_size = 0;
-    value->data.as_int64[0] = 0;
-    value->data.as_int64[1] = 0;
+    value->storage = BOLT_STORAGE_INLINE;
     value->data.extended.as_ptr = NULL;
     return value;
 }
@@ -147,19 +249,164 @@ void BoltValue_to_List(struct BoltValue* value, int32_t length)
 {
     if (BoltValue_type(value) == BOLT_LIST)
     {
-        BoltList_resize(value, length);
+        if (value->size != length)
+        {
+            BoltList_resize(value, length);
+        }
     }
     else
     {
         size_t data_size = sizeof(struct BoltValue) * length;
         _recycle(value);
-        value->data.extended.as_ptr = BoltMem_adjust(value->data.extended.as_ptr, value->data_size, data_size);
-        value->data_size = data_size;
+        _adjust(value, data_size);
         memset(value->data.extended.as_char, 0, data_size);
         _set_type(value, BOLT_LIST, 0, length);
     }
 }
 
+struct BoltSharedValue* BoltSharedValue_create()
+{
+    struct BoltSharedValue* shared = BoltMem_allocate(sizeof(struct BoltSharedValue));
+    shared->references = 1;
+    _set_type(&shared->value, BOLT_NULL, 0, 0);
+    shared->value.storage = BOLT_STORAGE_INLINE;
+    shared->value.data.extended.as_ptr = NULL;
+    return shared;
+}
+
+void BoltSharedValue_release(struct BoltSharedValue* shared)
+{
+    assert(shared->references > 0);
+    shared->references -= 1;
+    if (shared->references == 0)
+    {
+        BoltValue_to_Null(&shared->value);
+        BoltMem_deallocate(shared, sizeof(struct BoltSharedValue));
+    }
+}
+
+void BoltValue_borrow(struct BoltValue* value, struct BoltSharedValue* shared)
+{
+    struct BoltValue* source = &shared->value;
+    assert(source->size > 0 && _data_size(source) > 0);
+    shared->references += 1;
+    _recycle(value);
+    _adjust(value, 0);
+    _extent(source)->owner = shared;
+    value->data.extended.as_ptr = source->data.extended.as_ptr;
+    value->storage = BOLT_STORAGE_BORROWED;
+    _set_type(value, BoltValue_type(source), source->subtype, source->size);
+}
+
+void BoltValue_copy(struct BoltValue* dest, const struct BoltValue* src)
+{
+    switch (BoltValue_type(src))
+    {
+        case BOLT_LIST:
+        {
+            BoltValue_to_List(dest, src->size);
+            for (int32_t i = 0; i < src->size; i++)
+            {
+                BoltValue_copy(BoltList_value(dest, i), BoltList_value(src, i));
+            }
+            break;
+        }
+        case BOLT_DICTIONARY:
+        {
+            BoltValue_to_Dictionary(dest, src->size);
+            for (int32_t i = 0; i < 2 * src->size; i++)
+            {
+                BoltValue_copy(&dest->data.extended.as_value[i], &src->data.extended.as_value[i]);
+            }
+            break;
+        }
+        case BOLT_STRUCTURE:
+        case BOLT_MESSAGE:
+        {
+            _to_structure(dest, BoltValue_type(src), src->subtype, src->size);
+            for (int32_t i = 0; i < src->size; i++)
+            {
+                BoltValue_copy(&dest->data.extended.as_value[i], &src->data.extended.as_value[i]);
+            }
+            break;
+        }
+        case BOLT_STRUCTURE_ARRAY:
+        {
+            BoltValue_to_StructureArray(dest, src->subtype, src->size);
+            for (int32_t i = 0; i < src->size; i++)
+            {
+                BoltValue_copy(&dest->data.extended.as_value[i], &src->data.extended.as_value[i]);
+            }
+            break;
+        }
+        case BOLT_STRING_ARRAY:
+        {
+            BoltValue_to_StringArray(dest, src->size);
+            for (int32_t i = 0; i < src->size; i++)
+            {
+                struct array_t string = src->data.extended.as_array[i];
+                BoltStringArray_put(dest, i, string.data.as_char, string.size);
+            }
+            break;
+        }
+        default:
+        {
+            if (src->storage == BOLT_STORAGE_VIEW)
+            {
+                _format(dest, BoltValue_type(src), src->subtype, src->size, src->data.extended.as_ptr,
+                        sizeof_n(char, src->size));
+            }
+            else if (_data_size(src) > 0)
+            {
+                _format(dest, BoltValue_type(src), src->subtype, src->size, src->data.extended.as_ptr, _data_size(src));
+            }
+            else
+            {
+                _format(dest, BoltValue_type(src), src->subtype, src->size, NULL, 0);
+                memcpy(&dest->data, &src->data, sizeof(src->data));
+            }
+            break;
+        }
+    }
+}
+
+void BoltValue_materialize(struct BoltValue* value)
+{
+    switch (value->storage)
+    {
+        case BOLT_STORAGE_VIEW:
+        {
+            const void* data = value->data.extended.as_ptr;
+            _format(value, BoltValue_type(value), value->subtype, value->size, data, sizeof_n(char, value->size));
+            return;
+        }
+        case BOLT_STORAGE_EXTERNAL:
+            break;
+        default:
+            // Inline data is owned, and borrowed data is read-only
+            return;
+    }
+    int multiplier;
+    switch (BoltValue_type(value))
+    {
+        case BOLT_LIST:
+        case BOLT_STRUCTURE:
+        case BOLT_STRUCTURE_ARRAY:
+        case BOLT_MESSAGE:
+            multiplier = 1;
+            break;
+        case BOLT_DICTIONARY:
+            multiplier = 2;
+            break;
+        default:
+            return;
+    }
+    for (long i = 0; i < multiplier * value->size; i++)
+    {
+        BoltValue_materialize(&value->data.extended.as_value[i]);
+    }
+}
+
 enum BoltType BoltValue_type(const struct BoltValue* value)
 {
     return (enum BoltType)(value->type);
@@ -177,6 +424,19 @@ void BoltList_resize(struct BoltValue* value, int32_t size)
     _resize(value, size, 1);
 }
 
+void BoltList_reserve(struct BoltValue* value, int32_t capacity)
+{
+    assert(BoltValue_type(value) == BOLT_LIST);
+    _reserve(value, capacity, 1);
+}
+
+struct BoltValue* BoltList_append(struct BoltValue* value)
+{
+    assert(BoltValue_type(value) == BOLT_LIST);
+    int32_t index = _append(value, 1);
+    return &value->data.extended.as_value[index];
+}
+
 struct BoltValue* BoltList_value(const struct BoltValue* value, int32_t index)
 {
     assert(BoltValue_type(value) == BOLT_LIST);
@@ -249,6 +509,20 @@ int BoltValue_write(struct BoltValue * value, FILE * file, int32_t protocol_vers
             return BoltFloat64_write(value, file);
         case BOLT_FLOAT64_ARRAY:
             return BoltFloat64Array_write(value, file);
+        case BOLT_POINT:
+            return BoltPoint_write(value, file);
+        case BOLT_DATE:
+            return BoltDate_write(value, file);
+        case BOLT_TIME:
+            return BoltTime_write(value, file);
+        case BOLT_LOCAL_TIME:
+            return BoltLocalTime_write(value, file);
+        case BOLT_DATE_TIME:
+            return BoltDateTime_write(value, file);
+        case BOLT_LOCAL_DATE_TIME:
+            return BoltLocalDateTime_write(value, file);
+        case BOLT_DURATION:
+            return BoltDuration_write(value, file);
         case BOLT_STRUCTURE:
             return BoltStructure_write(value, file, protocol_version);
         case BOLT_STRUCTURE_ARRAY: